@@ -245,6 +245,11 @@ namespace graphene { namespace app {
        return _app.p2p_node()->get_connected_peers();
     }
 
+    std::vector<net::peer_metrics> network_node_api::get_peer_metrics() const
+    {
+       return _app.p2p_node()->get_peer_metrics();
+    }
+
     std::vector<net::potential_peer_record> network_node_api::get_potential_peers() const
     {
        return _app.p2p_node()->get_potential_peers();
@@ -260,6 +265,36 @@ namespace graphene { namespace app {
        return _app.p2p_node()->set_advanced_node_parameters(params);
     }
 
+    std::vector<fc::rpc::api_call_metrics> network_node_api::get_api_metrics() const
+    {
+       return fc::rpc::api_metrics::instance().get_method_metrics();
+    }
+
+    std::vector<fc::rpc::api_call_metrics> network_node_api::get_api_client_metrics() const
+    {
+       return fc::rpc::api_metrics::instance().get_client_metrics();
+    }
+
+    void network_node_api::reset_api_metrics()
+    {
+       fc::rpc::api_metrics::instance().reset();
+    }
+
+    void network_node_api::set_api_call_thresholds( uint32_t warn_ms, uint32_t max_ms )
+    {
+       fc::rpc::api_metrics::instance().set_thresholds( fc::milliseconds( warn_ms ), fc::milliseconds( max_ms ) );
+    }
+
+    fc::rpc::api_rate_limits network_node_api::get_api_rate_limits() const
+    {
+       return fc::rpc::api_rate_limiter::instance().get_limits();
+    }
+
+    void network_node_api::set_api_rate_limits( const fc::rpc::api_rate_limits& limits )
+    {
+       fc::rpc::api_rate_limiter::instance().set_limits( limits );
+    }
+
     fc::api<network_broadcast_api> login_api::network_broadcast()const
     {
        FC_ASSERT(_network_broadcast_api);
@@ -43,6 +43,9 @@
 #include <fc/io/fstream.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
+#include <fc/rpc/binary_websocket_api.hpp>
+#include <fc/thread/parallel.hpp>
+#include <fc/thread/thread.hpp>
 #include <fc/network/resolve.hpp>
 
 #include <fc/filesystem.hpp>
@@ -178,13 +181,92 @@ namespace detail {
       }
 
 
+      void configure_api_metrics()
+      {
+         fc::rpc::api_metrics::instance().set_thresholds( fc::milliseconds( _options->at("api-call-warn-ms").as<uint32_t>() ),
+                                                          fc::milliseconds( _options->at("api-call-max-ms").as<uint32_t>() ) );
+         std::set<string> proxies;
+         if( _options->count("api-trusted-proxy") )
+            for( const string& proxy : _options->at("api-trusted-proxy").as<vector<string>>() )
+               proxies.insert( proxy );
+         fc::rpc::api_metrics::instance().set_trusted_proxies( std::move( proxies ) );
+         _api_metrics_log_interval = _options->at("api-metrics-log-interval").as<uint32_t>();
+         schedule_api_metrics_log();
+      }
+
+      void reset_api_rate_limits()
+      { try {
+         fc::rpc::api_rate_limits limits;
+         limits.connection_budget = _options->at("api-connection-budget").as<double>();
+         limits.connection_refill_per_second = _options->at("api-connection-refill").as<double>();
+         limits.client_budget = _options->at("api-client-budget").as<double>();
+         limits.client_refill_per_second = _options->at("api-client-refill").as<double>();
+         limits.default_cost = _options->at("api-default-cost").as<double>();
+         limits.cost_per_ms = _options->at("api-cost-per-ms").as<double>();
+         if( _options->count("api-call-cost") )
+         {
+            for( const string& entry : _options->at("api-call-cost").as<vector<string>>() )
+            {
+               auto pos = entry.find( '=' );
+               FC_ASSERT( pos != string::npos && pos > 0, "Expected METHOD=COST" );
+               limits.method_costs[ entry.substr( 0, pos ) ] = boost::lexical_cast<double>( entry.substr( pos + 1 ) );
+            }
+         }
+         fc::rpc::api_rate_limiter::instance().set_limits( limits );
+         if( limits.connection_budget > 0 || limits.client_budget > 0 )
+            ilog( "Limiting API calls to budgets of ${c} units per connection and ${a} per client address",
+                  ("c",limits.connection_budget)("a",limits.client_budget) );
+      } FC_CAPTURE_AND_RETHROW() }
+
+      void schedule_api_metrics_log()
+      {
+         if( !_api_metrics_log_interval )
+            return;
+         _api_metrics_log_task = fc::schedule( [this]() {
+               fc::rpc::api_metrics::instance().log_summary();
+               schedule_api_metrics_log();
+            }, fc::time_point::now() + fc::seconds( _api_metrics_log_interval ), "api metrics log" );
+      }
+
+      void reset_api_threads()
+      {
+         _api_threads.clear();
+         uint16_t num_threads = _options->at("api-threads").as<uint16_t>();
+         for( uint16_t i = 0; i < num_threads; ++i )
+            _api_threads.push_back( std::make_shared<fc::thread>( "api-" + std::to_string(i) ) );
+         if( num_threads )
+            ilog( "Serving read only API calls from ${n} threads", ("n",num_threads) );
+      }
+
+      /**
+       * Runs read only calls on the API threads under the chain read lock, so that expensive queries
+       * do not hold up block processing or other clients; everything else runs in place.
+       */
+      void execute_api_call( const string& method, const std::function<void()>& invoke )
+      {
+         if( _api_threads.empty() || !application::is_concurrent_api_call( method ) )
+            return invoke();
+
+         auto& thread = *_api_threads[ _next_api_thread++ % _api_threads.size() ];
+         auto db = _chain_db;
+         thread.async( [db,&invoke]() { db->with_read_lock( invoke ); }, "api call" ).wait();
+      }
+
+      void reset_websocket_compression()
+      { try {
+         fc::http::websocket_compression compression;
+         compression.enabled = _options->count("enable-permessage-deflate") != 0;
+         compression.level = _options->at("permessage-deflate-level").as<int>();
+         compression.min_size = _options->at("permessage-deflate-min-size").as<uint32_t>();
+         FC_ASSERT( compression.level >= -1 && compression.level <= 9, "permessage-deflate-level must be between -1 and 9" );
+         fc::http::set_server_compression( compression );
+      } FC_CAPTURE_AND_RETHROW() }
+
       void reset_websocket_server()
       { try {
          if( !_options->count("rpc-endpoint") )
             return;
 
-         //bool enable_deflate_compression = _options->count("enable-permessage-deflate") != 0;
-
          _websocket_server = std::make_shared<fc::http::websocket_server>();
 
          _websocket_server->on_connection([&]( const fc::http::websocket_connection_ptr& c ){
@@ -193,6 +275,9 @@ namespace detail {
             auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()) );
             wsc->register_api(fc::api<graphene::app::database_api>(db_api));
             wsc->register_api(fc::api<graphene::app::login_api>(login));
+            wsc->set_call_executor( [this]( const string& method, const std::function<void()>& invoke ) {
+               execute_api_call( method, invoke );
+            });
             c->set_session_data( wsc );
          });
          ilog("Configured websocket rpc to listen on ${ip}", ("ip",_options->at("rpc-endpoint").as<string>()));
@@ -211,7 +296,6 @@ namespace detail {
          }
 
          string password = _options->count("server-pem-password") ? _options->at("server-pem-password").as<string>() : "";
-         //bool enable_deflate_compression = _options->count("enable-permessage-deflate") != 0;
          _websocket_tls_server = std::make_shared<fc::http::websocket_tls_server>( _options->at("server-pem").as<string>(), password );
 
          _websocket_tls_server->on_connection([&]( const fc::http::websocket_connection_ptr& c ){
@@ -220,6 +304,9 @@ namespace detail {
             auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()) );
             wsc->register_api(fc::api<graphene::app::database_api>(db_api));
             wsc->register_api(fc::api<graphene::app::login_api>(login));
+            wsc->set_call_executor( [this]( const string& method, const std::function<void()>& invoke ) {
+               execute_api_call( method, invoke );
+            });
             c->set_session_data( wsc );
          });
          ilog("Configured websocket TLS rpc to listen on ${ip}", ("ip",_options->at("rpc-tls-endpoint").as<string>()));
@@ -227,6 +314,29 @@ namespace detail {
          _websocket_tls_server->start_accept();
       } FC_CAPTURE_AND_RETHROW() }
 
+      void reset_binary_websocket_server()
+      { try {
+         if( !_options->count("rpc-binary-endpoint") )
+            return;
+
+         _binary_websocket_server = std::make_shared<fc::http::websocket_server>();
+
+         _binary_websocket_server->on_connection([&]( const fc::http::websocket_connection_ptr& c ){
+            auto wsc = std::make_shared<fc::rpc::binary_websocket_api_connection>(*c);
+            auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self) );
+            auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()) );
+            wsc->register_api(fc::api<graphene::app::database_api>(db_api));
+            wsc->register_api(fc::api<graphene::app::login_api>(login));
+            wsc->set_call_executor( [this]( const string& method, const std::function<void()>& invoke ) {
+               execute_api_call( method, invoke );
+            });
+            c->set_session_data( wsc );
+         });
+         ilog("Configured binary websocket rpc to listen on ${ip}", ("ip",_options->at("rpc-binary-endpoint").as<string>()));
+         _binary_websocket_server->listen( fc::ip::endpoint::from_string(_options->at("rpc-binary-endpoint").as<string>()) );
+         _binary_websocket_server->start_accept();
+      } FC_CAPTURE_AND_RETHROW() }
+
       explicit application_impl(application* self)
          : _self(self),
            _chain_db(std::make_shared<chain::database>())
@@ -235,6 +345,15 @@ namespace detail {
 
       ~application_impl()
       {
+         try
+         {
+            if( _api_metrics_log_task.valid() )
+               _api_metrics_log_task.cancel_and_wait( "~application_impl()" );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Exception thrown while terminating the API metrics log, ignoring: ${e}", ("e", e) );
+         }
          fc::remove_all(_data_dir / "blockchain/dblock");
       }
 
@@ -413,8 +532,13 @@ namespace detail {
          }
 
          reset_p2p_node(_data_dir);
+         configure_api_metrics();
+         reset_api_rate_limits();
+         reset_api_threads();
+         reset_websocket_compression();
          reset_websocket_server();
          reset_websocket_tls_server();
+         reset_binary_websocket_server();
       } FC_LOG_AND_RETHROW() }
 
       optional< api_access_info > get_api_access_info(const string& username)const
@@ -527,7 +651,15 @@ namespace detail {
             trx_count = 0;
          }
 
-         _chain_db->push_transaction( transaction_message.trx );
+         // reject what the chain state rules out cheaply before spending time on the signatures, then
+         // recover them on the worker pool so that the chain thread can apply blocks in the meantime
+         const signed_transaction& trx = transaction_message.trx;
+         _chain_db->precheck_transaction_state( trx );
+         const chain_id_type chain_id = _chain_db->get_chain_id();
+         precomputed_transaction precomputed = fc::do_parallel( [trx,chain_id]() {
+            return database::precompute_transaction( trx, chain_id );
+         }, "precompute transaction" ).wait();
+         _chain_db->push_transaction( precomputed );
       } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
       virtual void handle_message(const message& message_to_process) override
@@ -879,6 +1011,13 @@ namespace detail {
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::shared_ptr<fc::http::websocket_server>      _binary_websocket_server;
+
+      std::vector<std::shared_ptr<fc::thread>>         _api_threads;
+      uint32_t                                         _next_api_thread = 0;
+
+      uint32_t                                         _api_metrics_log_interval = 0;
+      fc::future<void>                                 _api_metrics_log_task;
 
       std::map<string, std::shared_ptr<abstract_plugin>> _plugins;
 
@@ -913,14 +1052,30 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("checkpoint,c", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
          ("rpc-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8090"), "Endpoint for websocket RPC to listen on")
          ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"), "Endpoint for TLS websocket RPC to listen on")
+         ("rpc-binary-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8091"), "Endpoint for binary (fc::raw encoded) websocket RPC to listen on")
          ("enable-permessage-deflate", "Enable support for per-message deflate compression in the websocket servers "
                                        "(--rpc-endpoint and --rpc-tls-endpoint), disabled by default")
+         ("permessage-deflate-level", bpo::value<int>()->default_value(-1), "Compression level of per-message deflate, from 0 (fastest) to 9 (smallest), -1 for the zlib default")
+         ("permessage-deflate-min-size", bpo::value<uint32_t>()->default_value(256), "Websocket messages shorter than this many bytes are sent uncompressed")
          ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"), "The TLS certificate file for this server")
          ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
          ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
          ("io-threads", bpo::value<uint16_t>()->implicit_value(0), "Number of IO threads, default to 0 for auto-configuration")
+         ("api-threads", bpo::value<uint16_t>()->default_value(0), "Number of threads serving read only API calls, 0 serves every call from the main thread")
+         ("api-call-warn-ms", bpo::value<uint32_t>()->default_value(750), "API call execution time in ms at which to log a warning")
+         ("api-call-max-ms", bpo::value<uint32_t>()->default_value(1000), "API call execution time in ms at which to log an error")
+         ("api-metrics-log-interval", bpo::value<uint32_t>()->default_value(600), "Seconds between log lines summarizing API calls, 0 disables them")
+         ("api-connection-budget", bpo::value<double>()->default_value(0), "Cost units an API connection may spend at once, 0 for no limit")
+         ("api-connection-refill", bpo::value<double>()->default_value(0), "Cost units per second refilled into the budget of an API connection")
+         ("api-client-budget", bpo::value<double>()->default_value(0), "Cost units all API connections from one address may spend at once, 0 for no limit")
+         ("api-client-refill", bpo::value<double>()->default_value(0), "Cost units per second refilled into the budget of an API client address")
+         ("api-default-cost", bpo::value<double>()->default_value(1), "Cost units of an API call whose method has no api-call-cost")
+         ("api-call-cost", bpo::value<vector<string>>()->composing(), "Cost units of one API method as METHOD=COST, e.g. get_user_count_with_balances=100 (may specify multiple times)")
+         ("api-cost-per-ms", bpo::value<double>()->default_value(0), "Cost units charged for every millisecond an API call runs")
+         ("api-trusted-proxy", bpo::value<vector<string>>()->composing(), "Address of a reverse proxy whose X-Forwarded-For header names the API client, "
+          "the header is ignored from other addresses (may specify multiple times)")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
@@ -1382,6 +1537,31 @@ void application::set_api_access_info(const string& username, api_access_info&&
    my->set_api_access_info(username, std::move(permissions));
 }
 
+/**
+ * Database API methods that only read chain objects.  Lookups that add to the subscription filter
+ * (get_objects, get_accounts, lookup_accounts, ...) and calls that read the block log are left out,
+ * as are the network node calls, which wait on the p2p thread while it may be waiting on the main
+ * thread.  Add a method here only after checking that nothing on its path writes shared state.
+ */
+bool application::is_concurrent_api_call( const string& method )
+{
+   static const std::set<string> concurrent_calls = {
+      "get_chain_properties", "get_global_properties", "get_config", "get_chain_id",
+      "get_dynamic_global_properties", "get_market_reference",
+      "get_account_by_name", "get_account_references", "lookup_account_names", "get_account_count",
+      "get_account_balances", "get_named_account_balances", "get_vested_balances", "get_vesting_balances",
+      "list_assets", "lookup_asset_symbols", "get_asset_holders", "get_asset_holders_summary",
+      "get_limit_orders", "get_call_orders", "get_settle_orders", "get_margin_positions",
+      "get_ticker", "get_24_volume", "get_order_book", "get_trade_history",
+      "get_witnesses", "get_witness_by_account", "lookup_witness_accounts", "get_witness_count",
+      "get_committee_members", "get_committee_member_by_account", "lookup_committee_member_accounts",
+      "lookup_vote_ids", "get_transaction_hex", "get_required_signatures", "get_potential_signatures",
+      "get_potential_address_signatures", "verify_authority", "verify_account_authority",
+      "get_required_fees", "get_blinded_balances"
+   };
+   return concurrent_calls.count( method ) != 0;
+}
+
 bool application::is_finished_syncing() const
 {
    return my->_is_finished_syncing;
@@ -24,11 +24,15 @@
 
 #include <graphene/app/database_api.hpp>
 #include <graphene/chain/get_config.hpp>
+#include <graphene/chain/vesting_balance_object.hpp>
+#include <graphene/chain/withdraw_permission_object.hpp>
 
 #include <fc/bloom_filter.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <fc/crypto/city.hpp>
 #include <fc/crypto/hex.hpp>
+#include <fc/io/json.hpp>
 
 #include <boost/range/iterator_range.hpp>
 #include <boost/rational.hpp>
@@ -39,7 +43,9 @@
 
 #include <cfenv>
 #include <iostream>
+#include <list>
 #include <map>
+#include <mutex>
 #include <future>
 #include <iostream>
 #include <utility>
@@ -47,6 +53,158 @@
 
 namespace graphene { namespace app {
 
+namespace {
+   /** splits paths like "options.memo_key" into their top level field and the rest, which is empty for a whole field */
+   flat_map<string,flat_set<string>> split_paths( const flat_set<string>& paths )
+   {
+      flat_map<string,flat_set<string>> result;
+      for( const auto& path : paths )
+      {
+         auto dot = path.find( '.' );
+         result[ path.substr( 0, dot ) ].insert( dot == string::npos ? string() : path.substr( dot + 1 ) );
+      }
+      return result;
+   }
+
+   /** keeps only the nested paths of v, or all of it for an empty path; null if a path leads into a non-object */
+   fc::variant select_paths( const fc::variant& v, const flat_set<string>& paths )
+   {
+      if( paths.count( string() ) )
+         return v;
+      if( !v.is_object() )
+         return fc::variant();
+
+      fc::mutable_variant_object result;
+      const auto& obj = v.get_object();
+      for( const auto& field : split_paths( paths ) )
+      {
+         auto itr = obj.find( field.first );
+         if( itr == obj.end() )
+            continue;
+         fc::variant selected = select_paths( itr->value(), field.second );
+         if( !selected.is_null() )
+            result( field.first, std::move( selected ) );
+      }
+      return fc::variant_object( std::move( result ) );
+   }
+
+   /** converts only the reflected members named in fields, so that the others are never serialized */
+   template<typename T>
+   class projection_visitor
+   {
+      public:
+         projection_visitor( const T& obj, const flat_map<string,flat_set<string>>& fields, fc::mutable_variant_object& result )
+         :_obj(obj),_fields(fields),_result(result){}
+
+         template<typename Member, class Class, Member (Class::*member)>
+         void operator()( const char* name )const
+         {
+            auto itr = _fields.find( name );
+            if( itr != _fields.end() )
+               add( name, _obj.*member, itr->second );
+         }
+
+      private:
+         template<typename M>
+         void add( const char* name, const optional<M>& v, const flat_set<string>& paths )const
+         {
+            if( v.valid() )
+               add( name, *v, paths );
+         }
+         template<typename M>
+         void add( const char* name, const M& v, const flat_set<string>& paths )const
+         {
+            fc::variant selected = select_paths( fc::variant( v, GRAPHENE_MAX_NESTED_OBJECTS ), paths );
+            if( !selected.is_null() )
+               _result( name, std::move( selected ) );
+         }
+
+         const T&                                   _obj;
+         const flat_map<string,flat_set<string>>&   _fields;
+         fc::mutable_variant_object&                _result;
+   };
+
+   template<typename T>
+   fc::variant_object project( const T& obj, const flat_set<string>& fields )
+   {
+      fc::mutable_variant_object result;
+      fc::reflector<T>::visit( projection_visitor<T>( obj, split_paths( fields ), result ) );
+      return result;
+   }
+
+   /** the account an object belongs to, for the objects that belong to one */
+   optional<account_id_type> owner_of( const object& obj )
+   {
+      if( auto o = dynamic_cast<const account_object*>( &obj ) )                return o->id;
+      if( auto o = dynamic_cast<const account_balance_object*>( &obj ) )        return o->owner;
+      if( auto o = dynamic_cast<const account_statistics_object*>( &obj ) )     return o->owner;
+      if( auto o = dynamic_cast<const bonus_balances_object*>( &obj ) )         return o->owner;
+      if( auto o = dynamic_cast<const account_mature_balance_object*>( &obj ) ) return o->owner;
+      if( auto o = dynamic_cast<const limit_order_object*>( &obj ) )            return o->seller;
+      if( auto o = dynamic_cast<const call_order_object*>( &obj ) )             return o->borrower;
+      if( auto o = dynamic_cast<const force_settlement_object*>( &obj ) )       return o->owner;
+      if( auto o = dynamic_cast<const vesting_balance_object*>( &obj ) )        return o->owner;
+      if( auto o = dynamic_cast<const withdraw_permission_object*>( &obj ) )    return o->withdraw_from_account;
+      if( auto o = dynamic_cast<const witness_object*>( &obj ) )                return o->witness_account;
+      if( auto o = dynamic_cast<const committee_member_object*>( &obj ) )       return o->committee_member_account;
+      if( auto o = dynamic_cast<const fund_object*>( &obj ) )                   return o->owner;
+      if( auto o = dynamic_cast<const fund_deposit_object*>( &obj ) )           return o->account_id;
+      if( auto o = dynamic_cast<const cheque_object*>( &obj ) )                 return o->drawer;
+      return optional<account_id_type>();
+   }
+
+   bool matches( const object_change_filter& filter, const object& obj )
+   {
+      if( obj.id.space() != filter.space_id || obj.id.type() != filter.type_id )
+         return false;
+      if( filter.market.valid() )
+      {
+         auto order = dynamic_cast<const limit_order_object*>( &obj );
+         if( !order || order->get_market() != *filter.market )
+            return false;
+      }
+      if( !filter.accounts.empty() )
+      {
+         auto owner = owner_of( obj );
+         if( !owner.valid() || !filter.accounts.count( *owner ) )
+            return false;
+      }
+      return true;
+   }
+
+   /** the objects of one subscription to object changes whose fields are kept to send only what changed */
+   const size_t max_object_changes_tracked = 10000;
+
+   /** the assets whose holders summary is kept */
+   const size_t max_holders_summaries_cached = 100;
+
+   /** the holders summaries of recently asked for assets as of a head block, shared by the APIs of one database */
+   struct holders_summary_cache
+   {
+      std::mutex                                                     lock;
+      map<asset_id_type, pair<block_id_type,asset_holders_summary>> summaries;
+   };
+
+   /** the cache of the database, kept as long as an API of it uses it */
+   std::shared_ptr<holders_summary_cache> holders_summary_cache_of( const graphene::chain::database& db )
+   {
+      static std::mutex registry_lock;
+      static map<const graphene::chain::database*, std::weak_ptr<holders_summary_cache>> registry;
+
+      std::lock_guard<std::mutex> guard( registry_lock );
+      for( auto itr = registry.begin(); itr != registry.end(); )
+         itr = itr->second.expired() ? registry.erase( itr ) : std::next( itr );
+      auto& entry = registry[&db];
+      auto cache = entry.lock();
+      if( !cache )
+      {
+         cache = std::make_shared<holders_summary_cache>();
+         entry = cache;
+      }
+      return cache;
+   }
+}
+
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 {
    public:
@@ -55,6 +213,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       // Objects
       fc::variants get_objects(const vector<object_id_type>& ids)const;
+      fc::variants get_objects_fields(const vector<object_id_type>& ids, const flat_set<string>& fields)const;
       optional<object_id_type> get_last_object_id(object_id_type id) const;
 
       // Subscriptions
@@ -62,6 +221,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
       void cancel_all_subscriptions();
+      void subscribe_to_object_changes( std::function<void(const variant&)> callback,
+                                        const vector<object_change_filter>& filters );
+      void unsubscribe_from_object_changes();
 
       // Blocks and transactions
       optional<block_header> get_block_header(uint32_t block_num)const;
@@ -94,6 +256,11 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       get_account_addresses(const string& name_or_id, unsigned from, unsigned limit) const;
 
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids, bool subscribe );
+      std::map<string,fc::variant_object> get_full_accounts_sections( const vector<string>& names_or_ids, bool subscribe,
+                                                                      const flat_set<string>& sections );
+      void fill_full_account( const account_object& account, full_account& acnt, const flat_set<string>* sections )const;
+      const account_object* find_account_by_name_or_id( const string& name_or_id )const;
+      vector<fc::variant> get_accounts_fields( const vector<account_id_type>& account_ids, const flat_set<string>& fields )const;
       optional<bonus_balances_object> get_bonus_balances ( string name_or_id ) const;
       optional<account_object> get_account_by_name( string name ) const;
       optional<account_object> get_account_by_name_or_id(const string& name_or_id) const;
@@ -118,6 +285,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<optional<asset_object>> get_assets(const vector<asset_id_type>& asset_ids)const;
       vector<asset_object>           list_assets(const string& lower_bound_symbol, uint32_t limit)const;
       vector<optional<asset_object>> lookup_asset_symbols(const vector<string>& symbols_or_ids)const;
+      vector<asset_holder>           get_asset_holders(asset_id_type asset_id, optional<asset_holder> after, uint32_t limit)const;
+      asset_holders_summary          get_asset_holders_summary(asset_id_type asset_id)const;
 
       // Funds
       vector<fund_object>             list_funds() const;
@@ -186,7 +355,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
          if( !is_subscribed_to_item(i) )
          {
-            idump((i));
+            ddump((i));
             _subscribe_filter.insert( vec.data(), vec.size() );//(vecconst char*)&i, sizeof(i) );
          }
       }
@@ -206,6 +375,11 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void on_objects_changed(const vector<object_id_type>& ids);
       void on_objects_removed(const vector<const object*>& objs);
       void on_applied_block();
+      /** the state of the changed objects that match the object change filters, null for those that may have stopped matching */
+      vector<pair<object_id_type,variant>> select_object_changes( const vector<object_id_type>& ids )const;
+      /** the changes since the last call as sent to the object change callback, run outside of block application */
+      vector<variant> diff_object_changes( const vector<pair<object_id_type,variant>>& objects );
+      void forget_object_changes();
 
       mutable fc::bloom_filter                               _subscribe_filter;
       std::function<void(const fc::variant&)> _subscribe_callback;
@@ -217,6 +391,19 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       boost::signals2::scoped_connection _applied_block_connection;
       boost::signals2::scoped_connection _pending_trx_connection;
       map<pair<asset_id_type,asset_id_type>, std::function<void(const variant&)>> _market_subscriptions;
+      std::function<void(const fc::variant&)>                                     _object_change_callback;
+      vector<object_change_filter>                                                _object_change_filters;
+      struct sent_object
+      {
+         /// a hash of the name and JSON of every top level field last sent, sorted
+         vector<uint64_t>                  fields;
+         std::list<object_id_type>::iterator position;
+      };
+      /// the reported objects, most recently sent first, at most max_object_changes_tracked
+      std::list<object_id_type>                                                   _object_changes_order;
+      map<object_id_type, sent_object>                                            _object_changes_sent;
+      /// shared with the other APIs of _db, so each summary is computed once per block
+      std::shared_ptr<holders_summary_cache>                                      _holders_summaries;
       graphene::chain::database&                                                  _db;
 };
 
@@ -231,7 +418,8 @@ database_api::database_api( graphene::chain::database& db )
 
 database_api::~database_api() {}
 
-database_api_impl::database_api_impl( graphene::chain::database& db ):_db(db)
+database_api_impl::database_api_impl( graphene::chain::database& db )
+   : _holders_summaries( holders_summary_cache_of( db ) ), _db(db)
 {
    wlog("creating database api ${x}", ("x",int64_t(this)) );
    _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids) {
@@ -314,6 +502,45 @@ fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids) c
    return result;
 }
 
+fc::variants database_api::get_objects_fields(const vector<object_id_type>& ids, const flat_set<string>& fields) const {
+   return my->get_objects_fields( ids, fields );
+}
+
+fc::variants database_api_impl::get_objects_fields(const vector<object_id_type>& ids, const flat_set<string>& fields) const
+{
+   // accounts are converted member by member, skipping their address lists unless asked for
+   vector<object_id_type> other_ids;
+   for( const auto& id : ids )
+      if( !id.is<account_id_type>() )
+         other_ids.push_back( id );
+   fc::variants others = get_objects( other_ids );
+
+   fc::variants result;
+   result.reserve( ids.size() );
+   auto other = others.begin();
+   for( const auto& id : ids )
+   {
+      if( id.is<account_id_type>() )
+      {
+         const account_object* account = _db.find( account_id_type( id ) );
+         if( account )
+         {
+            subscribe_to_item( id );
+            result.emplace_back( project( *account, fields ) );
+         }
+         else
+            result.emplace_back();
+         continue;
+      }
+
+      fc::variant obj = std::move( *other++ );
+      if( obj.is_object() )
+         obj = select_paths( obj, fields );
+      result.push_back( std::move( obj ) );
+   }
+   return result;
+}
+
 optional<object_id_type> database_api::get_last_object_id(object_id_type id) const {
    return my->get_last_object_id(id);
 }
@@ -398,6 +625,50 @@ void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
    _market_subscriptions.clear();
+   unsubscribe_from_object_changes();
+}
+
+void database_api::subscribe_to_object_changes( std::function<void(const variant&)> callback,
+                                                const vector<object_change_filter>& filters )
+{
+   my->subscribe_to_object_changes( callback, filters );
+}
+
+void database_api_impl::subscribe_to_object_changes( std::function<void(const variant&)> callback,
+                                                     const vector<object_change_filter>& filters )
+{
+   FC_ASSERT( !filters.empty() && filters.size() <= 100, "Between 1 and 100 filters are allowed" );
+   _object_change_filters.clear();
+   for( auto filter : filters )
+   {
+      if( filter.market.valid() )
+      {
+         FC_ASSERT( filter.market->first != filter.market->second, "The two assets of a market must differ" );
+         if( filter.market->first > filter.market->second )
+            std::swap( filter.market->first, filter.market->second );
+      }
+      _object_change_filters.push_back( filter );
+   }
+   forget_object_changes();
+   _object_change_callback = callback;
+}
+
+void database_api::unsubscribe_from_object_changes()
+{
+   my->unsubscribe_from_object_changes();
+}
+
+void database_api_impl::unsubscribe_from_object_changes()
+{
+   _object_change_callback = std::function<void(const fc::variant&)>();
+   _object_change_filters.clear();
+   forget_object_changes();
+}
+
+void database_api_impl::forget_object_changes()
+{
+   _object_changes_sent.clear();
+   _object_changes_order.clear();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -586,7 +857,7 @@ vector<vector<account_id_type>> database_api::get_key_references( vector<public_
  */
 vector<vector<account_id_type>> database_api_impl::get_key_references( vector<public_key_type> keys) const
 {
-   wdump( (keys) );
+   ddump( (keys) );
    vector<vector<account_id_type>> final_result;
    final_result.reserve(keys.size());
 
@@ -620,7 +891,7 @@ vector<vector<account_id_type>> database_api_impl::get_key_references( vector<pu
             result.reserve(itr->second.size());
             for (auto item: itr->second)
             {
-               wdump((a)(item)(item(_db).name));
+               ddump((a)(item)(item(_db).name));
                result.push_back(item);
             }
          }
@@ -666,7 +937,7 @@ address database_api::get_address(int64_t block_num, int64_t transaction_num) co
  */
 vector<vector<account_id_type>> database_api_impl::get_address_references(vector<address> addresses) const
 {
-   wdump( (addresses) );
+   ddump( (addresses) );
    vector<vector<account_id_type>> final_result;
    final_result.reserve(addresses.size());
 
@@ -684,7 +955,7 @@ vector<vector<account_id_type>> database_api_impl::get_address_references(vector
          result.reserve(a_itr->second.size());
          for (auto item: a_itr->second)
          {
-            wdump((addr)(item)(item(_db).name));
+            ddump((addr)(item)(item(_db).name));
             result.push_back(item);
          }
       }
@@ -742,6 +1013,26 @@ vector<optional<account_object>> database_api_impl::get_accounts(const vector<ac
    return result;
 }
 
+vector<fc::variant> database_api::get_accounts_fields(const vector<account_id_type>& account_ids, const flat_set<string>& fields) const {
+   return my->get_accounts_fields( account_ids, fields );
+}
+
+vector<fc::variant> database_api_impl::get_accounts_fields(const vector<account_id_type>& account_ids, const flat_set<string>& fields)const
+{
+   vector<fc::variant> result; result.reserve(account_ids.size());
+   for( auto id : account_ids )
+   {
+      if( auto o = _db.find(id) )
+      {
+         subscribe_to_item( id );
+         result.emplace_back( project( *o, fields ) );
+      }
+      else
+         result.emplace_back();
+   }
+   return result;
+}
+
 std::pair<unsigned, vector<address>>
 database_api_impl::get_account_addresses(const string& name_or_id, unsigned from, unsigned limit) const
 {
@@ -775,21 +1066,12 @@ std::map<string,full_account> database_api::get_full_accounts(const vector<strin
 
 std::map<std::string, full_account> database_api_impl::get_full_accounts(const vector<std::string>& names_or_ids, bool subscribe)
 {
-   idump((names_or_ids));
+   ddump((names_or_ids));
    std::map<std::string, full_account> results;
 
    for (const std::string& account_name_or_id : names_or_ids)
    {
-      const account_object* account = nullptr;
-      if (std::isdigit(account_name_or_id[0]))
-         account = _db.find(fc::variant(account_name_or_id, 1).as<account_id_type>(1));
-      else
-      {
-         const auto& idx = _db.get_index_type<account_index>().indices().get<by_name>();
-         auto itr = idx.find(account_name_or_id);
-         if (itr != idx.end())
-            account = &*itr;
-      }
+      const account_object* account = find_account_by_name_or_id( account_name_or_id );
       if (account == nullptr) { continue; }
 
       if( subscribe )
@@ -798,71 +1080,142 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts(const v
          subscribe_to_item( account->id );
       }
 
-      // fc::mutable_variant_object full_account;
+      fill_full_account( *account, results[account_name_or_id], nullptr );
+   }
+   return results;
+}
+
+std::map<string,fc::variant_object> database_api::get_full_accounts_sections( const vector<string>& names_or_ids, bool subscribe,
+                                                                              const flat_set<string>& sections ) {
+   return my->get_full_accounts_sections( names_or_ids, subscribe, sections );
+}
+
+std::map<string,fc::variant_object> database_api_impl::get_full_accounts_sections( const vector<string>& names_or_ids, bool subscribe,
+                                                                                  const flat_set<string>& sections )
+{
+   if( sections.empty() )
+   {
+      std::map<string,fc::variant_object> results;
+      for( const auto& item : get_full_accounts( names_or_ids, subscribe ) )
+         results[item.first] = fc::variant( item.second, GRAPHENE_MAX_NESTED_OBJECTS ).get_object();
+      return results;
+   }
+
+   // nested paths like "account.name" still need the whole section looked up
+   flat_set<string> wanted_sections;
+   for( const auto& section : split_paths( sections ) )
+      wanted_sections.insert( section.first );
+
+   std::map<string,fc::variant_object> results;
+   for( const string& account_name_or_id : names_or_ids )
+   {
+      const account_object* account = find_account_by_name_or_id( account_name_or_id );
+      if( account == nullptr )
+         continue;
+
+      if( subscribe )
+         subscribe_to_item( account->id );
+
       full_account acnt;
-      acnt.account = *account;
-      acnt.statistics = account->statistics(_db);
-      acnt.registrar_name = account->registrar(_db).name;
-      acnt.referrer_name = account->referrer(_db).name;
-      acnt.lifetime_referrer_name = account->lifetime_referrer(_db).name;
-      acnt.votes = lookup_vote_ids( vector<vote_id_type>(account->options.votes.begin(),account->options.votes.end()) );
-
-      // Add the account itself, its statistics object, cashback balance, and referral account names
-      /*
-      full_account("account", *account)("statistics", account->statistics(_db))
-            ("registrar_name", account->registrar(_db).name)("referrer_name", account->referrer(_db).name)
-            ("lifetime_referrer_name", account->lifetime_referrer(_db).name);
-            */
-      if (account->cashback_vb)
-      {
-         acnt.cashback_balance = account->cashback_balance(_db);
-      }
-      // Add the account's proposals
+      fill_full_account( *account, acnt, &wanted_sections );
+      results[account_name_or_id] = project( acnt, sections );
+   }
+   return results;
+}
+
+const account_object* database_api_impl::find_account_by_name_or_id( const string& name_or_id )const
+{
+   if( name_or_id.empty() )
+      return nullptr;
+   if( std::isdigit( name_or_id[0] ) )
+      return _db.find( fc::variant( name_or_id, 1 ).as<account_id_type>( 1 ) );
+
+   const auto& idx = _db.get_index_type<account_index>().indices().get<by_name>();
+   auto itr = idx.find( name_or_id );
+   return itr != idx.end() ? &*itr : nullptr;
+}
+
+/** fills the members of acnt named in sections, or all of them if sections is null, and skips the lookups for the rest */
+void database_api_impl::fill_full_account( const account_object& account, full_account& acnt, const flat_set<string>* sections )const
+{
+   auto wanted = [sections]( const char* section ) { return sections == nullptr || sections->count( section ) != 0; };
+
+   if( wanted( "account" ) )
+      acnt.account = account;
+   if( wanted( "statistics" ) )
+      acnt.statistics = account.statistics(_db);
+   if( wanted( "registrar_name" ) )
+      acnt.registrar_name = account.registrar(_db).name;
+   if( wanted( "referrer_name" ) )
+      acnt.referrer_name = account.referrer(_db).name;
+   if( wanted( "lifetime_referrer_name" ) )
+      acnt.lifetime_referrer_name = account.lifetime_referrer(_db).name;
+   if( wanted( "votes" ) )
+      acnt.votes = lookup_vote_ids( vector<vote_id_type>(account.options.votes.begin(),account.options.votes.end()) );
+
+   if( account.cashback_vb && wanted( "cashback_balance" ) )
+   {
+      acnt.cashback_balance = account.cashback_balance(_db);
+   }
+   // Add the account's proposals
+   if( wanted( "proposals" ) )
+   {
       const auto& proposal_idx = _db.get_index_type<proposal_index>();
       const auto& pidx = dynamic_cast<const primary_index<proposal_index>&>(proposal_idx);
       const auto& proposals_by_account = pidx.get_secondary_index<graphene::chain::required_approval_index>();
-      auto  required_approvals_itr = proposals_by_account._account_to_proposals.find( account->id );
+      auto  required_approvals_itr = proposals_by_account._account_to_proposals.find( account.id );
       if( required_approvals_itr != proposals_by_account._account_to_proposals.end() )
       {
          acnt.proposals.reserve( required_approvals_itr->second.size() );
          for( auto proposal_id : required_approvals_itr->second )
             acnt.proposals.push_back( proposal_id(_db) );
       }
+   }
 
-
-      // Add the account's balances
-      auto balance_range = _db.get_index_type<account_balance_index>().indices().get<by_account_asset>().equal_range(boost::make_tuple(account->id));
-      //vector<account_balance_object> balances;
+   // Add the account's balances
+   if( wanted( "balances" ) )
+   {
+      auto balance_range = _db.get_index_type<account_balance_index>().indices().get<by_account_asset>().equal_range(boost::make_tuple(account.id));
       std::for_each(balance_range.first, balance_range.second,
                     [&acnt](const account_balance_object& balance) {
                        acnt.balances.emplace_back(balance);
                     });
+   }
 
-      // Add the account's vesting balances
-      auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>().equal_range(account->id);
+   // Add the account's vesting balances
+   if( wanted( "vesting_balances" ) )
+   {
+      auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>().equal_range(account.id);
       std::for_each(vesting_range.first, vesting_range.second,
                     [&acnt](const vesting_balance_object& balance) {
                        acnt.vesting_balances.emplace_back(balance);
                     });
+   }
 
-      // Add the account's orders
-      auto order_range = _db.get_index_type<limit_order_index>().indices().get<by_account>().equal_range(account->id);
+   // Add the account's orders
+   if( wanted( "limit_orders" ) )
+   {
+      auto order_range = _db.get_index_type<limit_order_index>().indices().get<by_account>().equal_range(account.id);
       std::for_each(order_range.first, order_range.second,
                     [&acnt] (const limit_order_object& order) {
                        acnt.limit_orders.emplace_back(order);
                     });
-      auto call_range = _db.get_index_type<call_order_index>().indices().get<by_account>().equal_range(account->id);
+   }
+   if( wanted( "call_orders" ) )
+   {
+      auto call_range = _db.get_index_type<call_order_index>().indices().get<by_account>().equal_range(account.id);
       std::for_each(call_range.first, call_range.second,
                     [&acnt] (const call_order_object& call) {
                        acnt.call_orders.emplace_back(call);
                     });
+   }
+   if( wanted( "bonus_balances_id" ) )
+   {
       const auto& index = _db.get_index_type<bonus_balances_index>().indices().get<by_account>();
-      const auto& account_balances = index.find(account->id);
+      const auto& account_balances = index.find(account.id);
       if (account_balances != index.end())
          acnt.bonus_balances_id = account_balances->id;
-      results[account_name_or_id] = acnt;
    }
-   return results;
 }
 
 optional<bonus_balances_object> database_api::get_bonus_balances( string name_or_id ) const {
@@ -1174,6 +1527,79 @@ vector<optional<asset_object>> database_api_impl::lookup_asset_symbols(const vec
    return result;
 }
 
+vector<asset_holder> database_api::get_asset_holders(asset_id_type asset_id, optional<asset_holder> after, uint32_t limit)const
+{
+   return my->get_asset_holders( asset_id, after, limit );
+}
+
+vector<asset_holder> database_api_impl::get_asset_holders(asset_id_type asset_id, optional<asset_holder> after, uint32_t limit)const
+{
+   FC_ASSERT( limit <= 100 );
+   const auto& balances = _db.get_index_type<account_balance_index>().indices().get<by_asset_balance>();
+   auto itr = after.valid() ? balances.upper_bound( boost::make_tuple( asset_id, after->amount, after->account_id ) )
+                            : balances.lower_bound( boost::make_tuple( asset_id ) );
+   auto end = balances.upper_bound( boost::make_tuple( asset_id ) );
+
+   vector<asset_holder> result;
+   result.reserve( limit );
+   for( ; limit-- && itr != end && itr->balance > 0; ++itr )
+      result.push_back( asset_holder{ itr->owner, itr->owner(_db).name, itr->balance } );
+   return result;
+}
+
+asset_holders_summary database_api::get_asset_holders_summary(asset_id_type asset_id)const
+{
+   return my->get_asset_holders_summary( asset_id );
+}
+
+asset_holders_summary database_api_impl::get_asset_holders_summary(asset_id_type asset_id)const
+{
+   const block_id_type head = _db.head_block_id();
+   {
+      std::lock_guard<std::mutex> guard( _holders_summaries->lock );
+      auto cached = _holders_summaries->summaries.find( asset_id );
+      if( cached != _holders_summaries->summaries.end() && cached->second.first == head )
+         return cached->second.second;
+   }
+
+   const auto& balances = _db.get_index_type<account_balance_index>().indices().get<by_asset_balance>();
+   auto range = balances.equal_range( boost::make_tuple( asset_id ) );
+
+   // balances are ordered from the largest down, so the zero balances of former holders come last
+   asset_holders_summary result;
+   result.asset_id = asset_id;
+   for( auto itr = range.first; itr != range.second && itr->balance > 0; ++itr )
+   {
+      ++result.holders;
+      result.total += itr->balance;
+      if( result.holders <= 10 )
+         result.top_10 += itr->balance;
+      if( result.holders <= 100 )
+         result.top_100 += itr->balance;
+      if( result.holders <= 1000 )
+         result.top_1000 += itr->balance;
+
+      size_t magnitude = 0;
+      for( int64_t amount = itr->balance.value; amount >= 10; amount /= 10 )
+         ++magnitude;
+      if( result.by_magnitude.size() <= magnitude )
+         result.by_magnitude.resize( magnitude + 1 );
+      ++result.by_magnitude[magnitude];
+   }
+
+   std::lock_guard<std::mutex> guard( _holders_summaries->lock );
+   auto& summaries = _holders_summaries->summaries;
+   if( summaries.size() >= max_holders_summaries_cached && !summaries.count( asset_id ) )
+   {
+      for( auto itr = summaries.begin(); itr != summaries.end(); )
+         itr = itr->second.first == head ? std::next( itr ) : summaries.erase( itr );
+      if( summaries.size() >= max_holders_summaries_cached )
+         summaries.erase( summaries.begin() );
+   }
+   summaries[asset_id] = std::make_pair( head, result );
+   return result;
+}
+
 vector<fund_object> database_api::list_funds() const {
    return my->list_funds();
 }
@@ -1646,8 +2072,9 @@ order_book database_api_impl::get_order_book( const string& base, const string&
 
    auto base_id = assets[0]->id;
    auto quote_id = assets[1]->id;
-   auto orders = get_limit_orders( base_id, quote_id, limit );
 
+   const auto& limit_order_idx = dynamic_cast<const primary_index<limit_order_index>&>( _db.get_index_type<limit_order_index>() );
+   const auto& depth = limit_order_idx.get_secondary_index<limit_order_depth_index>();
 
    auto asset_to_real = [&]( const asset& a, int p ) { return double(a.amount.value)/pow( 10, p ); };
    auto price_to_real = [&]( const price& p )
@@ -1657,25 +2084,27 @@ order_book database_api_impl::get_order_book( const string& base, const string&
       else
          return asset_to_real( p.quote, assets[0]->precision ) / asset_to_real( p.base, assets[1]->precision );
    };
+   auto receive_amount = [&]( const price& p, share_type for_sale )
+   {
+      return share_type( ( uint128_t( for_sale.value ) * p.quote.amount.value ) / p.base.amount.value );
+   };
 
-   for( const auto& o : orders )
+   for( const auto& level : depth.get_levels( base_id, quote_id, limit ) )
    {
-      if( o.sell_price.base.asset_id == base_id )
-      {
-         order ord;
-         ord.price = price_to_real( o.sell_price );
-         ord.quote = asset_to_real( share_type( ( uint128_t( o.for_sale.value ) * o.sell_price.quote.amount.value ) / o.sell_price.base.amount.value ), assets[1]->precision );
-         ord.base = asset_to_real( o.for_sale, assets[0]->precision );
-         result.bids.push_back( ord );
-      }
-      else
-      {
-         order ord;
-         ord.price = price_to_real( o.sell_price );
-         ord.quote = asset_to_real( o.for_sale, assets[1]->precision );
-         ord.base = asset_to_real( share_type( ( uint64_t( o.for_sale.value ) * o.sell_price.quote.amount.value ) / o.sell_price.base.amount.value ), assets[0]->precision );
-         result.asks.push_back( ord );
-      }
+      order ord;
+      ord.price = price_to_real( level.first );
+      ord.quote = asset_to_real( receive_amount( level.first, level.second.for_sale ), assets[1]->precision );
+      ord.base = asset_to_real( level.second.for_sale, assets[0]->precision );
+      result.bids.push_back( ord );
+   }
+
+   for( const auto& level : depth.get_levels( quote_id, base_id, limit ) )
+   {
+      order ord;
+      ord.price = price_to_real( level.first );
+      ord.quote = asset_to_real( level.second.for_sale, assets[1]->precision );
+      ord.base = asset_to_real( receive_amount( level.first, level.second.for_sale ), assets[0]->precision );
+      result.asks.push_back( ord );
    }
 
    return result;
@@ -2001,13 +2430,13 @@ set<public_key_type> database_api::get_required_signatures( const signed_transac
 
 set<public_key_type> database_api_impl::get_required_signatures( const signed_transaction& trx, const flat_set<public_key_type>& available_keys )const
 {
-   wdump((trx)(available_keys));
+   ddump((trx)(available_keys));
    auto result = trx.get_required_signatures( _db.get_chain_id(),
                                        available_keys,
                                        [this]( account_id_type id ){ return &id(_db).active; },
                                        [this]( account_id_type id ){ return &id(_db).owner; },
                                        _db.get_global_properties().parameters.max_authority_depth );
-   wdump((result));
+   ddump((result));
    return result;
 }
 
@@ -2022,7 +2451,7 @@ set<address> database_api::get_potential_address_signatures( const signed_transa
 
 set<public_key_type> database_api_impl::get_potential_signatures( const signed_transaction& trx )const
 {
-   wdump((trx));
+   ddump((trx));
    set<public_key_type> result;
    trx.get_required_signatures(
       _db.get_chain_id(),
@@ -2048,7 +2477,7 @@ set<public_key_type> database_api_impl::get_potential_signatures( const signed_t
       _db.get_global_properties().parameters.max_authority_depth
    );
 
-   wdump((result));
+   ddump((result));
    return result;
 }
 
@@ -2382,13 +2811,23 @@ void database_api_impl::on_objects_changed(const vector<object_id_type>& ids)
       }
    }
 
+   vector<pair<object_id_type,variant>> changed_objects;
+   if( _object_change_callback )
+      changed_objects = select_object_changes( ids );
+
    auto capture_this = shared_from_this();
 
    /// pushing the future back / popping the prior future if it is complete.
    /// if a connection hangs then this could get backed up and result in
    /// a failure to exit cleanly.
-   fc::async([capture_this,this,updates,market_broadcast_queue](){
+   fc::async([capture_this,this,updates,market_broadcast_queue,changed_objects](){
       if( _subscribe_callback ) _subscribe_callback( updates );
+      if( _object_change_callback && changed_objects.size() )
+      {
+         auto object_changes = diff_object_changes( changed_objects );
+         if( object_changes.size() )
+            _object_change_callback( fc::variant( object_changes ) );
+      }
 
       for( const auto& item : market_broadcast_queue )
       {
@@ -2399,6 +2838,93 @@ void database_api_impl::on_objects_changed(const vector<object_id_type>& ids)
    });
 }
 
+vector<pair<object_id_type,variant>> database_api_impl::select_object_changes( const vector<object_id_type>& ids )const
+{
+   vector<pair<object_id_type,variant>> selected;
+   for( const auto& id : ids )
+   {
+      bool of_filtered_type = false;
+      for( const auto& filter : _object_change_filters )
+         if( id.space() == filter.space_id && id.type() == filter.type_id )
+         {
+            of_filtered_type = true;
+            break;
+         }
+      if( !of_filtered_type )
+         continue;
+
+      const object* obj = _db.find_object( id );
+      if( obj && std::any_of( _object_change_filters.begin(), _object_change_filters.end(),
+                              [obj]( const object_change_filter& filter ) { return matches( filter, *obj ); } ) )
+         selected.emplace_back( id, obj->to_variant() );
+      else
+         selected.emplace_back( id, variant() );
+   }
+   return selected;
+}
+
+vector<variant> database_api_impl::diff_object_changes( const vector<pair<object_id_type,variant>>& objects )
+{
+   vector<variant> changes;
+   for( const auto& item : objects )
+   {
+      const object_id_type& id = item.first;
+      auto sent = _object_changes_sent.find( id );
+      if( item.second.is_null() )
+      {
+         if( sent != _object_changes_sent.end() )
+         {
+            changes.emplace_back( fc::mutable_variant_object( "id", fc::variant( id, 1 ) )( "removed", true ) );
+            _object_changes_order.erase( sent->second.position );
+            _object_changes_sent.erase( sent );
+         }
+         continue;
+      }
+
+      const fc::variant_object& current = item.second.get_object();
+      vector<uint64_t> fields;
+      fields.reserve( current.size() );
+      for( const auto& field : current )
+      {
+         string named = field.key() + '\0' + fc::json::to_string( field.value() );
+         fields.push_back( fc::city_hash64( named.data(), named.size() ) );
+      }
+
+      if( sent == _object_changes_sent.end() )
+         changes.emplace_back( fc::mutable_variant_object( "id", fc::variant( id, 1 ) )( "object", current ) );
+      else
+      {
+         const auto& previous = sent->second.fields;
+         fc::mutable_variant_object changed;
+         size_t i = 0;
+         for( const auto& field : current )
+            if( !std::binary_search( previous.begin(), previous.end(), fields[i++] ) )
+               changed( field.key(), field.value() );
+         if( changed.size() == 0 )
+            continue;
+         changes.emplace_back( fc::mutable_variant_object( "id", fc::variant( id, 1 ) )( "changed", changed ) );
+      }
+      std::sort( fields.begin(), fields.end() );
+
+      if( sent == _object_changes_sent.end() )
+      {
+         if( _object_changes_sent.size() >= max_object_changes_tracked )
+         {
+            _object_changes_sent.erase( _object_changes_order.back() );
+            _object_changes_order.pop_back();
+         }
+         _object_changes_order.push_front( id );
+         _object_changes_sent[id] = sent_object{ std::move( fields ), _object_changes_order.begin() };
+      }
+      else
+      {
+         _object_changes_order.splice( _object_changes_order.begin(), _object_changes_order, sent->second.position );
+         sent->second.fields = std::move( fields );
+      }
+   }
+   return changes;
+}
+
 /** note: this method cannot yield because it is called in the middle of
  * apply a block.
  */
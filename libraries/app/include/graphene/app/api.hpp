@@ -38,6 +38,8 @@
 #include <fc/optional.hpp>
 #include <fc/crypto/elliptic.hpp>
 #include <fc/network/ip.hpp>
+#include <fc/rpc/api_metrics.hpp>
+#include <fc/rpc/api_rate_limiter.hpp>
 
 #include <boost/container/flat_set.hpp>
 
@@ -266,6 +268,11 @@ namespace graphene { namespace app {
           */
          std::vector<net::peer_status> get_connected_peers() const;
 
+         /**
+          * @brief Get traffic by message type, item fetch latency and inventory usefulness for each connected peer
+          */
+         std::vector<net::peer_metrics> get_peer_metrics() const;
+
          /**
           * @brief Get advanced node parameters, such as desired and max
           *        number of connections
@@ -284,6 +291,41 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get call counts, errors, latencies and response sizes of the RPC servers by API method,
+          *        the methods with the highest total time first
+          */
+         std::vector<fc::rpc::api_call_metrics> get_api_metrics() const;
+
+         /**
+          * @brief Get call counts, errors, latencies and response sizes of the RPC servers by client address,
+          *        the clients with the highest total time first
+          */
+         std::vector<fc::rpc::api_call_metrics> get_api_client_metrics() const;
+
+         /**
+          * @brief Clear the API metrics
+          */
+         void reset_api_metrics();
+
+         /**
+          * @brief Set the execution times above which single API calls are logged as warnings and errors
+          * @param warn_ms the time in milliseconds at which to warn
+          * @param max_ms the time in milliseconds at which to log an error
+          */
+         void set_api_call_thresholds( uint32_t warn_ms, uint32_t max_ms );
+
+         /**
+          * @brief Get the API call costs and the budgets of connections and client addresses
+          */
+         fc::rpc::api_rate_limits get_api_rate_limits() const;
+
+         /**
+          * @brief Set the API call costs and the budgets of connections and client addresses
+          * @param limits the new limits, budgets of 0 disable limiting
+          */
+         void set_api_rate_limits( const fc::rpc::api_rate_limits& limits );
+
       private:
          application& _app;
    };
@@ -417,9 +459,16 @@ FC_API(graphene::app::network_node_api,
        (get_info)
        (add_node)
        (get_connected_peers)
+       (get_peer_metrics)
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_api_metrics)
+       (get_api_client_metrics)
+       (reset_api_metrics)
+       (set_api_call_thresholds)
+       (get_api_rate_limits)
+       (set_api_rate_limits)
      )
 FC_API(graphene::app::crypto_api,
        /*(blind_sign)
@@ -98,6 +98,9 @@ namespace graphene { namespace app {
          void set_api_access_info(const string& username, api_access_info&& permissions);
 
          bool is_finished_syncing()const;
+
+         /// Whether API calls to @p method may run on the api-threads pool, concurrently with each other
+         static bool is_concurrent_api_call( const string& method );
          /// Emitted when syncing finishes (is_finished_syncing will return true)
          boost::signals2::signal<void()> syncing_finished;
 
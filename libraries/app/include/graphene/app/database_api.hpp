@@ -119,6 +119,41 @@ struct cheque_info_object
 
 }; // cheque_info_object
 
+/**
+ * @brief Selects the objects reported by @ref database_api::subscribe_to_object_changes
+ */
+struct object_change_filter
+{
+   uint8_t                                      space_id = protocol_ids;
+   uint8_t                                      type_id = 0;
+   /// only objects owned by one of these accounts, e.g. their balances, orders or statistics; any owner if empty
+   flat_set<account_id_type>                    accounts;
+   /// only limit orders of this market, in either direction
+   optional<pair<asset_id_type,asset_id_type>>  market;
+};
+
+struct asset_holder
+{
+   account_id_type            account_id;
+   string                     name;
+   share_type                 amount;
+};
+
+struct asset_holders_summary
+{
+   asset_id_type              asset_id;
+   /// accounts with a positive balance
+   uint64_t                   holders = 0;
+   /// sum of their balances
+   share_type                 total;
+   /// held by the 10, 100 and 1000 largest holders
+   share_type                 top_10;
+   share_type                 top_100;
+   share_type                 top_1000;
+   /// entry i counts the balances from 10^i up to 10^(i+1)-1 in the smallest unit of the asset
+   vector<uint64_t>           by_magnitude;
+};
+
 /**
  * @brief The database_api class implements the RPC API for the chain database.
  *
@@ -145,6 +180,17 @@ class database_api
        */
       fc::variants get_objects(const vector<object_id_type>& ids)const;
 
+      /**
+       * @brief Get the named fields of the objects corresponding to the provided IDs
+       * @param ids IDs of the objects to retrieve
+       * @param fields names of the fields to return, e.g. "id" and "name", or dotted paths into them like "options.memo_key"
+       * @return The objects retrieved with only the requested fields, in the order they are mentioned in ids
+       *
+       * Accounts are converted field by field, so that e.g. their address lists cost nothing unless requested.
+       * Otherwise this function has semantics identical to @ref get_objects
+       */
+      fc::variants get_objects_fields(const vector<object_id_type>& ids, const flat_set<string>& fields)const;
+
       optional<object_id_type> get_last_object_id(object_id_type id) const;
 
       ///////////////////
@@ -161,6 +207,31 @@ class database_api
        */
       void cancel_all_subscriptions();
 
+      /**
+       * @brief Request notification of the objects of given types that are created, changed or removed
+       * @param callback Callback method which is called with the changes of each applied block, and also with
+       *        those of each transaction pushed to the pending state
+       * @param filters An object is reported if it matches any of the filters, at most 100 of them
+       *
+       * Unlike @ref set_subscribe_callback the filtering is exact and changes are sent as compact diffs.  The
+       * callback is passed an array of changes, each with the object "id" and either the full "object" when it is
+       * reported for the first time, only the "changed" top level fields, or "removed" when it was removed or no
+       * longer matches.  A new subscription replaces the previous one of this connection.
+       *
+       * Changes made by pending transactions are not final.  The objects of a block are diffed against what was
+       * last sent, so a pending change that made it into the block is not sent again, while one that was dropped
+       * is only corrected when a later block changes the object.
+       *
+       * Diffs are kept for the 10000 most recently changed objects.  Older ones are sent in full again when they
+       * change, and their removal is not reported.
+       */
+      void subscribe_to_object_changes( std::function<void(const variant&)> callback,
+                                        const vector<object_change_filter>& filters );
+      /**
+       * @brief Stop the notifications requested with @ref subscribe_to_object_changes
+       */
+      void unsubscribe_from_object_changes();
+
       /////////////////////////////
       // Blocks and transactions //
       /////////////////////////////
@@ -254,6 +325,16 @@ class database_api
        */
       vector<optional<account_object>> get_accounts(const vector<account_id_type>& account_ids) const;
 
+      /**
+       * @brief Get the named fields of a list of accounts by ID
+       * @param account_ids IDs of the accounts to retrieve
+       * @param fields names of the account_object fields to return, e.g. "name", or dotted paths like "options.votes"
+       * @return The accounts with only the requested fields, null for IDs without an account
+       *
+       * This function has semantics identical to @ref get_objects
+       */
+      vector<fc::variant> get_accounts_fields(const vector<account_id_type>& account_ids, const flat_set<string>& fields) const;
+
       /**
        * @brief Returns account addresses
        */
@@ -294,6 +375,20 @@ class database_api
        */
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids, bool subscribe );
 
+      /**
+       * @brief Fetch the selected parts of the objects relevant to the specified accounts
+       * @param names_or_ids Each item must be the name or ID of an account to retrieve
+       * @param subscribe whether to subscribe to updates of the accounts
+       * @param sections names of the @ref full_account members to return, e.g. "balances" or "account.name"; empty
+       *        returns all of them
+       * @return Map of string from @ref names_or_ids to the requested parts of the corresponding account
+       *
+       * Parts that are not requested are neither looked up nor serialized. Otherwise this function has semantics
+       * identical to @ref get_full_accounts
+       */
+      std::map<string,fc::variant_object> get_full_accounts_sections( const vector<string>& names_or_ids, bool subscribe,
+                                                                      const flat_set<string>& sections );
+
       optional<bonus_balances_object> get_bonus_balances( string name_or_id ) const;
 
       optional<account_object> get_account_by_name( string name )const;
@@ -377,6 +472,24 @@ class database_api
        */
       vector<optional<asset_object>> lookup_asset_symbols(const vector<string>& symbols_or_ids)const;
 
+      /**
+       * @brief Get the holders of an asset, largest balance first
+       * @param asset_id ID of the asset
+       * @param after The last holder of the previous page, null to start with the largest holder
+       * @param limit Maximum number of holders to return (must not exceed 100)
+       * @return The holders with a positive balance, ties ordered by account ID
+       */
+      vector<asset_holder> get_asset_holders(asset_id_type asset_id, optional<asset_holder> after, uint32_t limit)const;
+
+      /**
+       * @brief Get the number of holders of an asset and how its supply is distributed among them
+       * @param asset_id ID of the asset
+       *
+       * The summary is computed once per block and asset, later calls in the same block return it again, also
+       * on other API connections.
+       */
+      asset_holders_summary get_asset_holders_summary(asset_id_type asset_id)const;
+
       ////////////
       // Funds  //
       ////////////
@@ -511,7 +624,7 @@ class database_api
        * @param base String name of the first asset
        * @param quote String name of the second asset
        * @param depth of the order book. Up to depth of each asks and bids, capped at 50. Prioritizes most moderate of each
-       * @return Order book of the market
+       * @return Order book of the market, with all orders at the same price aggregated into one entry
        */
       order_book get_order_book( const string& base, const string& quote, unsigned limit = 50 )const;
 
@@ -702,10 +815,15 @@ FC_REFLECT( graphene::app::cheque_info_object,
             (datetime_expiration)
             (payee_amount)
           );
+FC_REFLECT( graphene::app::object_change_filter, (space_id)(type_id)(accounts)(market) );
+FC_REFLECT( graphene::app::asset_holder, (account_id)(name)(amount) );
+FC_REFLECT( graphene::app::asset_holders_summary,
+            (asset_id)(holders)(total)(top_10)(top_100)(top_1000)(by_magnitude) );
 
 FC_API(graphene::app::database_api,
    // Objects
    (get_objects)
+   (get_objects_fields)
    (get_last_object_id)
 
    // Subscriptions
@@ -713,6 +831,8 @@ FC_API(graphene::app::database_api,
    (set_pending_transaction_callback)
    (set_block_applied_callback)
    (cancel_all_subscriptions)
+   (subscribe_to_object_changes)
+   (unsubscribe_from_object_changes)
 
    // Blocks and transactions
    (get_block_header)
@@ -739,6 +859,7 @@ FC_API(graphene::app::database_api,
 
    // Accounts
    (get_accounts)
+   (get_accounts_fields)
    (get_account_addresses)
    (get_referrals)
    (get_referrals_by_id)
@@ -746,6 +867,7 @@ FC_API(graphene::app::database_api,
    (get_user_count_by_ranks)
    (get_user_count_with_balances)
    (get_full_accounts)
+   (get_full_accounts_sections)
    (get_bonus_balances)
    (get_account_by_name)
    (get_account_references)
@@ -764,6 +886,8 @@ FC_API(graphene::app::database_api,
    (get_assets)
    (list_assets)
    (lookup_asset_symbols)
+   (get_asset_holders)
+   (get_asset_holders_summary)
 
    // Funds
    (list_funds)
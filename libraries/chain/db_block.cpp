@@ -117,6 +117,7 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
   //idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   detail::chain_write_lock write_lock( *this );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -229,6 +230,7 @@ bool database::_push_block(const signed_block& new_block)
  */
 processed_transaction database::push_transaction( const signed_transaction& trx, uint32_t skip )
 { try {
+   detail::chain_write_lock write_lock( *this );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -237,7 +239,48 @@ processed_transaction database::push_transaction( const signed_transaction& trx,
    return result;
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
-processed_transaction database::_push_transaction( const signed_transaction& trx )
+processed_transaction database::push_transaction( const precomputed_transaction& trx, uint32_t skip )
+{ try {
+   detail::chain_write_lock write_lock( *this );
+   processed_transaction result;
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      result = _push_transaction( trx.transaction(), &trx.signature_keys() );
+   } );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (trx.transaction()) ) }
+
+void database::precheck_transaction_state( const signed_transaction& trx )const
+{ try {
+   const chain_parameters& chain_parameters = get_global_properties().parameters;
+   FC_ASSERT( fc::raw::pack_size( trx ) <= chain_parameters.maximum_transaction_size,
+              "Transaction exceeds the maximum transaction size",
+              ("max",chain_parameters.maximum_transaction_size) );
+
+   const auto& trx_idx = get_index_type<transaction_index>().indices().get<by_trx_id>();
+   FC_ASSERT( trx_idx.find( trx.id() ) == trx_idx.end(), "Duplicate transaction" );
+
+   // the same checks as in _apply_transaction()
+   if( BOOST_LIKELY(head_block_num() > 0) )
+   {
+      const auto& tapos_block_summary = block_summary_id_type( trx.ref_block_num )(*this);
+      FC_ASSERT( trx.ref_block_prefix == tapos_block_summary.block_id._hash[1] );
+
+      fc::time_point_sec now = head_block_time();
+      FC_ASSERT( trx.expiration <= now + chain_parameters.maximum_time_until_expiration, "",
+                 ("trx.expiration",trx.expiration)("now",now)("max_til_exp",chain_parameters.maximum_time_until_expiration));
+      FC_ASSERT( now <= trx.expiration, "", ("now",now)("trx.exp",trx.expiration) );
+   }
+} FC_CAPTURE_AND_RETHROW( (trx) ) }
+
+precomputed_transaction database::precompute_transaction( const signed_transaction& trx, const chain_id_type& chain_id )
+{ try {
+   trx.validate();
+   return precomputed_transaction( trx, trx.get_signature_keys( chain_id ) );
+} FC_CAPTURE_AND_RETHROW( (trx) ) }
+
+processed_transaction database::_push_transaction( const signed_transaction& trx,
+                                                   const flat_set<public_key_type>* signature_keys )
 {
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
@@ -250,7 +293,7 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // apply the changes.
 
    auto temp_session = _undo_db.start_undo_session();
-   auto processed_trx = _apply_transaction( trx, false );
+   auto processed_trx = _apply_transaction( trx, false, signature_keys );
    _pending_tx.push_back(processed_trx);
 
    notify_changed_objects();
@@ -264,6 +307,7 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
 
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
+   detail::chain_write_lock write_lock( *this );
    auto session = _undo_db.start_undo_session();
    return _apply_transaction( trx );
 }
@@ -317,6 +361,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   detail::chain_write_lock write_lock( *this );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -433,6 +478,7 @@ signed_block database::_generate_block(
  */
 void database::pop_block()
 { try {
+   detail::chain_write_lock write_lock( *this );
    _pending_tx_session.reset();
    auto head_id = head_block_id();
    optional<signed_block> head_block = fetch_block_by_id( head_id );
@@ -448,6 +494,7 @@ void database::pop_block()
 
 void database::clear_pending()
 { try {
+   detail::chain_write_lock write_lock( *this );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
    _pending_tx_session.reset();
@@ -600,7 +647,8 @@ processed_transaction database::apply_transaction(const signed_transaction& trx,
    return result;
 }
 
-processed_transaction database::_apply_transaction(const signed_transaction& trx, bool need_apply_address_creation)
+processed_transaction database::_apply_transaction(const signed_transaction& trx, bool need_apply_address_creation,
+                                                   const flat_set<public_key_type>* signature_keys)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
@@ -621,7 +669,11 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      if( signature_keys )
+         graphene::chain::verify_authority( trx.operations, *signature_keys, get_active, get_owner,
+                                            get_global_properties().parameters.max_authority_depth );
+      else
+         trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -230,7 +230,10 @@ void database::initialize_indexes()
    add_index<primary_index<restricted_account_index>>();
    add_index<primary_index<committee_member_index>>();
    add_index<primary_index<witness_index>>();
-   add_index<primary_index<limit_order_index>>();
+
+   auto limit_order_idx = add_index<primary_index<limit_order_index>>();
+   limit_order_idx->add_secondary_index<limit_order_depth_index>();
+
    add_index<primary_index<call_order_index>>();
 
    auto prop_index = add_index<primary_index<proposal_index>>();
@@ -441,6 +441,19 @@ bool database::check_call_orders(const asset_object& mia, bool enable_black_swan
     const call_order_index& call_index = get_index_type<call_order_index>();
     const auto& call_price_index = call_index.indices().get<by_price>();
 
+    // by_price orders positions by the price at which they become callable, so the first one
+    // is the closest to a margin call.  If the feed protects it, it protects every other position
+    // and there is no need to look at the order book at all.
+    auto call_min = price::min( bitasset.options.short_backing_asset, mia.id );
+    auto call_max = price::max( bitasset.options.short_backing_asset, mia.id );
+    auto call_itr = call_price_index.lower_bound( call_min );
+    auto call_end = call_price_index.upper_bound( call_max );
+
+    if( call_itr == call_end )
+       return false;
+    if( head_block_time() > HARDFORK_436_TIME && bitasset.current_feed.settlement_price > ~call_itr->call_price )
+       return false;
+
     const limit_order_index& limit_index = get_index_type<limit_order_index>();
     const auto& limit_price_index = limit_index.indices().get<by_price>();
 
@@ -457,11 +470,6 @@ bool database::check_call_orders(const asset_object& mia, bool enable_black_swan
     if( limit_itr == limit_end )
        return false;
 
-    auto call_min = price::min( bitasset.options.short_backing_asset, mia.id );
-    auto call_max = price::max( bitasset.options.short_backing_asset, mia.id );
-    auto call_itr = call_price_index.lower_bound( call_min );
-    auto call_end = call_price_index.upper_bound( call_max );
-
     bool filled_limit = false;
     bool margin_called = false;
 
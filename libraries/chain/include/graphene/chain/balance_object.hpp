@@ -25,6 +25,8 @@
 
 #include <graphene/chain/vesting_balance_object.hpp>
 
+#include <boost/multi_index/composite_key.hpp>
+
 namespace graphene { namespace chain {
 
    class balance_object : public abstract_object<balance_object>
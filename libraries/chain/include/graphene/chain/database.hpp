@@ -43,6 +43,8 @@
 
 #include <fc/log/logger.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include <map>
 
 namespace graphene { namespace chain {
@@ -53,6 +55,28 @@ namespace graphene { namespace chain {
 
    struct budget_record;
 
+   namespace detail { struct chain_write_lock; }
+
+   /**
+    *  A transaction together with the keys recovered from its own signatures.  Only
+    *  database::precompute_transaction() creates one, so pushing it cannot pass the authority checks with keys
+    *  that never signed the transaction.
+    */
+   class precomputed_transaction
+   {
+      public:
+         const signed_transaction&        transaction()const    { return _trx; }
+         const flat_set<public_key_type>& signature_keys()const { return _signature_keys; }
+
+      private:
+         friend class database;
+         precomputed_transaction( signed_transaction trx, flat_set<public_key_type> signature_keys )
+            : _trx( std::move( trx ) ), _signature_keys( std::move( signature_keys ) ) {}
+
+         signed_transaction        _trx;
+         flat_set<public_key_type> _signature_keys;
+   };
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
@@ -146,7 +170,22 @@ namespace graphene { namespace chain {
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
-         processed_transaction _push_transaction( const signed_transaction& trx );
+         processed_transaction _push_transaction( const signed_transaction& trx ) { return _push_transaction( trx, nullptr ); }
+
+         /**
+          *  Checks for transactions received from the network, split so that the expensive part stays off
+          *  the chain thread.  precheck_transaction_state() rejects transactions that are too large, expired,
+          *  already known or refer to a block we don't have, using only cheap lookups.
+          *  precompute_transaction() validates the operations and recovers the signature keys; it does not
+          *  touch the database, so it may run on any thread, e.g. through fc::do_parallel().  Pushing the
+          *  precomputed transaction skips the signature recovery under the write lock; everything else is
+          *  checked again there.
+          */
+         ///@{
+         void precheck_transaction_state( const signed_transaction& trx )const;
+         static precomputed_transaction precompute_transaction( const signed_transaction& trx, const chain_id_type& chain_id );
+         processed_transaction push_transaction( const precomputed_transaction& trx, uint32_t skip = skip_nothing );
+         ///@}
 
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
@@ -166,6 +205,18 @@ namespace graphene { namespace chain {
          void pop_block();
          void clear_pending();
 
+         /**
+          *  Calls callback while holding the chain read lock.  Block and transaction application hold
+          *  this lock exclusively, so callback sees a consistent state even when it runs on a thread
+          *  other than the one that owns the database.
+          */
+         template<typename Lambda>
+         auto with_read_lock( Lambda&& callback )const -> decltype( callback() )
+         {
+            boost::shared_lock< boost::shared_mutex > lock( _chain_mutex );
+            return callback();
+         }
+
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
           *  operations should include any operation actually included in a transaction as well
@@ -447,8 +498,11 @@ namespace graphene { namespace chain {
          const int& get_history_size() const { return history_size; }
 
       private:
+         processed_transaction _push_transaction( const signed_transaction& trx,
+                                                  const flat_set<public_key_type>* signature_keys );
          void                  _apply_block( const signed_block& next_block );
-         processed_transaction _apply_transaction( const signed_transaction& trx, bool need_apply_address_creation = true );
+         processed_transaction _apply_transaction( const signed_transaction& trx, bool need_apply_address_creation = true,
+                                                   const flat_set<public_key_type>* signature_keys = nullptr );
 
          ///Steps involved in applying a new block
          ///@{
@@ -545,6 +599,10 @@ namespace graphene { namespace chain {
           * or assertion fail during database::open() method.
           */
          bool                              _opened = false;
+
+         friend struct detail::chain_write_lock;
+         mutable boost::shared_mutex       _chain_mutex;
+         uint32_t                          _chain_write_depth = 0; ///< nesting of chain_write_lock on the database thread
    };
 
    namespace detail
@@ -112,6 +112,32 @@ struct pending_transactions_restorer
    std::vector< processed_transaction > _pending_transactions;
 };
 
+/**
+ * Holds database::_chain_mutex exclusively for its lifetime, which keeps readers using
+ * database::with_read_lock() out while the chain state changes.
+ *
+ * All writers run on the thread that owns the database, so a nested or interleaved writer
+ * on that thread only bumps the depth, e.g. push_block() reapplying pending transactions.
+ */
+struct chain_write_lock
+{
+   chain_write_lock( database& db )
+      : _db( db )
+   {
+      if( _db._chain_write_depth == 0 )
+         _db._chain_mutex.lock();
+      ++_db._chain_write_depth;
+   }
+
+   ~chain_write_lock()
+   {
+      if( --_db._chain_write_depth == 0 )
+         _db._chain_mutex.unlock();
+   }
+
+   database& _db;
+};
+
 /**
  * Set the skip_flags to the given value, call callback,
  * then reset skip_flags to their previous value after
@@ -97,6 +97,46 @@ typedef multi_index_container<
 
 typedef generic_index<limit_order_object, limit_order_multi_index_type> limit_order_index;
 
+/**
+ *  @brief the aggregated amount offered by all limit orders resting at one price
+ */
+struct limit_order_depth_level
+{
+   share_type for_sale;        ///< sum of limit_order_object::for_sale, asset id is the level price base
+   uint32_t   order_count = 0;
+};
+
+/**
+ *  @brief tracks the depth of every order book aggregated by price level
+ *  @ingroup object
+ *  @ingroup market
+ *
+ *  This is a secondary index on the limit_order_index.  Levels are ordered the same way as
+ *  the by_price index, so one side of a market is the range
+ *  [price::max(base,quote), price::min(base,quote)] and the best price comes first.
+ */
+class limit_order_depth_index : public secondary_index
+{
+   public:
+      typedef std::map< price, limit_order_depth_level, std::greater<price> > level_map;
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      /** @return up to limit levels selling base for quote, best price first */
+      vector< pair<price, limit_order_depth_level> > get_levels( asset_id_type base, asset_id_type quote, uint32_t limit )const;
+
+      const level_map& levels()const { return _levels; }
+
+   private:
+      void add( const limit_order_object& o );
+      void subtract( const limit_order_object& o );
+
+      level_map _levels;
+};
+
 /**
  * @class call_order_object
  * @brief tracks debt and call price information
@@ -145,6 +185,10 @@ class force_settlement_object : public abstract_object<force_settlement_object>
 struct by_collateral;
 struct by_account;
 struct by_price;
+/**
+ *  by_price orders call orders by call_price, the price at which each position becomes callable,
+ *  so database::check_call_orders only has to visit the positions crossed by the current feed.
+ */
 typedef multi_index_container<
    call_order_object,
    indexed_by<
@@ -203,6 +247,8 @@ FC_REFLECT_DERIVED( graphene::chain::limit_order_object,
                     (expiration)(seller)(for_sale)(sell_price)(deferred_fee)
                   )
 
+FC_REFLECT( graphene::chain::limit_order_depth_level, (for_sale)(order_count) )
+
 FC_REFLECT_DERIVED( graphene::chain::call_order_object, (graphene::db::object),
                     (borrower)(collateral)(debt)(call_price) )
 
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/market_object.hpp>
+
+namespace graphene { namespace chain {
+
+void limit_order_depth_index::add( const limit_order_object& o )
+{
+   auto& level = _levels[o.sell_price];
+   level.for_sale += o.for_sale;
+   ++level.order_count;
+}
+
+void limit_order_depth_index::subtract( const limit_order_object& o )
+{
+   auto itr = _levels.find( o.sell_price );
+   assert( itr != _levels.end() );
+   if( itr == _levels.end() )
+      return;
+
+   if( --itr->second.order_count == 0 )
+      _levels.erase( itr );
+   else
+      itr->second.for_sale -= o.for_sale;
+}
+
+void limit_order_depth_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const limit_order_object*>(&obj) );
+   add( static_cast<const limit_order_object&>(obj) );
+}
+
+void limit_order_depth_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const limit_order_object*>(&obj) );
+   subtract( static_cast<const limit_order_object&>(obj) );
+}
+
+void limit_order_depth_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const limit_order_object*>(&before) );
+   subtract( static_cast<const limit_order_object&>(before) );
+}
+
+void limit_order_depth_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const limit_order_object*>(&after) );
+   add( static_cast<const limit_order_object&>(after) );
+}
+
+vector< pair<price, limit_order_depth_level> > limit_order_depth_index::get_levels( asset_id_type base,
+                                                                                    asset_id_type quote,
+                                                                                    uint32_t limit )const
+{
+   vector< pair<price, limit_order_depth_level> > result;
+
+   auto itr = _levels.lower_bound( price::max( base, quote ) );
+   auto end = _levels.upper_bound( price::min( base, quote ) );
+   while( itr != end && result.size() < limit )
+   {
+      result.emplace_back( itr->first, itr->second );
+      ++itr;
+   }
+   return result;
+}
+
+} } // graphene::chain
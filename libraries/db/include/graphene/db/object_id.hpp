@@ -209,6 +209,25 @@ struct reflector<graphene::db::object_id<SpaceID,TypeID,T> >
     vo.instance = fc::to_uint64(s.substr( second_dot+1 ));
  } FC_CAPTURE_AND_RETHROW( (var) ) }
 
+ template<typename T, typename Enable> struct json_serializer;
+
+ /** writes the same "space.type.instance" string as to_variant() without building it first */
+ template<uint8_t SpaceID, uint8_t TypeID, typename T>
+ struct json_serializer< graphene::db::object_id<SpaceID,TypeID,T>, void >
+ {
+    template<typename Writer>
+    static void write( Writer& w, const graphene::db::object_id<SpaceID,TypeID,T>& id )
+    {
+       w.write_raw( '"' );
+       w.write_number( uint64_t( SpaceID ) );
+       w.write_raw( '.' );
+       w.write_number( uint64_t( TypeID ) );
+       w.write_raw( '.' );
+       w.write_number( uint64_t( id.instance.value ) );
+       w.write_raw( '"' );
+    }
+ };
+
 } // namespace fc
 
 namespace std {
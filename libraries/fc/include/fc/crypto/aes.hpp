@@ -38,6 +38,50 @@ namespace fc {
          fc::fwd<impl,96> my;
     };
 
+    /**
+     *  AES-256-GCM for a stream of messages.  Each message gets the next
+     *  nonce from a counter and ends with a 16 byte tag authenticating
+     *  everything encoded since begin_message(), so a key must only ever be
+     *  used by one encoder.
+     */
+    class aes_gcm_encoder
+    {
+       public:
+         static const uint32_t tag_size = 16;
+
+         aes_gcm_encoder();
+         ~aes_gcm_encoder();
+
+         void     init( const fc::sha256& key );
+         void     begin_message();
+         /** may be called several times per message, ciphertxt may equal plaintxt */
+         uint32_t encode( const char* plaintxt, uint32_t len, char* ciphertxt );
+         /** writes tag_size bytes */
+         void     end_message( char* tag );
+
+       private:
+         struct      impl;
+         fc::fwd<impl,96> my;
+    };
+    class aes_gcm_decoder
+    {
+       public:
+         static const uint32_t tag_size = aes_gcm_encoder::tag_size;
+
+         aes_gcm_decoder();
+         ~aes_gcm_decoder();
+
+         void     init( const fc::sha256& key );
+         void     begin_message();
+         uint32_t decode( const char* ciphertxt, uint32_t len, char* plaintext );
+         /** throws if the tag doesn't match what was decoded since begin_message() */
+         void     end_message( const char* tag );
+
+       private:
+         struct      impl;
+         fc::fwd<impl,96> my;
+    };
+
     unsigned aes_encrypt(unsigned char *plaintext, int plaintext_len, unsigned char *key,
                          unsigned char *iv, unsigned char *ciphertext);
     unsigned aes_decrypt(unsigned char *ciphertext, int ciphertext_len, unsigned char *key,
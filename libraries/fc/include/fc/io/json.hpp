@@ -25,7 +25,13 @@ namespace fc
             relaxed_parser        = 2,
             legacy_parser_with_string_doubles = 3,
 #endif
-            broken_nul_parser     = 4
+            broken_nul_parser     = 4,
+            /**
+             *  Accepts exactly what legacy_parser accepts, but from_string() and is_valid() parse
+             *  straight out of the string's buffer instead of through a buffered_istream.  Streams
+             *  are not contiguous, so from_stream() and from_file() treat it as legacy_parser.
+             */
+            insitu_parser         = 5
          };
          enum output_formatting
          {
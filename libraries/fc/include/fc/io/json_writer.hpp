@@ -0,0 +1,330 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/static_variant.hpp>
+#include <fc/container/flat_fwd.hpp>
+#include <fc/optional.hpp>
+#include <fc/safe.hpp>
+#include <fc/smart_ref_fwd.hpp>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fc
+{
+   class json_writer;
+
+   /**
+    *  Writes one type as JSON.  The primary template converts through fc::variant and is used for
+    *  every type with a hand written to_variant; reflected types, containers and scalars are
+    *  specialized below to write straight into the output buffer.
+    */
+   template<typename T, typename Enable = void>
+   struct json_serializer
+   {
+      static void write( json_writer& w, const T& v );
+   };
+
+   /**
+    *  Writes values as JSON into a string without building an intermediate fc::variant tree.  The
+    *  output is byte for byte what fc::json::to_string( fc::variant(v) ) produces with the same
+    *  formatting, so both can be used interchangeably on the wire.
+    */
+   class json_writer
+   {
+      public:
+         /** the default nesting limit of fc::json */
+         static const uint32_t default_max_depth = 200;
+
+         json_writer( std::string& out,
+                      json::output_formatting format = json::stringify_large_ints_and_doubles,
+                      uint32_t max_depth = default_max_depth )
+         :_out(out),_format(format),_max_depth(max_depth){}
+
+         /** same as fc::json::to_string( fc::variant( v, max_depth ), format, max_depth ) */
+         template<typename T>
+         static std::string to_string( const T& v, json::output_formatting format = json::stringify_large_ints_and_doubles,
+                                       uint32_t max_depth = default_max_depth )
+         {
+            std::string out;
+            json_writer( out, format, max_depth ).write( v );
+            return out;
+         }
+
+         template<typename T>
+         json_writer& write( const T& v )
+         {
+            json_serializer<T>::write( *this, v );
+            return *this;
+         }
+
+         void write( const variant& v );
+         void write( const variants& v );
+         void write( const variant_object& v );
+         void write( const std::string& s );
+         void write( const char* s ) { write( std::string( s ) ); }
+         void write( bool b ) { _out += b ? "true" : "false"; }
+         void write( int64_t i );
+         void write( uint64_t i );
+         void write( int32_t i ) { write_number( int64_t( i ) ); }
+         void write( uint32_t i ) { write_number( uint64_t( i ) ); }
+         void write( int16_t i ) { write_number( int64_t( i ) ); }
+         void write( uint16_t i ) { write_number( uint64_t( i ) ); }
+         void write( int8_t i ) { write_number( int64_t( i ) ); }
+         void write( uint8_t i ) { write_number( uint64_t( i ) ); }
+
+         /** appends already encoded JSON */
+         void write_raw( const char* s, size_t len ) { _out.append( s, len ); }
+         void write_raw( char c ) { _out += c; }
+
+         void write_key( const char* key );
+
+         /** appends the decimal digits of i, never quoted */
+         void write_number( int64_t i );
+         void write_number( uint64_t i );
+
+         template<typename Iterator>
+         void write_array( Iterator begin, Iterator end )
+         {
+            scope nested( *this );
+            _out += '[';
+            for( auto itr = begin; itr != end; ++itr )
+            {
+               if( itr != begin )
+                  _out += ',';
+               write( *itr );
+            }
+            _out += ']';
+         }
+
+         /** decrements the remaining depth for the lifetime of a nested array or object */
+         struct scope
+         {
+            scope( json_writer& w ):_w(w)
+            {
+               FC_ASSERT( _w._max_depth > 0, "Too many nested objects!" );
+               --_w._max_depth;
+            }
+            ~scope() { ++_w._max_depth; }
+            json_writer& _w;
+         };
+
+         uint32_t                 max_depth()const { return _max_depth; }
+         json::output_formatting  format()const    { return _format; }
+         std::string&             buffer()         { return _out; }
+
+      private:
+         std::string&             _out;
+         json::output_formatting  _format;
+         uint32_t                 _max_depth;
+   };
+
+   namespace detail
+   {
+      /** true if fc::variant( T ) would use the reflection based conversion of fc/reflect/variant.hpp */
+      template<typename T>
+      struct is_reflected_for_json
+      {
+         static const bool value = fc::reflector<T>::is_defined::value &&
+            std::is_same< decltype( to_variant( std::declval<const T&>(), std::declval<variant&>(), uint32_t(1) ) ),
+                          reflected_variant_conversion >::value;
+      };
+
+      template<typename T, typename IsEnum = typename fc::reflector<T>::is_enum>
+      struct reflected_json_writer
+      {
+         template<typename Member>
+         static void add( json_writer& w, const char* name, const optional<Member>& v, bool& first )
+         {
+            if( v.valid() )
+               add( w, name, *v, first );
+         }
+         template<typename Member>
+         static void add( json_writer& w, const char* name, const Member& v, bool& first )
+         {
+            if( !first )
+               w.write_raw( ',' );
+            first = false;
+            w.write_key( name );
+            w.write( v );
+         }
+
+         struct visitor
+         {
+            visitor( json_writer& w, const T& v ):_w(w),_val(v){}
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()( const char* name )const
+            {
+               add( _w, name, _val.*member, _first );
+            }
+
+            json_writer& _w;
+            const T&     _val;
+            mutable bool _first = true;
+         };
+
+         static void write( json_writer& w, const T& v )
+         {
+            json_writer::scope nested( w );
+            w.write_raw( '{' );
+            fc::reflector<T>::visit( visitor( w, v ) );
+            w.write_raw( '}' );
+         }
+      };
+
+      template<typename T>
+      struct reflected_json_writer<T, fc::true_type>
+      {
+         static void write( json_writer& w, const T& v )
+         {
+            w.write( std::string( fc::reflector<T>::to_fc_string( v ) ) );
+         }
+      };
+
+      struct static_variant_json_writer
+      {
+         typedef void result_type;
+         static_variant_json_writer( json_writer& w ):_w(w){}
+         template<typename T> void operator()( const T& v )const { _w.write( v ); }
+         json_writer& _w;
+      };
+   } // namespace detail
+
+   template<typename T, typename Enable>
+   void json_serializer<T,Enable>::write( json_writer& w, const T& v )
+   {
+      w.write( variant( v, w.max_depth() ) );
+   }
+
+   template<typename T>
+   struct json_serializer< T, typename std::enable_if< detail::is_reflected_for_json<T>::value >::type >
+   {
+      static void write( json_writer& w, const T& v ) { detail::reflected_json_writer<T>::write( w, v ); }
+   };
+
+   template<typename T>
+   struct json_serializer< std::vector<T> >
+   {
+      static void write( json_writer& w, const std::vector<T>& v ) { w.write_array( v.begin(), v.end() ); }
+   };
+
+   /** std::vector<char> is a hex encoded blob */
+   template<>
+   struct json_serializer< std::vector<char> >
+   {
+      static void write( json_writer& w, const std::vector<char>& v ) { w.write( variant( v, w.max_depth() ) ); }
+   };
+
+   template<typename T>
+   struct json_serializer< std::deque<T> >
+   {
+      static void write( json_writer& w, const std::deque<T>& v ) { w.write_array( v.begin(), v.end() ); }
+   };
+
+   template<typename T>
+   struct json_serializer< std::set<T> >
+   {
+      static void write( json_writer& w, const std::set<T>& v ) { w.write_array( v.begin(), v.end() ); }
+   };
+
+   template<typename T, typename... A>
+   struct json_serializer< flat_set<T,A...> >
+   {
+      static void write( json_writer& w, const flat_set<T,A...>& v ) { w.write_array( v.begin(), v.end() ); }
+   };
+
+   template<typename K, typename V>
+   struct json_serializer< std::map<K,V> >
+   {
+      static void write( json_writer& w, const std::map<K,V>& v ) { w.write_array( v.begin(), v.end() ); }
+   };
+
+   template<typename K, typename... V>
+   struct json_serializer< flat_map<K,V...> >
+   {
+      static void write( json_writer& w, const flat_map<K,V...>& v ) { w.write_array( v.begin(), v.end() ); }
+   };
+
+   template<typename A, typename B>
+   struct json_serializer< std::pair<A,B> >
+   {
+      static void write( json_writer& w, const std::pair<A,B>& v )
+      {
+         json_writer::scope nested( w );
+         w.write_raw( '[' );
+         w.write( v.first );
+         w.write_raw( ',' );
+         w.write( v.second );
+         w.write_raw( ']' );
+      }
+   };
+
+   template<typename T>
+   struct json_serializer< optional<T> >
+   {
+      static void write( json_writer& w, const optional<T>& v )
+      {
+         if( v.valid() )
+         {
+            json_writer::scope nested( w );
+            w.write( *v );
+         }
+         else
+            w.write_raw( "null", 4 );
+      }
+   };
+
+   template<typename T>
+   struct json_serializer< std::shared_ptr<T> >
+   {
+      static void write( json_writer& w, const std::shared_ptr<T>& v )
+      {
+         if( v )
+         {
+            json_writer::scope nested( w );
+            w.write( *v );
+         }
+         else
+            w.write_raw( "null", 4 );
+      }
+   };
+
+   template<typename T>
+   struct json_serializer< safe<T> >
+   {
+      static void write( json_writer& w, const safe<T>& v ) { w.write( v.value ); }
+   };
+
+   template<typename T>
+   struct json_serializer< smart_ref<T> >
+   {
+      static void write( json_writer& w, const smart_ref<T>& v ) { w.write( *v ); }
+   };
+
+   template<typename... T>
+   struct json_serializer< static_variant<T...> >
+   {
+      static void write( json_writer& w, const static_variant<T...>& v )
+      {
+         json_writer::scope nested( w );
+         w.write_raw( '[' );
+         w.write( int64_t( v.which() ) );
+         w.write_raw( ',' );
+         v.visit( detail::static_variant_json_writer( w ) );
+         w.write_raw( ']' );
+      }
+   };
+
+   template<>
+   struct json_serializer< mutable_variant_object >
+   {
+      static void write( json_writer& w, const mutable_variant_object& v ) { w.write( variant_object( v ) ); }
+   };
+
+} // namespace fc
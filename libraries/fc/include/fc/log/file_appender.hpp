@@ -19,6 +19,14 @@ class file_appender : public appender {
             microseconds                       rotation_interval;
             microseconds                       rotation_limit;
             uint32_t                           max_object_depth = FC_MAX_LOG_OBJECT_DEPTH;
+            /**
+             *  Hand messages to a writer thread through a queue of queue_size entries, which formats
+             *  and writes them.  With flush set the file is flushed whenever the queue runs
+             *  empty instead of after every line.  If the queue is full, messages below warn are dropped
+             *  and counted, the others wait for room.
+             */
+            bool                               async = false;
+            uint32_t                           queue_size = 16384;
          };
          file_appender( const variant& args );
          ~file_appender();
@@ -32,4 +40,5 @@ class file_appender : public appender {
 
 #include <fc/reflect/reflect.hpp>
 FC_REFLECT( fc::file_appender::config,
-            (format)(filename)(flush)(rotate)(rotation_interval)(rotation_limit)(max_object_depth) )
+            (format)(filename)(flush)(rotate)(rotation_interval)(rotation_limit)(max_object_depth)
+            (async)(queue_size) )
@@ -24,6 +24,12 @@ namespace fc
    {
       public:
          static logger get( const fc::string& name = "default");
+         /**
+          *  False if no logger created or configured since the last configure_logging() accepts messages
+          *  of level e.  Costs one atomic load, so the logging macros check it before get() takes the
+          *  lock of the logger map.
+          */
+         static bool may_log( log_level e );
 
          logger();
          logger( const string& name, const logger& parent = nullptr );
@@ -48,6 +54,7 @@ namespace fc
          std::vector<fc::shared_ptr<appender> > get_appenders()const;
          void remove_appender( const fc::shared_ptr<appender>& a );
 
+         /** true if messages of level e pass the level of this logger and reach at least one appender */
          bool is_enabled( log_level e )const;
          void log( log_message m );
 
@@ -99,40 +106,32 @@ namespace fc
       (LOGGER).log( FC_LOG_MESSAGE( error, FORMAT, __VA_ARGS__ ) ); \
   FC_MULTILINE_MACRO_END
 
-#define dlog( FORMAT, ... ) \
+/**
+ *  Logs to the named logger.  The arguments are only evaluated, and the message is only built, if
+ *  a logger may accept the level, and the logger is looked up only once.
+ */
+#define FC_NAMED_LOG( NAME, LOG_LEVEL, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::debug ) ) \
-      (fc::logger::get(DEFAULT_LOGGER)).log( FC_LOG_MESSAGE( debug, FORMAT, __VA_ARGS__ ) ); \
+   if( fc::logger::may_log( fc::log_level::LOG_LEVEL ) ) { \
+      fc::logger _fc_named_logger = fc::logger::get( NAME ); \
+      if( _fc_named_logger.is_enabled( fc::log_level::LOG_LEVEL ) ) \
+         _fc_named_logger.log( FC_LOG_MESSAGE( LOG_LEVEL, FORMAT, __VA_ARGS__ ) ); \
+   } \
   FC_MULTILINE_MACRO_END
 
+#define dlog( FORMAT, ... ) FC_NAMED_LOG( DEFAULT_LOGGER, debug, FORMAT, __VA_ARGS__ )
+
 /**
  * Sends the log message to a special 'user' log stream designed for messages that
  * the end user may like to see.
  */
-#define ulog( FORMAT, ... ) \
-  FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get("user")).is_enabled( fc::log_level::debug ) ) \
-      (fc::logger::get("user")).log( FC_LOG_MESSAGE( debug, FORMAT, __VA_ARGS__ ) ); \
-  FC_MULTILINE_MACRO_END
+#define ulog( FORMAT, ... ) FC_NAMED_LOG( "user", debug, FORMAT, __VA_ARGS__ )
 
+#define ilog( FORMAT, ... ) FC_NAMED_LOG( DEFAULT_LOGGER, info, FORMAT, __VA_ARGS__ )
 
-#define ilog( FORMAT, ... ) \
-  FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::info ) ) \
-      (fc::logger::get(DEFAULT_LOGGER)).log( FC_LOG_MESSAGE( info, FORMAT, __VA_ARGS__ ) ); \
-  FC_MULTILINE_MACRO_END
+#define wlog( FORMAT, ... ) FC_NAMED_LOG( DEFAULT_LOGGER, warn, FORMAT, __VA_ARGS__ )
 
-#define wlog( FORMAT, ... ) \
-  FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::warn ) ) \
-      (fc::logger::get(DEFAULT_LOGGER)).log( FC_LOG_MESSAGE( warn, FORMAT, __VA_ARGS__ ) ); \
-  FC_MULTILINE_MACRO_END
-
-#define elog( FORMAT, ... ) \
-  FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::error ) ) \
-      (fc::logger::get(DEFAULT_LOGGER)).log( FC_LOG_MESSAGE( error, FORMAT, __VA_ARGS__ ) ); \
-  FC_MULTILINE_MACRO_END
+#define elog( FORMAT, ... ) FC_NAMED_LOG( DEFAULT_LOGGER, error, FORMAT, __VA_ARGS__ )
 
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/preprocessor/seq/enum.hpp>
@@ -162,6 +161,15 @@ namespace fc
 #define FC_DUMP_FORMAT_ARG_NAMES( SEQ )\
    BOOST_PP_SEQ_FOR_EACH( FC_DUMP_FORMAT_ARG_NAME, v, SEQ )
 
+#define ddump( SEQ ) \
+{ \
+   try { \
+      dlog( FC_FORMAT(SEQ), FC_FORMAT_ARG_PARAMS(SEQ) ); \
+   } catch( ... ) { \
+      dlog ( "[ERROR: Got exception while trying to dump ( ${args} )]",("args",FC_DUMP_FORMAT_ARG_NAMES(SEQ)) ); \
+   } \
+}
+
 // TODO FC_FORMAT_ARG_PARAMS(...) may throw exceptions when calling fc::variant(...) inside,
 //      as a quick-fix / workaround, we catch all exceptions here.
 //      However, to log as much info as possible, it's better to catch exceptions when processing each argument
@@ -19,6 +19,8 @@ namespace fc { namespace http {
       public:
          virtual ~websocket_connection(){}
          virtual void send_message( const std::string& message ) = 0;
+         /** sends message in a binary frame, for transports that do not speak JSON */
+         virtual void send_binary_message( const std::string& message ) = 0;
          virtual void close( int64_t code, const std::string& reason  ){};
          void on_message( const std::string& message ) { _on_message(message); }
          string on_http( const std::string& message ) { return _on_http(message); }
@@ -30,6 +32,10 @@ namespace fc { namespace http {
          fc::any& get_session_data() { return _session_data; }
 
          virtual std::string get_request_header(const std::string& key) = 0;
+         /** the address and port of the other end */
+         virtual std::string get_remote_endpoint_string() = 0;
+         /** whether the opening handshake negotiated permessage-deflate */
+         virtual bool is_compressed() { return false; }
 
          fc::signal<void()> closed;
       private:
@@ -41,6 +47,24 @@ namespace fc { namespace http {
 
    typedef std::function<void(const websocket_connection_ptr&)> on_connection_handler;
 
+   /**
+    *  permessage-deflate (RFC 7692) settings.  The server settings apply to every websocket_server and
+    *  websocket_tls_server of the process, the client settings to every client, in both cases to the
+    *  connections opened after they were set.
+    */
+   struct websocket_compression
+   {
+      /** servers accept the extension when a client offers it, clients offer it */
+      bool      enabled = false;
+      /** from 0 (store only) to 9 (smallest), -1 is the zlib default of 6 */
+      int       level = -1;
+      /** messages shorter than this many bytes are sent uncompressed */
+      uint32_t  min_size = 256;
+   };
+
+   void set_server_compression( const websocket_compression& compression );
+   void set_client_compression( const websocket_compression& compression );
+
    class websocket_server
    {
       public:
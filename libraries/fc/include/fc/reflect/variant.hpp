@@ -4,8 +4,11 @@
 
 namespace fc
 {
+   /** returned by the reflection based to_variant below, which lets json_writer tell it apart from hand written ones */
+   struct reflected_variant_conversion {};
+
    template<typename T>
-   void to_variant( const T& o, variant& v, uint32_t max_depth );
+   reflected_variant_conversion to_variant( const T& o, variant& v, uint32_t max_depth );
    template<typename T>
    void from_variant( const variant& v, T& o, uint32_t max_depth );
 
@@ -101,9 +104,10 @@ namespace fc
 
 
    template<typename T>
-   void to_variant( const T& o, variant& v, uint32_t max_depth )
+   reflected_variant_conversion to_variant( const T& o, variant& v, uint32_t max_depth )
    {
       if_enum<typename fc::reflector<T>::is_enum>::to_variant( o, v, max_depth );
+      return reflected_variant_conversion();
    }
 
    template<typename T>
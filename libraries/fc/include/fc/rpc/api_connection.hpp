@@ -1,5 +1,6 @@
 #pragma once
 #include <fc/variant.hpp>
+#include <fc/io/json_writer.hpp>
 #include <fc/optional.hpp>
 #include <fc/api.hpp>
 #include <fc/any.hpp>
@@ -118,6 +119,14 @@ namespace fc {
             return _methods[method_id](args);
          }
 
+         /** like call(), but writes the result as JSON without converting it to a variant first */
+         void call( const string& name, const variants& args, json_writer& out )
+         {
+            auto itr = _by_name.find(name);
+            FC_ASSERT( itr != _by_name.end(), "no method with name '${name}'", ("name",name)("api",_by_name) );
+            _json_methods[itr->second]( args, out );
+         }
+
          std::weak_ptr< fc::api_connection > get_connection()
          {
             return _api_connection;
@@ -131,6 +140,8 @@ namespace fc {
             return result;
          }
 
+         bool has_method( const string& name )const { return _by_name.find( name ) != _by_name.end(); }
+
       private:
          friend struct api_visitor;
 
@@ -190,9 +201,37 @@ namespace fc {
             template<typename ... Args>
             std::function<variant(const fc::variants&)> to_generic( const std::function<void(Args...)>& f )const;
 
+            typedef std::function<void(const fc::variants&, json_writer&)> json_method;
+
+            /** methods returning apis or nothing write the variant their generic method returns */
+            static json_method to_json_generic( const std::function<variant(const fc::variants&)>& m )
+            {
+               return [m]( const variants& args, json_writer& out ) { out.write( m( args ) ); };
+            }
+
+            template<typename Interface, typename Adaptor, typename ... Args>
+            json_method to_json_generic( const std::function<api<Interface,Adaptor>(Args...)>&, const std::function<variant(const fc::variants&)>& m )const
+            {  return to_json_generic( m ); }
+
+            template<typename Interface, typename Adaptor, typename ... Args>
+            json_method to_json_generic( const std::function<fc::optional<api<Interface,Adaptor>>(Args...)>&, const std::function<variant(const fc::variants&)>& m )const
+            {  return to_json_generic( m ); }
+
+            template<typename ... Args>
+            json_method to_json_generic( const std::function<fc::api_ptr(Args...)>&, const std::function<variant(const fc::variants&)>& m )const
+            {  return to_json_generic( m ); }
+
+            template<typename ... Args>
+            json_method to_json_generic( const std::function<void(Args...)>&, const std::function<variant(const fc::variants&)>& m )const
+            {  return to_json_generic( m ); }
+
+            template<typename R, typename ... Args>
+            json_method to_json_generic( const std::function<R(Args...)>& f, const std::function<variant(const fc::variants&)>& m )const;
+
             template<typename Result, typename... Args>
             void operator()( const char* name, std::function<Result(Args...)>& memb )const {
                _api._methods.emplace_back( to_generic( memb ) );
+               _api._json_methods.emplace_back( to_json_generic( memb, _api._methods.back() ) );
                _api._by_name[name] = _api._methods.size() - 1;
             }
 
@@ -205,6 +244,7 @@ namespace fc {
          fc::any                                                 _api;
          std::map< std::string, uint32_t >                       _by_name;
          std::vector< std::function<variant(const variants&)> >  _methods;
+         std::vector< api_visitor::json_method >                 _json_methods;
    }; // class generic_api
 
 
@@ -234,6 +274,11 @@ namespace fc {
             FC_ASSERT( _local_apis.size() > api_id );
             return _local_apis[api_id]->call( method_name, args );
          }
+         void receive_call( api_id_type api_id, const string& method_name, const variants& args, json_writer& out )const
+         {
+            FC_ASSERT( _local_apis.size() > api_id );
+            _local_apis[api_id]->call( method_name, args, out );
+         }
          variant receive_callback( uint64_t callback_id,  const variants& args = variants() )const
          {
             FC_ASSERT( _local_callbacks.size() > callback_id );
@@ -265,6 +310,14 @@ namespace fc {
          }
 
          std::vector<std::string> get_method_names( api_id_type local_api_id = 0 )const { return _local_apis[local_api_id]->get_method_names(); }
+         /** whether any API registered on this connection has a method called @p name */
+         bool has_method( const string& name )const
+         {
+            for( const auto& a : _local_apis )
+               if( a->has_method( name ) )
+                  return true;
+            return false;
+         }
 
          fc::signal<void()> closed;
          const uint32_t     _max_conversion_depth; // for nested structures, json, variant etc.
@@ -450,6 +503,19 @@ namespace fc {
       };
    }
 
+   template<typename R, typename ... Args>
+   generic_api::api_visitor::json_method generic_api::api_visitor::to_json_generic( const std::function<R(Args...)>& f,
+                                                                                  const std::function<variant(const fc::variants&)>& )const
+   {
+      auto con = _api_con.lock();
+      FC_ASSERT( con, "not connected" );
+      uint32_t max_depth = con->_max_conversion_depth;
+      generic_api* gapi = &_api;
+      return [f,gapi,max_depth]( const variants& args, json_writer& out ) {
+         out.write( gapi->call_generic( f, args.begin(), args.end(), max_depth ) );
+      };
+   }
+
    template<typename ... Args>
    std::function<variant(const fc::variants&)> generic_api::api_visitor::to_generic( const std::function<void(Args...)>& f )const
    {
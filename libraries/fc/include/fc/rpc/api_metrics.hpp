@@ -0,0 +1,114 @@
+#pragma once
+#include <fc/rpc/state.hpp>
+#include <fc/time.hpp>
+#include <fc/variant.hpp>
+#include <fc/reflect/variant.hpp>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fc { namespace rpc {
+
+   /** call statistics of one API method, or of one client, since the last reset */
+   struct api_call_metrics
+   {
+      std::string  name;
+      uint64_t     calls = 0;
+      uint64_t     errors = 0;
+      uint64_t     total_us = 0;
+      uint64_t     max_us = 0;
+      /** percentiles are estimated from power of two buckets, so they are accurate to a factor of two */
+      uint64_t     p50_us = 0;
+      uint64_t     p90_us = 0;
+      uint64_t     p99_us = 0;
+      uint64_t     response_bytes = 0;
+   };
+
+   /**
+    *  Process wide call counts, errors, latencies and response sizes of the RPC servers, by method
+    *  and by client.  Recording a call costs one short lock and a few additions, so it is always on.
+    *  Calls slower than the warn or max threshold are also logged individually, together with their
+    *  parameters.
+    */
+   class api_metrics
+   {
+      public:
+         /** calls from clients beyond this many are counted under one "other" entry */
+         static const size_t max_clients = 1000;
+
+         static api_metrics& instance();
+
+         /** the name calls to methods that no registered API provides are counted under */
+         static constexpr const char* unknown_method = "unknown";
+
+         /** the name a call is requesting: the API method for "call" requests, else the request method */
+         static std::string method_name( const request& call );
+         /**
+          *  The name a call is counted under: its method_name() if @p apis has a method of that name, else
+          *  unknown_method.  Method names come from the client, so only registered ones get their own entry.
+          */
+         template<typename Connection>
+         static std::string method_name( const request& call, const Connection& apis )
+         {
+            std::string name = method_name( call );
+            return apis.has_method( name ) ? name : std::string( unknown_method );
+         }
+         /**
+          *  The name a client is counted and rate limited under: its address without the port.  When the
+          *  address is one of the trusted proxies, the last address in the proxy's X-Forwarded-For header
+          *  is used instead.  Anyone can send that header, so it is ignored from everyone else.
+          */
+         static std::string client_name( const std::string& forwarded_for, const std::string& remote_endpoint );
+
+         /** sets the addresses, without port, of the reverse proxies whose X-Forwarded-For header is trusted */
+         void set_trusted_proxies( std::set<std::string> proxies );
+
+         void record( const std::string& client, const std::string& method, const variants& params,
+                      const microseconds& elapsed, size_t response_bytes, bool failed );
+
+         /** per method metrics, the methods with the highest total time first */
+         std::vector<api_call_metrics> get_method_metrics()const;
+         /** per client metrics, the clients with the highest total time first */
+         std::vector<api_call_metrics> get_client_metrics()const;
+         void reset();
+
+         void         set_thresholds( const microseconds& warn, const microseconds& max );
+         microseconds warn_threshold()const { return microseconds( _warn_us.load() ); }
+         microseconds max_threshold()const  { return microseconds( _max_us.load() ); }
+
+         /** logs one line with the calls since the previous summary and the busiest methods */
+         void log_summary( size_t top = 5 );
+
+      private:
+         struct entry
+         {
+            void add( uint64_t us, size_t response_bytes, bool failed );
+            api_call_metrics get( const std::string& name )const;
+
+            uint64_t                  calls = 0;
+            uint64_t                  errors = 0;
+            uint64_t                  total_us = 0;
+            uint64_t                  max_us = 0;
+            uint64_t                  response_bytes = 0;
+            std::array<uint64_t,40>   buckets{};
+         };
+
+         static std::vector<api_call_metrics> sorted( const std::unordered_map<std::string,entry>& entries );
+
+         mutable std::mutex                        _lock;
+         std::set<std::string>                     _trusted_proxies;
+         std::unordered_map<std::string,entry>     _methods;
+         std::unordered_map<std::string,entry>     _clients;
+         uint64_t                                  _calls_at_last_summary = 0;
+         uint64_t                                  _calls = 0;
+         std::atomic<int64_t>                      _warn_us{ 750000 };
+         std::atomic<int64_t>                      _max_us{ 1000000 };
+   };
+
+} } // namespace fc::rpc
+
+FC_REFLECT( fc::rpc::api_call_metrics, (name)(calls)(errors)(total_us)(max_us)(p50_us)(p90_us)(p99_us)(response_bytes) )
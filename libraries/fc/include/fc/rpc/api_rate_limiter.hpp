@@ -0,0 +1,86 @@
+#pragma once
+#include <fc/time.hpp>
+#include <fc/reflect/variant.hpp>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace fc { namespace rpc {
+
+   /**
+    *  Budgets of the API servers.  Every call costs the cost of its method, or default_cost, when it
+    *  starts and cost_per_ms for every millisecond it ran when it ends.  Each connection and each
+    *  client address has its own budget of up to the given number of units, refilled continuously
+    *  at the given rate; a budget of 0 is unlimited.
+    */
+   struct api_rate_limits
+   {
+      double                        connection_budget = 0;
+      double                        connection_refill_per_second = 0;
+      double                        client_budget = 0;
+      double                        client_refill_per_second = 0;
+      double                        default_cost = 1;
+      double                        cost_per_ms = 0;
+      std::map<std::string,double>  method_costs;
+
+      double cost_of( const std::string& method )const;
+   };
+
+   /** the state of one budget */
+   struct api_budget
+   {
+      double      units = 0;
+      time_point  updated;
+      bool        initialized = false;
+
+      /** adds what was refilled since the last update, up to capacity */
+      void refill( double capacity, double per_second, const time_point& now );
+   };
+
+   /**
+    *  Enforces api_rate_limits for the RPC servers.  Connections own their api_budget, the budgets of
+    *  client addresses are kept here and shared by all connections from the same address.
+    */
+   class api_rate_limiter
+   {
+      public:
+         /** the most client budgets kept, the least recently used one is dropped to make room for a new client */
+         static const size_t max_clients = 10000;
+
+         static api_rate_limiter& instance();
+
+         void            set_limits( const api_rate_limits& limits );
+         api_rate_limits get_limits()const;
+
+         /** charges the cost of method, throws if the connection or the client cannot afford it */
+         void start_call( const std::string& client, api_budget& connection, const std::string& method );
+         /** charges the execution time of a call that start_call() admitted */
+         void finish_call( const std::string& client, api_budget& connection, const microseconds& elapsed );
+
+         /** the number of client budgets kept */
+         size_t client_count()const;
+
+      private:
+         /** the budget of client, created if needed, and marked as the most recently used */
+         api_budget& client_budget( const std::string& client );
+
+         typedef std::list<std::string> client_list;
+         struct client_entry
+         {
+            api_budget              budget;
+            client_list::iterator   position;
+         };
+
+         mutable std::mutex                              _lock;
+         api_rate_limits                                 _limits;
+         std::unordered_map<std::string,client_entry>    _clients;
+         /** the clients, the most recently used first */
+         client_list                                     _client_order;
+   };
+
+} } // namespace fc::rpc
+
+FC_REFLECT( fc::rpc::api_rate_limits, (connection_budget)(connection_refill_per_second)(client_budget)
+                                      (client_refill_per_second)(default_cost)(cost_per_ms)(method_costs) )
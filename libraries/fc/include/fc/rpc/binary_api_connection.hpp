@@ -1,127 +1,123 @@
 #pragma once
-#include <fc/variant.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
 #include <fc/optional.hpp>
 #include <fc/api.hpp>
 #include <fc/any.hpp>
 #include <memory>
 #include <vector>
+#include <map>
+#include <tuple>
 #include <functional>
 #include <utility>
 #include <fc/signals.hpp>
-//#include <fc/rpc/json_connection.hpp>
 
+/**
+ *  The binary api connection is the fc::raw counterpart of api_connection.  Arguments of a call are
+ *  packed back to back in declaration order and the result is packed as a single value.  Returned
+ *  api<T> objects are sent as the api id they were registered under, and callbacks as the id of the
+ *  local callback, exactly as the JSON transport does.
+ */
 namespace fc {
    class binary_api_connection;
 
    namespace detail {
       template<typename Signature>
-      class callback_functor
-      {
-         public:
-            typedef typename std::function<Signature>::result_type result_type;
+      class binary_callback_functor;
 
-            callback_functor( std::weak_ptr< fc::binary_api_connection > con, uint64_t id )
-            :_callback_id(id),_binary_api_connection(con){}
-
-            template<typename... Args> 
-            result_type operator()( Args... args )const;
+      /** packs and unpacks a single argument, registering or binding callbacks on the way */
+      template<typename T>
+      struct binary_arg
+      {
+         static void pack( std::vector<char>& out, const T& v, binary_api_connection& )
+         {
+            auto packed = fc::raw::pack( v );
+            out.insert( out.end(), packed.begin(), packed.end() );
+         }
+         static T unpack( fc::datastream<const char*>& ds, const std::weak_ptr<binary_api_connection>& )
+         {
+            T v;
+            fc::raw::unpack( ds, v );
+            return v;
+         }
+      };
 
-         private:
-            uint64_t _callback_id;
-            std::weak_ptr< fc::binary_api_connection > _binary_api_connection;
+      template<typename Signature>
+      struct binary_arg< std::function<Signature> >
+      {
+         static void pack( std::vector<char>& out, const std::function<Signature>& v, binary_api_connection& con );
+         static std::function<Signature> unpack( fc::datastream<const char*>& ds, const std::weak_ptr<binary_api_connection>& con )
+         {
+            uint64_t callback_id;
+            fc::raw::unpack( ds, callback_id );
+            return binary_callback_functor<Signature>( con, callback_id );
+         }
       };
 
-      template<typename R, typename Arg0, typename ... Args>
-      std::function<R(Args...)> bind_first_arg( const std::function<R(Arg0,Args...)>& f, Arg0 a0 )
+      template<typename... Args>
+      std::vector<char> pack_binary_args( binary_api_connection& con, const Args&... args )
       {
-         return [=]( Args... args ) { return f( a0, args... ); };
+         std::vector<char> result;
+         int expand[] = { 0, ( binary_arg< typename std::decay<Args>::type >::pack( result, args, con ), 0 )... };
+         (void)expand;
+         return result;
       }
-      template<typename R>
-      R call_generic( const std::function<R()>& f, variants::const_iterator a0, variants::const_iterator e )
+
+      template<typename R, typename... Args, std::size_t... I>
+      R call_binary( const std::function<R(Args...)>& f, std::tuple<typename std::decay<Args>::type...>& args, std::index_sequence<I...> )
       {
-         return f();
+         return f( std::get<I>( args )... );
       }
 
-      template<typename R, typename Arg0, typename ... Args>
-      R call_generic( const std::function<R(Arg0,Args...)>& f, variants::const_iterator a0, variants::const_iterator e )
+      /** unpacks the arguments of f from params and invokes it */
+      template<typename R, typename... Args>
+      R call_binary( const std::function<R(Args...)>& f, const std::vector<char>& params, const std::weak_ptr<binary_api_connection>& con )
       {
-         FC_ASSERT( a0 != e );
-         return  call_generic<R,Args...>( bind_first_arg<R,Arg0,Args...>( f, a0->as< typename std::decay<Arg0>::type >() ), a0+1, e );
+         fc::datastream<const char*> ds( params.data(), params.size() );
+         // braced initialization guarantees the arguments are unpacked left to right
+         std::tuple<typename std::decay<Args>::type...> args{ binary_arg< typename std::decay<Args>::type >::unpack( ds, con )... };
+         return call_binary( f, args, std::index_sequence_for<Args...>() );
       }
 
-      template<typename R, typename ... Args>
-      std::function<variant(const fc::variants&)> to_generic( const std::function<R(Args...)>& f )
+      template<typename R, typename... Args>
+      std::function<std::vector<char>(const std::vector<char>&)> to_binary_generic( const std::function<R(Args...)>& f, const std::weak_ptr<binary_api_connection>& con )
       {
-         return [=]( const variants& args ) { 
-            return variant( call_generic( f, args.begin(), args.end() ) ); 
+         return [=]( const std::vector<char>& params ) {
+            return fc::raw::pack( call_binary( f, params, con ) );
          };
       }
 
-      template<typename ... Args>
-      std::function<variant(const fc::variants&)> to_generic( const std::function<void(Args...)>& f )
+      template<typename... Args>
+      std::function<std::vector<char>(const std::vector<char>&)> to_binary_generic( const std::function<void(Args...)>& f, const std::weak_ptr<binary_api_connection>& con )
       {
-         return [=]( const variants& args ) { 
-            call_generic( f, args.begin(), args.end() ); 
-            return variant();
+         return [=]( const std::vector<char>& params ) {
+            call_binary( f, params, con );
+            return std::vector<char>();
          };
       }
-
-      /**
-       * If api<T> is returned from a remote method, the API is eagerly bound to api<T> of
-       * the correct type in api_visitor::from_variant().  This binding [1] needs a reference
-       * to the binary_api_connection, which is made available to from_variant() as a parameter.
-       *
-       * However, in the case of a remote method which returns api_base which can subsequently
-       * be cast by the caller with as<T>, we need to keep track of the connection because
-       * the binding is done later (when the client code actually calls as<T>).
-       *
-       * [1] The binding actually happens in get_remote_api().
-       */
-      class any_api : public api_base
-      {
-         public:
-            any_api( api_id_type api_id, const std::shared_ptr<fc::binary_api_connection>& con )
-               : _api_id(api_id), _binary_api_connection(con) {}
-
-            virtual uint64_t get_handle()const override
-            {  return _api_id;    }
-
-            virtual api_id_type register_api( binary_api_connection& conn )const override
-            {  FC_ASSERT( false ); return api_id_type(); }
-
-            api_id_type                         _api_id;
-            std::weak_ptr<fc::binary_api_connection>   _binary_api_connection;
-      };
-
    } // namespace detail
 
-   class generic_api
+   class binary_generic_api
    {
       public:
          template<typename Api>
-         generic_api( const Api& a, const std::shared_ptr<fc::binary_api_connection>& c );
+         binary_generic_api( const Api& a, const std::shared_ptr<fc::binary_api_connection>& c );
 
-         generic_api( const generic_api& cpy ) = delete;
+         binary_generic_api( const binary_generic_api& cpy ) = delete;
 
-         vector<char> call( const string& name, const vector<char>& args )
+         std::vector<char> call( const string& name, const std::vector<char>& args )
          {
             auto itr = _by_name.find(name);
-            FC_ASSERT( itr != _by_name.end(), "no method with name '${name}'", ("name",name)("api",_by_name) );
+            FC_ASSERT( itr != _by_name.end(), "no method with name '${name}'", ("name",name) );
             return call( itr->second, args );
          }
 
-         vector<char> call( uint32_t method_id, const vector<char>& args )
+         std::vector<char> call( uint32_t method_id, const std::vector<char>& args )
          {
             FC_ASSERT( method_id < _methods.size() );
             return _methods[method_id](args);
          }
 
-         std::weak_ptr< fc::binary_api_connection > get_connection()
-         {
-            return _binary_api_connection;
-         }
-
          std::vector<std::string> get_method_names()const
          {
             std::vector<std::string> result;
@@ -130,81 +126,40 @@ namespace fc {
             return result;
          }
 
-      private:
-         friend struct api_visitor;
-
-         template<typename R, typename Arg0, typename ... Args>
-         std::function<R(Args...)> bind_first_arg( const std::function<R(Arg0,Args...)>& f, Arg0 a0 )const
-         {
-            return [=]( Args... args ) { return f( a0, args... ); };
-         }
-
-         template<typename R>
-         R call_generic( const std::function<R()>& f, datastream<const char*>& ds )const
-         {
-            return f();
-         }
-
-         template<typename R, typename Signature, typename ... Args>
-         R call_generic( const std::function<R(std::function<Signature>,Args...)>& f, datastream<const char*>& ds )
-         {
-            uint64_t callback_id = 0;
-            fc::raw::unpack( ds, callback_id );
-            detail::callback_functor<Signature> arg0( get_connection(), callback_id );
-            return  call_generic<R,Args...>( this->bind_first_arg<R,std::function<Signature>,Args...>( f, std::function<Signature>(arg0) ), ds );
-         }
-         template<typename R, typename Signature, typename ... Args>
-         R call_generic( const std::function<R(const std::function<Signature>&,Args...)>& f, fc::datastream<const char*>& ds )
-         {
-            uint64_t callback_id = 0;
-            fc::raw::unpack( ds, callback_id );
-            detail::callback_functor<Signature> arg0( get_connection(), callback_id );
-            return  call_generic<R,Args...>( this->bind_first_arg<R,const std::function<Signature>&,Args...>( f, arg0 ), ds );
-         }
-
-         template<typename R, typename Arg0, typename ... Args>
-         R call_generic( const std::function<R(Arg0,Args...)>& f, fc::datastream<const char*>& ds )
-         {
-            std::decay<Arg0>::type a0;
-            fc::raw::unpack( ds, a0 );
-            return  call_generic<R,Args...>( this->bind_first_arg<R,Arg0,Args...>( f, a0 ), ds );
-         }
+         bool has_method( const string& name )const { return _by_name.find( name ) != _by_name.end(); }
 
+      private:
          struct api_visitor
          {
-            api_visitor( generic_api& a, const std::weak_ptr<fc::binary_api_connection>& s ):api(a),_api_con(s){ }
+            api_visitor( binary_generic_api& a, const std::weak_ptr<fc::binary_api_connection>& s ):_api(a),_api_con(s){ }
 
             template<typename Interface, typename Adaptor, typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<api<Interface,Adaptor>(Args...)>& f )const;
+            std::function<std::vector<char>(const std::vector<char>&)> to_generic( const std::function<api<Interface,Adaptor>(Args...)>& f )const;
 
             template<typename Interface, typename Adaptor, typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<fc::optional<api<Interface,Adaptor>>(Args...)>& f )const;
-
-            template<typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<fc::api_ptr(Args...)>& f )const;
+            std::function<std::vector<char>(const std::vector<char>&)> to_generic( const std::function<fc::optional<api<Interface,Adaptor>>(Args...)>& f )const;
 
             template<typename R, typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<R(Args...)>& f )const;
-
-            template<typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<void(Args...)>& f )const;
+            std::function<std::vector<char>(const std::vector<char>&)> to_generic( const std::function<R(Args...)>& f )const
+            {
+               return detail::to_binary_generic( f, _api_con );
+            }
 
             template<typename Result, typename... Args>
             void operator()( const char* name, std::function<Result(Args...)>& memb )const {
-               api._methods.emplace_back( to_generic( memb ) ); 
-               api._by_name[name] = api._methods.size() - 1;
+               _api._methods.emplace_back( to_generic( memb ) );
+               _api._by_name[name] = _api._methods.size() - 1;
             }
 
-            generic_api&  api;
-            const std::weak_ptr<fc::binary_api_connection>& _api_con;
+            binary_generic_api& _api;
+            std::weak_ptr<fc::binary_api_connection> _api_con;
          };
 
-
-         std::weak_ptr<fc::binary_api_connection>                         _binary_api_connection;
-         fc::any                                                          _api;
-         std::map< std::string, uint32_t >                                _by_name;
-         std::vector< std::function<vector<char>(const vector<char>&)> >  _methods;
-   }; // class generic_api
+         std::weak_ptr<fc::binary_api_connection>                                   _api_connection;
+         fc::any                                                                    _api;
+         std::map< std::string, uint32_t >                                          _by_name;
+         std::vector< std::function<std::vector<char>(const std::vector<char>&)> >  _methods;
+   }; // class binary_generic_api
 
 
 
@@ -222,26 +177,26 @@ namespace fc {
          api<T> get_remote_api( api_id_type api_id = 0 )
          {
             api<T> result;
-            result->visit( api_visitor(  api_id, this->shared_from_this() ) );
+            result->visit( api_visitor( api_id, this->shared_from_this() ) );
             return result;
          }
-  
+
          /** makes calls to the remote server */
          virtual result_type send_call( api_id_type api_id, string method_name, params_type args = params_type() ) = 0;
          virtual result_type send_callback( uint64_t callback_id, params_type args = params_type() ) = 0;
-         virtual void    send_notice( uint64_t callback_id, params_type args = params_type() ) = 0;
+         virtual void        send_notice( uint64_t callback_id, params_type args = params_type() ) = 0;
 
          result_type receive_call( api_id_type api_id, const string& method_name, const params_type& args = params_type() )const
          {
             FC_ASSERT( _local_apis.size() > api_id );
             return _local_apis[api_id]->call( method_name, args );
          }
-         result_type receive_callback( uint64_t callback_id,  const params_type& args = params_type() )const
+         result_type receive_callback( uint64_t callback_id, const params_type& args = params_type() )const
          {
             FC_ASSERT( _local_callbacks.size() > callback_id );
             return _local_callbacks[callback_id]( args );
          }
-         void receive_notice( uint64_t callback_id,  const params_type& args = params_type() )const
+         void receive_notice( uint64_t callback_id, const params_type& args = params_type() )const
          {
             FC_ASSERT( _local_callbacks.size() > callback_id );
             _local_callbacks[callback_id]( args );
@@ -254,7 +209,7 @@ namespace fc {
             auto itr = _handle_to_id.find(handle);
             if( itr != _handle_to_id.end() ) return itr->second;
 
-            _local_apis.push_back( std::unique_ptr<generic_api>( new generic_api(a, shared_from_this() ) ) );
+            _local_apis.push_back( std::unique_ptr<binary_generic_api>( new binary_generic_api(a, shared_from_this() ) ) );
             _handle_to_id[handle] = _local_apis.size() - 1;
             return _local_apis.size() - 1;
          }
@@ -262,22 +217,30 @@ namespace fc {
          template<typename Signature>
          uint64_t register_callback( const std::function<Signature>& cb )
          {
-            _local_callbacks.push_back( detail::to_generic( cb ) );
+            _local_callbacks.push_back( detail::to_binary_generic( cb, this->shared_from_this() ) );
             return _local_callbacks.size() - 1;
          }
 
          std::vector<std::string> get_method_names( api_id_type local_api_id = 0 )const { return _local_apis[local_api_id]->get_method_names(); }
+         /** whether any API registered on this connection has a method called @p name */
+         bool has_method( const string& name )const
+         {
+            for( const auto& a : _local_apis )
+               if( a->has_method( name ) )
+                  return true;
+            return false;
+         }
 
          fc::signal<void()> closed;
       private:
-         std::vector< std::unique_ptr<generic_api> >             _local_apis;
-         std::map< uint64_t, api_id_type >                       _handle_to_id;
-         std::vector< std::function<variant(const variants&)>  > _local_callbacks;
+         std::vector< std::unique_ptr<binary_generic_api> >                         _local_apis;
+         std::map< uint64_t, api_id_type >                                          _handle_to_id;
+         std::vector< std::function<result_type(const params_type&)> >              _local_callbacks;
 
 
          struct api_visitor
          {
-            uint32_t                            _api_id;
+            uint32_t                                   _api_id;
             std::shared_ptr<fc::binary_api_connection> _connection;
 
             api_visitor( uint32_t api_id, std::shared_ptr<fc::binary_api_connection> con )
@@ -288,58 +251,47 @@ namespace fc {
             api_visitor() = delete;
 
             template<typename Result>
-            static Result from_vector( const vector<char>& v, Result*, const std::shared_ptr<fc::binary_api_connection>&  )
+            static Result from_binary( const result_type& r, Result*, const std::shared_ptr<fc::binary_api_connection>& )
             {
-               return fc::raw::unpack<Result>( v ); 
+               return fc::raw::unpack<Result>( r );
             }
 
             template<typename ResultInterface>
-            static fc::api<ResultInterface> from_vector( const vector<char>& v, 
-                                                          fc::api<ResultInterface>* /*used for template deduction*/,
-                                                          const std::shared_ptr<fc::binary_api_connection>&  con 
-                                                        )
+            static fc::api<ResultInterface> from_binary( const result_type& r,
+                                                         fc::api<ResultInterface>* /*used for template deduction*/,
+                                                         const std::shared_ptr<fc::binary_api_connection>& con )
             {
-               return con->get_remote_api<ResultInterface>( fc::raw::unpack<uint64_t>( v ) );
+               return con->get_remote_api<ResultInterface>( fc::raw::unpack<uint64_t>( r ) );
             }
 
-            static fc::api_ptr from_vector(
-               const vector<char>& v,
-               fc::api_ptr* /* used for template deduction */,
-               const std::shared_ptr<fc::binary_api_connection>&  con
-            )
+            template<typename ResultInterface>
+            static fc::optional<fc::api<ResultInterface>> from_binary( const result_type& r,
+                                                                       fc::optional<fc::api<ResultInterface>>* /*used for template deduction*/,
+                                                                       const std::shared_ptr<fc::binary_api_connection>& con )
             {
-               return fc::api_ptr( new detail::any_api( fc::raw::unpack<uint64_t>(v), con ) );
-            }
-
-            template<typename T>
-            static result_type convert_callbacks( const std::shared_ptr<fc::binary_api_connection>&, const T& v ) 
-            { 
-               return fc::raw::pack(v); 
-            }
-
-            template<typename Signature>
-            static result_type convert_callbacks( const std::shared_ptr<fc::binary_api_connection>& con, const std::function<Signature>& v ) 
-            { 
-               return con->register_callback( v ); 
+               auto api_id = fc::raw::unpack<fc::optional<uint64_t>>( r );
+               if( !api_id )
+                  return fc::optional<fc::api<ResultInterface>>();
+               return con->get_remote_api<ResultInterface>( *api_id );
             }
 
             template<typename Result, typename... Args>
-            void operator()( const char* name, std::function<Result(Args...)>& memb )const 
+            void operator()( const char* name, std::function<Result(Args...)>& memb )const
             {
                 auto con   = _connection;
                 auto api_id = _api_id;
                 memb = [con,api_id,name]( Args... args ) {
-                    auto var_result = con->send_call( api_id, name, { convert_callbacks(con,args)...} );
-                    return from_vector( var_result, (Result*)nullptr, con );
+                    auto result = con->send_call( api_id, name, detail::pack_binary_args( *con, args... ) );
+                    return from_binary( result, (Result*)nullptr, con );
                 };
             }
             template<typename... Args>
-            void operator()( const char* name, std::function<void(Args...)>& memb )const 
+            void operator()( const char* name, std::function<void(Args...)>& memb )const
             {
                 auto con   = _connection;
                 auto api_id = _api_id;
                 memb = [con,api_id,name]( Args... args ) {
-                   con->send_call( api_id, name, { convert_callbacks(con,args)...} );
+                   con->send_call( api_id, name, detail::pack_binary_args( *con, args... ) );
                 };
             }
          };
@@ -348,6 +300,9 @@ namespace fc {
    class local_binary_api_connection : public binary_api_connection
    {
       public:
+         local_binary_api_connection(){}
+         ~local_binary_api_connection(){}
+
          /** makes calls to the remote server */
          virtual result_type send_call( api_id_type api_id, string method_name, params_type args = params_type() ) override
          {
@@ -378,155 +333,94 @@ namespace fc {
    };
 
    template<typename Api>
-   generic_api::generic_api( const Api& a, const std::shared_ptr<fc::binary_api_connection>& c )
-   :_binary_api_connection(c),_api(a)
+   binary_generic_api::binary_generic_api( const Api& a, const std::shared_ptr<fc::binary_api_connection>& c )
+   :_api_connection(c),_api(a)
    {
-      boost::any_cast<const Api&>(a)->visit( api_visitor( *this, c ) );
+      boost::any_cast<const Api&>(_api)->visit( api_visitor( *this, c ) );
    }
 
    template<typename Interface, typename Adaptor, typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( 
+   std::function<std::vector<char>(const std::vector<char>&)> binary_generic_api::api_visitor::to_generic(
                                                const std::function<fc::api<Interface,Adaptor>(Args...)>& f )const
    {
       auto api_con = _api_con;
-      auto gapi = &api;
-      return [=]( const params_type& args ) { 
+      return [=]( const std::vector<char>& args ) {
          auto con = api_con.lock();
          FC_ASSERT( con, "not connected" );
 
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         auto api_result = gapi->call_generic( f, args ); 
-         return con->register_api( api_result );
+         auto api_result = detail::call_binary( f, args, api_con );
+         return fc::raw::pack( uint64_t( con->register_api( api_result ) ) );
       };
    }
    template<typename Interface, typename Adaptor, typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( 
+   std::function<std::vector<char>(const std::vector<char>&)> binary_generic_api::api_visitor::to_generic(
                                                const std::function<fc::optional<fc::api<Interface,Adaptor>>(Args...)>& f )const
    {
       auto api_con = _api_con;
-      auto gapi = &api;
-      return [=]( const params_type& args )-> fc::variant { 
+      return [=]( const std::vector<char>& args ) {
          auto con = api_con.lock();
          FC_ASSERT( con, "not connected" );
 
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         auto api_result = gapi->call_generic( f, ds ); 
+         auto api_result = detail::call_binary( f, args, api_con );
+         fc::optional<uint64_t> api_id;
          if( api_result )
-            return con->register_api( *api_result );
-         return result_type();
-      };
-   }
-
-   template<typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic(
-                                               const std::function<fc::api_ptr(Args...)>& f )const
-   {
-      auto api_con = _api_con;
-      auto gapi = &api;
-      return [=]( const variants& args ) -> fc::variant {
-         auto con = api_con.lock();
-         FC_ASSERT( con, "not connected" );
-
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         auto api_result = gapi->call_generic( f, ds );
-         if( !api_result )
-            return result_type();
-         return api_result->register_api( *con );
-      };
-   }
-
-   template<typename R, typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( const std::function<R(Args...)>& f )const
-   {
-      generic_api* gapi = &api;
-      return [f,gapi]( const params_type& args ) { 
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         return  fc::raw::pack(gapi->call_generic( f, ds )); 
-      };
-   }
-
-   template<typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( const std::function<void(Args...)>& f )const
-   {
-      generic_api* gapi = &api;
-      return [f,gapi]( const params_type& args ) { 
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         gapi->call_generic( f, ds ); 
-         return result_type();
+            api_id = con->register_api( *api_result );
+         return fc::raw::pack( api_id );
       };
    }
 
-   /**
-    * It is slightly unclean tight coupling to have this method in the api class.
-    * It breaks encapsulation by requiring an api class method to have a pointer
-    * to an binary_api_connection.  The reason this is necessary is we have a goal of being
-    * able to call register_api() on an api<T> through its base class api_base.  But
-    * register_api() must know the template parameters!
-    *
-    * The only reasonable way to achieve the goal is to implement register_api()
-    * as a method in api<T> (which obviously knows the template parameter T),
-    * then make the implementation accessible through the base class (by making
-    * it a pure virtual method in the base class which is overridden by the subclass's
-    * implementation).
-    */
-   template< typename Interface, typename Transform >
-   api_id_type api< Interface, Transform >::register_api( binary_api_connection& conn )const
-   {
-      return conn.register_api( *this );
-   }
-
-   template< typename T >
-   api<T> api_base::as()
-   {
-      // TODO:  this method should probably be const (if it is not too hard)
-      api<T>* maybe_requested_type = dynamic_cast< api<T>* >(this);
-      if( maybe_requested_type != nullptr )
-         return *maybe_requested_type;
-
-      detail::any_api* maybe_any = dynamic_cast< detail::any_api* >(this);
-      FC_ASSERT( maybe_any != nullptr );
-      std::shared_ptr< binary_api_connection > api_conn = maybe_any->_binary_api_connection.lock();
-      FC_ASSERT( api_conn );
-      return api_conn->get_remote_api<T>( maybe_any->_api_id );
-   }
-
    namespace detail {
       template<typename Signature>
-      template<typename... Args> 
-      typename callback_functor<Signature>::result_type callback_functor<Signature>::operator()( Args... args )const
+      void binary_arg< std::function<Signature> >::pack( std::vector<char>& out, const std::function<Signature>& v, binary_api_connection& con )
       {
-         std::shared_ptr< fc::binary_api_connection > locked = _binary_api_connection.lock();
-         // TODO:  make new exception type for this instead of recycling eof_exception
-         if( !locked )
-            throw fc::eof_exception();
-
-         /// TODO------------->>> pack args... 
-         locked->send_callback( _callback_id, fc::raw::pack( args... ) ).template as< result_type >();
+         auto packed = fc::raw::pack( con.register_callback( v ) );
+         out.insert( out.end(), packed.begin(), packed.end() );
       }
 
+      template<typename Signature>
+      class binary_callback_functor
+      {
+         public:
+            typedef typename std::function<Signature>::result_type result_type;
+
+            binary_callback_functor( std::weak_ptr< fc::binary_api_connection > con, uint64_t id )
+            :_callback_id(id),_binary_api_connection(con){}
+
+            template<typename... Args>
+            result_type operator()( Args... args )const
+            {
+               std::shared_ptr< fc::binary_api_connection > locked = _binary_api_connection.lock();
+               if( !locked )
+                  FC_THROW_EXCEPTION( fc::eof_exception, "The connection of this callback is closed" );
+               return fc::raw::unpack<result_type>( locked->send_callback( _callback_id, pack_binary_args( *locked, args... ) ) );
+            }
+
+         private:
+            uint64_t _callback_id;
+            std::weak_ptr< fc::binary_api_connection > _binary_api_connection;
+      };
 
       template<typename... Args>
-      class callback_functor<void(Args...)>
+      class binary_callback_functor<void(Args...)>
       {
          public:
-          typedef void result_type;
+            typedef void result_type;
 
-          callback_functor( std::weak_ptr< fc::binary_api_connection > con, uint64_t id )
-          :_callback_id(id),_binary_api_connection(con){}
+            binary_callback_functor( std::weak_ptr< fc::binary_api_connection > con, uint64_t id )
+            :_callback_id(id),_binary_api_connection(con){}
 
-          void operator()( Args... args )const
-          {
-             std::shared_ptr< fc::binary_api_connection > locked = _binary_api_connection.lock();
-             // TODO:  make new exception type for this instead of recycling eof_exception
-             if( !locked )
-                throw fc::eof_exception();
-             locked->send_notice( _callback_id, fc::variants{ args... } );
-          }
+            void operator()( Args... args )const
+            {
+               std::shared_ptr< fc::binary_api_connection > locked = _binary_api_connection.lock();
+               if( !locked )
+                  FC_THROW_EXCEPTION( fc::eof_exception, "The connection of this callback is closed" );
+               locked->send_notice( _callback_id, pack_binary_args( *locked, args... ) );
+            }
 
          private:
-          uint64_t _callback_id;
-          std::weak_ptr< fc::binary_api_connection > _binary_api_connection;
+            uint64_t _callback_id;
+            std::weak_ptr< fc::binary_api_connection > _binary_api_connection;
       };
    } // namespace detail
 
-} // fc
+} // namespace fc
@@ -0,0 +1,71 @@
+#pragma once
+#include <fc/rpc/api_metrics.hpp>
+#include <fc/rpc/api_rate_limiter.hpp>
+#include <fc/rpc/binary_api_connection.hpp>
+#include <fc/rpc/bstate.hpp>
+#include <fc/network/http/websocket.hpp>
+#include <fc/static_variant.hpp>
+
+namespace fc { namespace rpc {
+
+   /** arguments of the "call" method, params holds the packed arguments of the remote method */
+   struct bcall
+   {
+      api_id_type   api_id = 0;
+      std::string   method;
+      params_type   params;
+   };
+
+   /** arguments of the "callback" and "notice" methods */
+   struct bcallback
+   {
+      uint64_t      callback_id = 0;
+      params_type   params;
+   };
+
+   /** every websocket frame carries exactly one of these */
+   typedef fc::static_variant< brequest, bresponse > bmessage;
+
+   /**
+    *  Speaks the binary_api_connection protocol over binary websocket frames, using fc::raw
+    *  instead of JSON for the envelope as well as for the arguments and results.
+    */
+   class binary_websocket_api_connection : public binary_api_connection
+   {
+      public:
+         binary_websocket_api_connection( fc::http::websocket_connection& c );
+         ~binary_websocket_api_connection();
+
+         virtual result_type send_call(
+            api_id_type api_id,
+            string method_name,
+            params_type args = params_type() ) override;
+         virtual result_type send_callback(
+            uint64_t callback_id,
+            params_type args = params_type() ) override;
+         virtual void send_notice(
+            uint64_t callback_id,
+            params_type args = params_type() ) override;
+
+         /** calls are counted in api_metrics, limited by api_rate_limiter and run through the executor like on the JSON endpoints */
+         void set_call_executor( call_executor executor ) { _call_executor = std::move( executor ); }
+
+      protected:
+         void on_message( const std::string& message );
+         /** performs one request and returns its packed result */
+         result_type handle_request( const brequest& call, std::string& method );
+         void send( const bmessage& message );
+
+         fc::http::websocket_connection&  _connection;
+         fc::rpc::bstate                  _rpc_state;
+         call_executor                    _call_executor;
+         /** the remote address the calls are counted under in api_metrics */
+         std::string                      _client;
+         /** what this connection may still spend under api_rate_limiter */
+         api_budget                       _budget;
+   };
+
+} } // namespace fc::rpc
+
+FC_REFLECT( fc::rpc::bcall, (api_id)(method)(params) )
+FC_REFLECT( fc::rpc::bcallback, (callback_id)(params) )
@@ -4,6 +4,8 @@
 #include <fc/network/http/server.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/rpc/api_connection.hpp>
+#include <fc/rpc/api_metrics.hpp>
+#include <fc/rpc/api_rate_limiter.hpp>
 #include <fc/rpc/state.hpp>
 
 namespace fc { namespace rpc {
@@ -29,7 +31,18 @@ namespace fc { namespace rpc {
             const fc::http::request& req,
             const fc::http::server::response& resp );
 
+         /**
+          *  Performs the request or JSON-RPC 2.0 batch in req_body, which is parsed in place, and stores the
+          *  JSON response in resp_body.  Notifications get no response; a batch of only notifications
+          *  gets NoContent.
+          */
+         http::reply::status_code handle_body( std::string& req_body, const std::string& client, std::string& resp_body );
+         /** performs one request and stores its JSON response in resp_body, which stays empty for notifications */
+         http::reply::status_code handle_request( const variant& var, const std::string& client, std::string& resp_body );
+
          fc::rpc::state                   _rpc_state;
+         /** what this connection may still spend under api_rate_limiter */
+         api_budget                       _budget;
    };
 
 } } // namespace fc::rpc
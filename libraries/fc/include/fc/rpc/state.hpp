@@ -31,6 +31,18 @@ namespace fc { namespace rpc {
       optional<error_object> error;
    };
 
+   /**
+    *  An executor receives the API method of each incoming call together with a functor that performs
+    *  the call.  It may run the functor on another thread, e.g. to serve read only calls from a worker
+    *  pool; without one, calls run in place on the connection's thread.
+    */
+   typedef std::function< void( const std::string& method, const std::function<void()>& invoke ) > call_executor;
+
+   /** the JSON-RPC 2.0 error code of an entry that is not a valid request object */
+   const int64_t invalid_request_code = -32600;
+   /** the most requests one JSON-RPC 2.0 batch may hold */
+   const size_t max_batch_size = 256;
+
    class state
    {
       public:
@@ -1,8 +1,11 @@
 #pragma once
 #include <fc/rpc/api_connection.hpp>
+#include <fc/rpc/api_metrics.hpp>
+#include <fc/rpc/api_rate_limiter.hpp>
 #include <fc/rpc/state.hpp>
 #include <fc/network/http/websocket.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_writer.hpp>
 #include <fc/reflect/variant.hpp>
 
 namespace fc { namespace rpc {
@@ -24,13 +27,26 @@ namespace fc { namespace rpc {
             uint64_t callback_id,
             variants args = variants() ) override;
 
+         void set_call_executor( call_executor executor ) { _call_executor = std::move( executor ); }
+
       protected:
          std::string on_message(
             const std::string& message,
             bool send_message = true );
 
+         /** handles one request or reply and returns the JSON reply to send, if any */
+         std::string handle_message( const variant& message );
+
+         /** performs call and writes its result as JSON */
+         void write_call_result( const request& call, json_writer& out );
+
          fc::http::websocket_connection&  _connection;
          fc::rpc::state                   _rpc_state;
+         call_executor                    _call_executor;
+         /** the remote address the calls are counted under in api_metrics */
+         std::string                      _client;
+         /** what this connection may still spend under api_rate_limiter */
+         api_budget                       _budget;
    };
 
 } } // namespace fc::rpc
@@ -24,12 +24,16 @@
 
 #pragma once
 
+#include <fc/exception/exception.hpp>
 #include <fc/thread/task.hpp>
 #include <fc/thread/thread.hpp>
 #include <fc/asio.hpp>
 
 #include <boost/atomic/atomic.hpp>
 
+#include <algorithm>
+#include <vector>
+
 namespace fc {
 
    namespace detail {
@@ -39,6 +43,7 @@ namespace fc {
       public:
          worker_pool();
          ~worker_pool();
+         uint16_t num_threads()const;
          void post( task_base* task );
       private:
           pool_impl*    my;
@@ -87,6 +92,30 @@ namespace fc {
       }
    };
 
+   /**
+    *  The worker pool behind do_parallel() and parallel_for() has one thread per io thread of
+    *  fc::asio (see default_io_service_scope::set_num_threads()). Each worker has its own queue of
+    *  tasks; tasks posted from inside a task go to the queue of its worker and idle workers steal
+    *  from the others, so a task that splits its work and waits for the parts keeps its own worker
+    *  busy with them.
+    *
+    *  Waiting for the returned fc::future blocks only the calling fc task, so chain, p2p and API code
+    *  running on an fc::thread may offload work and wait for it like for any other fc::async().
+    *  Only hand over pure computations, e.g. signature recovery, hashing, packing or JSON
+    *  serialization of copies: the tasks run concurrently with the caller, so they must not touch
+    *  the database, the node or any other state owned by a single fc::thread, and everything they
+    *  capture by reference must outlive the wait. Dispatching a task costs a few microseconds, so
+    *  offload batches rather than single cheap operations.
+    *
+    *  @code
+    *    std::vector<fc::future<public_key_type>> keys;
+    *    for( const auto& sig : trx.signatures )
+    *       keys.push_back( fc::do_parallel( [&sig,digest] () { return public_key_type( fc::ecc::public_key( sig, digest ) ); } ) );
+    *    for( auto& key : keys )
+    *       result.insert( key.wait() );
+    *  @endcode
+    */
+
    /**
     *  Calls function <code>f</code> in a separate thread and returns a future
     *  that can be used to wait on the result.
@@ -103,4 +132,67 @@ namespace fc {
       detail::get_worker_pool().post( tsk );
       return r;
    }
+
+   /** the number of threads of the worker pool */
+   inline uint16_t parallel_concurrency() { return detail::get_worker_pool().num_threads(); }
+
+   /**
+    *  Calls f(i) for every i in [0,count) on the worker pool and waits until all calls returned.
+    *  The range is split into chunks of at least grain indices, about four per worker, and the last
+    *  chunk runs on the calling thread. If calls throw, the first exception is rethrown once all
+    *  chunks are done.
+    *
+    *  @param count the number of calls
+    *  @param f the operation to perform for each index, must be safe to call concurrently
+    *  @param grain the smallest number of indices worth a task of their own
+    */
+   template<typename Functor>
+   void parallel_for( size_t count, const Functor& f, size_t grain = 1 )
+   {
+      if( count == 0 )
+         return;
+      const size_t chunks = std::max<size_t>( 1, std::min<size_t>( 4 * parallel_concurrency(),
+                                                                   count / std::max<size_t>( grain, 1 ) ) );
+      const size_t chunk_size = ( count + chunks - 1 ) / chunks;
+      auto run_chunk = [&f,count,chunk_size] ( size_t begin ) {
+         const size_t end = std::min( count, begin + chunk_size );
+         for( size_t i = begin; i < end; ++i )
+            f( i );
+      };
+
+      std::vector<fc::future<void>> parts;
+      parts.reserve( chunks );
+      size_t begin = 0;
+      for( ; begin + chunk_size < count; begin += chunk_size )
+         parts.push_back( do_parallel( [&run_chunk,begin] () { run_chunk( begin ); }, "parallel_for" ) );
+
+      fc::exception_ptr error;
+      try
+      {
+         run_chunk( begin );
+      }
+      catch( const fc::exception& e )
+      {
+         error = e.dynamic_copy_exception();
+      }
+      catch( ... )
+      {
+         error = std::make_shared<fc::unhandled_exception>( FC_LOG_MESSAGE( warn, "unhandled exception in parallel_for" ),
+                                                            std::current_exception() );
+      }
+      for( auto& part : parts )
+      {
+         try
+         {
+            part.wait();
+         }
+         catch( const fc::exception& e )
+         {
+            if( !error )
+               error = e.dynamic_copy_exception();
+         }
+      }
+      if( error )
+         error->dynamic_rethrow_exception();
+   }
 }
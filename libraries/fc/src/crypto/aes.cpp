@@ -10,6 +10,7 @@
 
 #include <fc/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <limits>
 #include <openssl/opensslconf.h>
 #ifndef OPENSSL_THREADS
 # error "OpenSSL must be configured to support threads"
@@ -170,6 +171,135 @@ uint32_t aes_decoder::final_decode( char* plaintext )
 
 
 
+namespace detail
+{
+   /** the 96 bit nonce of the message_number'th message, the message counter in its last 8 bytes */
+   static void make_gcm_nonce( uint64_t message_number, unsigned char* nonce )
+   {
+      memset( nonce, 0, 4 );
+      for( int i = 11; i >= 4; --i, message_number >>= 8 )
+         nonce[i] = (unsigned char)message_number;
+   }
+}
+
+struct aes_gcm_encoder::impl
+{
+   evp_cipher_ctx ctx;
+   uint64_t       message_count = 0;
+};
+
+aes_gcm_encoder::aes_gcm_encoder()
+{
+  static int init = init_openssl();
+  (void)init;
+}
+
+aes_gcm_encoder::~aes_gcm_encoder()
+{
+}
+
+void aes_gcm_encoder::init( const fc::sha256& key )
+{
+    my->ctx.obj = EVP_CIPHER_CTX_new();
+    if( !my->ctx )
+        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    if( 1 != EVP_EncryptInit_ex( my->ctx, EVP_aes_256_gcm(), NULL, (const unsigned char*)&key, NULL ) )
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm encryption init",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    my->message_count = 0;
+}
+
+void aes_gcm_encoder::begin_message()
+{
+    FC_ASSERT( my->message_count != std::numeric_limits<uint64_t>::max(), "aes gcm nonces exhausted" );
+    unsigned char nonce[12];
+    detail::make_gcm_nonce( my->message_count++, nonce );
+    // keeps the key schedule from init(), only the nonce changes
+    if( 1 != EVP_EncryptInit_ex( my->ctx, NULL, NULL, NULL, nonce ) )
+        FC_THROW_EXCEPTION( aes_exception, "error setting aes 256 gcm nonce",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+}
+
+uint32_t aes_gcm_encoder::encode( const char* plaintxt, uint32_t plaintext_len, char* ciphertxt )
+{
+    int ciphertext_len = 0;
+    if( 1 != EVP_EncryptUpdate( my->ctx, (unsigned char*)ciphertxt, &ciphertext_len, (const unsigned char*)plaintxt, plaintext_len ) )
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm encryption update",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    FC_ASSERT( (uint32_t) ciphertext_len == plaintext_len, "", ("ciphertext_len",ciphertext_len)("plaintext_len",plaintext_len) );
+    return ciphertext_len;
+}
+
+void aes_gcm_encoder::end_message( char* tag )
+{
+    unsigned char unused[16];
+    int final_len = 0;
+    if( 1 != EVP_EncryptFinal_ex( my->ctx, unused, &final_len ) ||
+        1 != EVP_CIPHER_CTX_ctrl( my->ctx, EVP_CTRL_GCM_GET_TAG, tag_size, tag ) )
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm encryption final",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+}
+
+struct aes_gcm_decoder::impl
+{
+   evp_cipher_ctx ctx;
+   uint64_t       message_count = 0;
+};
+
+aes_gcm_decoder::aes_gcm_decoder()
+{
+  static int init = init_openssl();
+  (void)init;
+}
+
+aes_gcm_decoder::~aes_gcm_decoder()
+{
+}
+
+void aes_gcm_decoder::init( const fc::sha256& key )
+{
+    my->ctx.obj = EVP_CIPHER_CTX_new();
+    if( !my->ctx )
+        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    if( 1 != EVP_DecryptInit_ex( my->ctx, EVP_aes_256_gcm(), NULL, (const unsigned char*)&key, NULL ) )
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm decryption init",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    my->message_count = 0;
+}
+
+void aes_gcm_decoder::begin_message()
+{
+    FC_ASSERT( my->message_count != std::numeric_limits<uint64_t>::max(), "aes gcm nonces exhausted" );
+    unsigned char nonce[12];
+    detail::make_gcm_nonce( my->message_count++, nonce );
+    if( 1 != EVP_DecryptInit_ex( my->ctx, NULL, NULL, NULL, nonce ) )
+        FC_THROW_EXCEPTION( aes_exception, "error setting aes 256 gcm nonce",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+}
+
+uint32_t aes_gcm_decoder::decode( const char* ciphertxt, uint32_t ciphertxt_len, char* plaintext )
+{
+    int plaintext_len = 0;
+    if( 1 != EVP_DecryptUpdate( my->ctx, (unsigned char*)plaintext, &plaintext_len, (const unsigned char*)ciphertxt, ciphertxt_len ) )
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm decryption update",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    FC_ASSERT( ciphertxt_len == (uint32_t)plaintext_len, "", ("ciphertxt_len",ciphertxt_len)("plaintext_len",plaintext_len) );
+    return plaintext_len;
+}
+
+void aes_gcm_decoder::end_message( const char* tag )
+{
+    unsigned char unused[16];
+    int final_len = 0;
+    if( 1 != EVP_CIPHER_CTX_ctrl( my->ctx, EVP_CTRL_GCM_SET_TAG, tag_size, (void*)tag ) )
+        FC_THROW_EXCEPTION( aes_exception, "error setting aes 256 gcm tag",
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    if( 1 != EVP_DecryptFinal_ex( my->ctx, unused, &final_len ) )
+        FC_THROW_EXCEPTION( aes_exception, "aes 256 gcm message failed authentication" );
+}
+
 /** example method from wiki.opensslfoundation.com */
 unsigned aes_encrypt(unsigned char *plaintext, int plaintext_len, unsigned char *key,
                      unsigned char *iv, unsigned char *ciphertext)
@@ -6,6 +6,7 @@
 #include <fc/io/sstream.hpp>
 #include <fc/log/logger.hpp>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -409,6 +410,163 @@ namespace fc
    }
 
 
+   /**
+    *  Non owning input over a contiguous buffer for json::insitu_parser.  peek() and get() behave
+    *  like buffered_istream over a stringstream, throwing eof_exception at the end, so the parser
+    *  templates above accept exactly the same inputs; the specializations below only add fast paths
+    *  that scan the buffer directly instead of going through a stream one character at a time.
+    */
+   class json_buffer_istream
+   {
+      public:
+         json_buffer_istream( const char* begin, const char* end ):_pos(begin),_end(end){}
+
+         char peek()const
+         {
+            if( _pos == _end )
+               FC_THROW_EXCEPTION( eof_exception, "end of JSON input" );
+            return *_pos;
+         }
+         char get()
+         {
+            char c = peek();
+            ++_pos;
+            return c;
+         }
+
+         const char* pos()const { return _pos; }
+         const char* end()const { return _end; }
+         void        skip( size_t n ) { _pos += n; }
+
+      private:
+         const char* _pos;
+         const char* _end;
+   };
+
+   template<>
+   fc::string stringFromStream( json_buffer_istream& in )
+   {
+      fc::string token;
+      try
+      {
+         char c = in.peek();
+
+         if( c != '"' )
+            FC_THROW_EXCEPTION( parse_error_exception,
+                                            "Expected '\"' but read '${char}'",
+                                            ("char", string(&c, (&c) + 1) ) );
+         in.get();
+         while( true )
+         {
+            // copy everything up to the next special character in one piece, which for strings
+            // without escapes is the whole string
+            const char* run = in.pos();
+            const char* itr = run;
+            while( itr != in.end() && *itr != '"' && *itr != '\\' && *itr != 0x04 )
+               ++itr;
+            token.append( run, itr );
+            in.skip( itr - run );
+
+            switch( in.peek() )
+            {
+               case '\\':
+                  token += parseEscape( in );
+                  break;
+               case '"':
+                  in.get();
+                  return token;
+               default:
+                  FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '${token}'",
+                                                   ("token", token ) );
+            }
+         }
+       } FC_RETHROW_EXCEPTIONS( warn, "while parsing token '${token}'",
+                                          ("token", token ) );
+   }
+
+   template<>
+   variant number_from_stream<json_buffer_istream, json::insitu_parser>( json_buffer_istream& in )
+   {
+      const char* begin = in.pos();
+      const char* itr = begin;
+      bool  dot = false;
+      bool  neg = false;
+      if( in.peek() == '-' )
+      {
+         neg = true;
+         ++itr;
+      }
+      for( ; itr != in.end(); ++itr )
+      {
+         if( *itr == '.' )
+         {
+            if( dot )
+               FC_THROW_EXCEPTION(parse_error_exception, "Can't parse a number with two decimal places");
+            dot = true;
+         }
+         else if( *itr < '0' || *itr > '9' )
+            break;
+      }
+      fc::string str( begin, itr );
+      in.skip( itr - begin );
+      if( itr != in.end() && isalnum( *itr ) )
+         return str + stringFromToken( in );
+      if (str == "-." || str == "." || str == "-") // check the obviously wrong things we could have encountered
+        FC_THROW_EXCEPTION(parse_error_exception, "Can't parse token \"${token}\" as a JSON numeric constant", ("token", str));
+      if( dot )
+        return variant(to_double(str));
+      if( neg )
+        return to_int64(str);
+      return to_uint64(str);
+   }
+
+   template<>
+   variant token_from_stream( json_buffer_istream& in )
+   {
+      const char* begin = in.pos();
+      const char* itr = begin;
+      for( bool done = false; itr != in.end() && !done; )
+      {
+         switch( *itr )
+         {
+            case 'n':
+            case 'u':
+            case 'l':
+            case 't':
+            case 'r':
+            case 'e':
+            case 'f':
+            case 'a':
+            case 's':
+               ++itr;
+               break;
+            default:
+               done = true;
+               break;
+         }
+      }
+      bool received_eof = ( itr == in.end() );
+      size_t len = itr - begin;
+      in.skip( len );
+
+      if( len == 4 && memcmp( begin, "null", 4 ) == 0 )
+        return variant();
+      if( len == 4 && memcmp( begin, "true", 4 ) == 0 )
+        return true;
+      if( len == 5 && memcmp( begin, "false", 5 ) == 0 )
+        return false;
+
+      // see token_from_stream() above for how malformed tokens are treated
+      fc::string str( begin, itr );
+      if( received_eof )
+      {
+        if( str.empty() )
+          FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF" );
+        return str;
+      }
+      return str + stringFromToken( in );
+   }
+
    template<typename T, json::parse_type parser_type>
    variant variant_from_stream( T& in, uint32_t max_depth )
    {
@@ -457,6 +615,11 @@ namespace fc
 
    variant json::from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
+      if( ptype == insitu_parser )
+      {
+         json_buffer_istream in( utf8_str.data(), utf8_str.data() + utf8_str.size() );
+         return variant_from_stream<json_buffer_istream, insitu_parser>( in, max_depth );
+      }
       fc::istream_ptr in( new fc::stringstream( utf8_str ) );
       fc::buffered_istream bin( in );
       return from_stream( bin, ptype, max_depth );
@@ -763,6 +926,7 @@ namespace fc
       switch( ptype )
       {
           case legacy_parser:
+          case insitu_parser:
               return variant_from_stream<fc::buffered_istream, legacy_parser>( in, max_depth );
 #ifdef WITH_EXOTIC_JSON_PARSERS
           case legacy_parser_with_string_doubles:
@@ -798,6 +962,12 @@ namespace fc
    bool json::is_valid( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    {
       if( utf8_str.size() == 0 ) return false;
+      if( ptype == insitu_parser )
+      {
+         json_buffer_istream in( utf8_str.data(), utf8_str.data() + utf8_str.size() );
+         variant_from_stream<json_buffer_istream, insitu_parser>( in, max_depth );
+         return in.pos() == in.end();
+      }
       fc::istream_ptr in( new fc::stringstream( utf8_str ) );
       fc::buffered_istream bin( in );
       from_stream( bin, ptype, max_depth );
@@ -0,0 +1,163 @@
+#include <fc/io/json_writer.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace fc
+{
+   namespace
+   {
+      /** the escape sequence for c, or nullptr if it is written as is; must agree with escape_string() in json.cpp */
+      const char* escape_sequence( unsigned char c )
+      {
+         static const char* const control[0x20] = {
+            "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005", "\\u0006", "\\u0007",
+            "\\b",     "\\t",     "\\n",     "\\u000b", "\\f",     "\\r",     "\\u000e", "\\u000f",
+            "\\u0010", "\\u0011", "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
+            "\\u0018", "\\u0019", "\\u001a", "\\u001b", "\\u001c", "\\u001d", "\\u001e", "\\u001f"
+         };
+         if( c < 0x20 )
+            return control[c];
+         if( c == '"' )
+            return "\\\"";
+         if( c == '\\' )
+            return "\\\\";
+         return nullptr;
+      }
+   }
+
+   void json_writer::write( const std::string& s )
+   {
+      _out += '"';
+      const char* run = s.data();
+      const char* end = s.data() + s.size();
+      for( const char* itr = run; itr != end; ++itr )
+      {
+         const char* escaped = escape_sequence( static_cast<unsigned char>( *itr ) );
+         if( escaped )
+         {
+            _out.append( run, itr - run );
+            _out += escaped;
+            run = itr + 1;
+         }
+      }
+      _out.append( run, end - run );
+      _out += '"';
+   }
+
+   void json_writer::write_key( const char* key )
+   {
+      write( std::string( key ) );
+      _out += ':';
+   }
+
+   void json_writer::write_number( uint64_t i )
+   {
+      char buf[20];
+      char* p = buf + sizeof(buf);
+      do
+      {
+         *--p = char( '0' + i % 10 );
+         i /= 10;
+      } while( i );
+      _out.append( p, buf + sizeof(buf) - p );
+   }
+
+   void json_writer::write_number( int64_t i )
+   {
+      if( i < 0 )
+      {
+         _out += '-';
+         write_number( uint64_t( 0 ) - uint64_t( i ) );
+      }
+      else
+         write_number( uint64_t( i ) );
+   }
+
+   void json_writer::write( int64_t i )
+   {
+      if( _format == json::stringify_large_ints_and_doubles && ( i > INT32_MAX || i < INT32_MIN ) )
+      {
+         _out += '"';
+         write_number( i );
+         _out += '"';
+      }
+      else
+         write_number( i );
+   }
+
+   void json_writer::write( uint64_t i )
+   {
+      if( _format == json::stringify_large_ints_and_doubles && i > 0xffffffff )
+      {
+         _out += '"';
+         write_number( i );
+         _out += '"';
+      }
+      else
+         write_number( i );
+   }
+
+   void json_writer::write( const variants& a )
+   {
+      write_array( a.begin(), a.end() );
+   }
+
+   void json_writer::write( const variant_object& o )
+   {
+      scope nested( *this );
+      _out += '{';
+      for( auto itr = o.begin(); itr != o.end(); ++itr )
+      {
+         if( itr != o.begin() )
+            _out += ',';
+         write( itr->key() );
+         _out += ':';
+         write( itr->value() );
+      }
+      _out += '}';
+   }
+
+   void json_writer::write( const variant& v )
+   {
+      FC_ASSERT( _max_depth > 0, "Too many nested objects!" );
+      switch( v.get_type() )
+      {
+         case variant::null_type:
+              _out += "null";
+              return;
+         case variant::int64_type:
+              write( v.as_int64() );
+              return;
+         case variant::uint64_type:
+              write( v.as_uint64() );
+              return;
+         case variant::double_type:
+              if( _format == json::stringify_large_ints_and_doubles )
+              {
+                 _out += '"';
+                 _out += v.as_string();
+                 _out += '"';
+              }
+              else
+                 _out += v.as_string();
+              return;
+         case variant::bool_type:
+              write( v.as_bool() );
+              return;
+         case variant::string_type:
+              write( v.get_string() );
+              return;
+         case variant::blob_type:
+              write( v.as_string() );
+              return;
+         case variant::array_type:
+              write( v.get_array() );
+              return;
+         case variant::object_type:
+              write( v.get_object() );
+              return;
+         default:
+            FC_THROW_EXCEPTION( fc::invalid_arg_exception, "Unsupported variant type: ${type}", ( "type", v.get_type() ) );
+      }
+   }
+
+} // namespace fc
@@ -6,13 +6,110 @@
 #include <fc/thread/thread.hpp>
 #include <fc/variant.hpp>
 #include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <sstream>
 #include <iostream>
+#include <thread>
 
 namespace fc {
 
+   namespace detail
+   {
+      /**
+       *  Bounded queue of log messages for any number of producers and consumers, after Dmitry
+       *  Vyukov's.  Each cell carries a sequence number that tells whether it is free for the push
+       *  or ready for the pop of a given position, so producers only contend on the position counter.
+       */
+      class log_message_queue
+      {
+         public:
+            explicit log_message_queue( size_t capacity )
+            {
+               size_t size = 2;
+               while( size < capacity )
+                  size <<= 1;
+               _mask = size - 1;
+               _cells.reset( new cell[size] );
+               for( size_t i = 0; i < size; ++i )
+                  _cells[i].sequence.store( i, std::memory_order_relaxed );
+            }
+
+            /** false if the queue is full */
+            bool push( const log_message& m )
+            {
+               cell* c;
+               size_t pos = _enqueue_pos.load( std::memory_order_relaxed );
+               for( ;; )
+               {
+                  c = &_cells[pos & _mask];
+                  intptr_t diff = intptr_t( c->sequence.load( std::memory_order_acquire ) ) - intptr_t( pos );
+                  if( diff == 0 )
+                  {
+                     if( _enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                        break;
+                  }
+                  else if( diff < 0 )
+                     return false;
+                  else
+                     pos = _enqueue_pos.load( std::memory_order_relaxed );
+               }
+               c->message = m;
+               c->sequence.store( pos + 1, std::memory_order_release );
+               return true;
+            }
+
+            /** false if the queue is empty */
+            bool pop( log_message& m )
+            {
+               cell* c;
+               size_t pos = _dequeue_pos.load( std::memory_order_relaxed );
+               for( ;; )
+               {
+                  c = &_cells[pos & _mask];
+                  intptr_t diff = intptr_t( c->sequence.load( std::memory_order_acquire ) ) - intptr_t( pos + 1 );
+                  if( diff == 0 )
+                  {
+                     if( _dequeue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                        break;
+                  }
+                  else if( diff < 0 )
+                     return false;
+                  else
+                     pos = _dequeue_pos.load( std::memory_order_relaxed );
+               }
+               m = *c->message;
+               c->message.reset();
+               c->sequence.store( pos + _mask + 1, std::memory_order_release );
+               return true;
+            }
+
+            bool empty()const
+            {
+               size_t pos = _dequeue_pos.load( std::memory_order_relaxed );
+               return _cells[pos & _mask].sequence.load( std::memory_order_acquire ) != pos + 1;
+            }
+
+         private:
+            struct cell
+            {
+               std::atomic<size_t>     sequence;
+               optional<log_message>   message;
+            };
+
+            std::unique_ptr<cell[]>    _cells;
+            size_t                     _mask;
+            std::atomic<size_t>        _enqueue_pos{0};
+            std::atomic<size_t>        _dequeue_pos{0};
+      };
+   }
+
    class file_appender::impl : public fc::retainable
    {
       public:
@@ -20,10 +117,20 @@ namespace fc {
          ofstream                   out;
          boost::mutex               slock;
 
+         /** the writer thread and its queue, if cfg.async is set */
+         std::unique_ptr<detail::log_message_queue> queue;
+         std::atomic<uint64_t>      dropped{0};
+
       private:
          future<void>               _rotation_task;
          time_point_sec             _current_file_start_time;
 
+         std::thread                _writer;
+         std::mutex                 _wake_lock;
+         std::condition_variable    _wake;
+         std::atomic<bool>          _writer_waiting{false};
+         std::atomic<bool>          _stopping{false};
+
          time_point_sec get_file_start_time( const time_point_sec& timestamp, const microseconds& interval )
          {
              int64_t interval_seconds = interval.to_seconds();
@@ -52,10 +159,22 @@ namespace fc {
             {
                std::cerr << "error opening log file: " << cfg.filename.preferred_string() << "\n";
             }
+
+            if( cfg.async )
+            {
+               queue.reset( new detail::log_message_queue( std::max<uint32_t>( cfg.queue_size, 2 ) ) );
+               _writer = std::thread( [this]() { write_queued_messages(); } );
+            }
          }
 
          ~impl()
          {
+            if( _writer.joinable() )
+            {
+               _stopping = true;
+               wake_writer();
+               _writer.join();
+            }
             try
             {
               _rotation_task.cancel_and_wait("file_appender is destructing");
@@ -65,6 +184,99 @@ namespace fc {
             }
          }
 
+         /** formats one line of the log file */
+         std::string format_line( const log_message& m )const
+         {
+            std::stringstream line;
+            //line << (m.get_context().get_timestamp().time_since_epoch().count() % (1000ll*1000ll*60ll*60))/1000 <<"ms ";
+            line << string(m.get_context().get_timestamp()) << " ";
+            line << std::setw( 21 ) << (m.get_context().get_thread_name().substr(0,9) + string(":") + m.get_context().get_task_name()).c_str() << " ";
+
+            string method_name = m.get_context().get_method();
+            // strip all leading scopes...
+            if( method_name.size() )
+            {
+               uint32_t p = 0;
+               for( uint32_t i = 0;i < method_name.size(); ++i )
+               {
+                   if( method_name[i] == ':' ) p = i;
+               }
+
+               if( method_name[p] == ':' )
+                 ++p;
+               line << std::setw( 20 ) << m.get_context().get_method().substr(p,20).c_str() <<" ";
+            }
+
+            line << "] ";
+            fc::string message = fc::format_string( m.get_format(), m.get_data(), cfg.max_object_depth );
+            line << message.c_str();
+            line << "\t\t\t" << m.get_context().get_file() << ":" << m.get_context().get_line_number() << "\n";
+            return line.str();
+         }
+
+         void wake_writer()
+         {
+            if( _writer_waiting )
+            {
+               std::lock_guard<std::mutex> guard( _wake_lock );
+               _wake.notify_one();
+            }
+         }
+
+         /** the writer thread: formats and writes queued messages until the appender is destroyed */
+         void write_queued_messages()
+         {
+            log_message m;
+            for( ;; )
+            {
+               bool stopping = _stopping;
+               bool wrote = false;
+               while( queue->pop( m ) )
+               {
+                  std::string line = format_line( m );
+                  fc::scoped_lock<boost::mutex> lock( slock );
+                  out << line;
+                  wrote = true;
+               }
+               uint64_t lost = dropped.exchange( 0 );
+               if( lost > 0 || ( wrote && cfg.flush ) )
+               {
+                  fc::scoped_lock<boost::mutex> lock( slock );
+                  if( lost > 0 )
+                     out << string( time_point::now() ) << " file_appender: " << lost
+                         << " log messages were dropped because the queue was full\n";
+                  if( cfg.flush )
+                     out.flush();
+               }
+               if( stopping )
+                  break;
+
+               std::unique_lock<std::mutex> lock( _wake_lock );
+               _writer_waiting = true;
+               if( queue->empty() && !_stopping )
+                  _wake.wait_for( lock, std::chrono::milliseconds( 100 ) );
+               _writer_waiting = false;
+            }
+            fc::scoped_lock<boost::mutex> lock( slock );
+            out.flush();
+         }
+
+         /** hands m to the writer thread, waits for room unless m may be dropped */
+         void enqueue( const log_message& m )
+         {
+            while( !queue->push( m ) )
+            {
+               if( m.get_context().get_log_level() < log_level::warn )
+               {
+                  ++dropped;
+                  return;
+               }
+               wake_writer();
+               std::this_thread::yield();
+            }
+            wake_writer();
+         }
+
          void rotate_files( bool initializing = false )
          {
              FC_ASSERT( cfg.rotate );
@@ -151,33 +363,16 @@ namespace fc {
    // MS THREAD METHOD  MESSAGE \t\t\t File:Line
    void file_appender::log( const log_message& m )
    {
-      std::stringstream line;
-      //line << (m.get_context().get_timestamp().time_since_epoch().count() % (1000ll*1000ll*60ll*60))/1000 <<"ms ";
-      line << string(m.get_context().get_timestamp()) << " ";
-      line << std::setw( 21 ) << (m.get_context().get_thread_name().substr(0,9) + string(":") + m.get_context().get_task_name()).c_str() << " ";
-
-      string method_name = m.get_context().get_method();
-      // strip all leading scopes...
-      if( method_name.size() )
+      if( my->queue )
       {
-         uint32_t p = 0;
-         for( uint32_t i = 0;i < method_name.size(); ++i )
-         {
-             if( method_name[i] == ':' ) p = i;
-         }
-
-         if( method_name[p] == ':' )
-           ++p;
-         line << std::setw( 20 ) << m.get_context().get_method().substr(p,20).c_str() <<" ";
+         my->enqueue( m );
+         return;
       }
 
-      line << "] ";
-      fc::string message = fc::format_string( m.get_format(), m.get_data(), my->cfg.max_object_depth );
-      line << message.c_str();
-
+      std::string line = my->format_line( m );
       {
         fc::scoped_lock<boost::mutex> lock( my->slock );
-        my->out << line.str() << "\t\t\t" << m.get_context().get_file() << ":" << m.get_context().get_line_number() << "\n";
+        my->out << line;
         if( my->cfg.flush )
           my->out.flush();
       }
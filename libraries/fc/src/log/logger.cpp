@@ -7,14 +7,34 @@
 #include <fc/filesystem.hpp>
 #include <unordered_map>
 #include <string>
+#include <atomic>
 #include <fc/log/logger_config.hpp>
 
 namespace fc {
 
+    namespace detail {
+       /** the lowest level of any logger created or configured since the last reset */
+       std::atomic<int> lowest_log_level( log_level::off );
+
+       void lower_lowest_log_level( log_level ll )
+       {
+          int lowest = lowest_log_level.load();
+          while( ll < lowest && !lowest_log_level.compare_exchange_weak( lowest, ll ) );
+       }
+
+       void reset_lowest_log_level()
+       {
+          lowest_log_level = log_level::off;
+       }
+    }
+
     class logger::impl : public fc::retainable {
       public:
          impl()
-         :_parent(nullptr),_enabled(true),_additivity(false),_level(log_level::warn){}
+         :_parent(nullptr),_enabled(true),_additivity(false),_level(log_level::warn)
+         {
+            detail::lower_lowest_log_level( _level );
+         }
          fc::string       _name;
          logger           _parent;
          bool             _enabled;
@@ -57,8 +77,22 @@ namespace fc {
     bool operator==( const logger& l, std::nullptr_t ) { return !l.my; }
     bool operator!=( const logger& l, std::nullptr_t ) { return l.my;  }
 
+    bool logger::may_log( log_level e ) {
+       return e >= detail::lowest_log_level.load( std::memory_order_relaxed );
+    }
+
     bool logger::is_enabled( log_level e )const {
-       return e >= my->_level;
+       if( e < my->_level )
+          return false;
+       // messages of a logger without appenders are only worth building if a parent writes them
+       for( const impl* l = my.get(); l != nullptr; l = l->_parent.my.get() )
+       {
+          if( !l->_appenders.empty() )
+             return true;
+          if( !l->_additivity )
+             return false;
+       }
+       return false;
     }
 
     void logger::log( log_message m ) {
@@ -94,7 +128,11 @@ namespace fc {
     logger& logger::set_parent(const logger& p) { my->_parent = p; return *this; }
 
     log_level logger::get_log_level()const { return my->_level; }
-    logger& logger::set_log_level(log_level ll) { my->_level = ll; return *this; }
+    logger& logger::set_log_level(log_level ll) {
+       detail::lower_lowest_log_level( ll );
+       my->_level = ll;
+       return *this;
+    }
 
     void logger::add_appender( const fc::shared_ptr<appender>& a )
     { my->_appenders.push_back(a); }
@@ -13,6 +13,7 @@
 namespace fc {
    extern std::unordered_map<std::string,logger>& get_logger_map();
    extern std::unordered_map<std::string,appender::ptr>& get_appender_map();
+   namespace detail { void reset_lowest_log_level(); }
    logger_config& logger_config::add_appender( const string& s ) { appenders.push_back(s); return *this; }
 
    void configure_logging( const fc::path& lc )
@@ -26,6 +27,7 @@ namespace fc {
       static bool reg_file_appender = appender::register_appender<file_appender>( "file" );
       get_logger_map().clear();
       get_appender_map().clear();
+      detail::reset_lowest_log_level();
 
       for( size_t i = 0; i < cfg.appenders.size(); ++i ) {
          appender::create( cfg.appenders[i].name, cfg.appenders[i].type, cfg.appenders[i].args );
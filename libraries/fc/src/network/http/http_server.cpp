@@ -23,6 +23,8 @@ namespace fc { namespace http {
          switch( rep.status ) {
             case fc::http::reply::OK: ss << "OK\r\n"; break;
             case fc::http::reply::RecordCreated: ss << "Record Created\r\n"; break;
+            case fc::http::reply::NoContent: ss << "No Content\r\n"; break;
+            case fc::http::reply::BadRequest: ss << "Bad Request\r\n"; break;
             case fc::http::reply::NotFound: ss << "Not Found\r\n"; break;
             case fc::http::reply::Found: ss << "Found\r\n"; break;
             default: ss << "Internal Server Error\r\n"; break;
@@ -11,6 +11,12 @@
 #include <fc/thread/thread.hpp>
 #include <fc/asio.hpp>
 
+#include <mutex>
+
+#define MINIZ_HEADER_FILE_ONLY
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "../../compress/miniz.c"
+
 #ifdef DEFAULT_LOGGER
 # undef DEFAULT_LOGGER
 #endif
@@ -20,6 +26,176 @@ namespace fc { namespace http {
 
    namespace detail {
 
+      std::mutex             compression_lock;
+      websocket_compression  server_compression;
+      websocket_compression  client_compression;
+
+      websocket_compression get_compression( bool is_server )
+      {
+         std::lock_guard<std::mutex> guard( compression_lock );
+         return is_server ? server_compression : client_compression;
+      }
+
+      /**
+       *  The permessage-deflate extension of websocketpp, implemented with miniz so that it needs no zlib
+       *  and takes its compression level from websocket_compression.  miniz only supports 15 bit windows,
+       *  so offers that limit the window of our compressor are declined; our decompressor accepts any
+       *  window the other end chooses.  Inflating stops with message_too_big once a message grows past
+       *  max_message_size, the limit the connection puts on uncompressed messages.
+       */
+      template<typename config, size_t max_message_size>
+      class permessage_deflate
+      {
+         public:
+            typedef std::pair<websocketpp::lib::error_code,std::string> err_str_pair;
+
+            permessage_deflate()
+            {
+               memset( &_deflate, 0, sizeof(_deflate) );
+               memset( &_inflate, 0, sizeof(_inflate) );
+            }
+            ~permessage_deflate()
+            {
+               if( _initialized )
+               {
+                  mz_deflateEnd( &_deflate );
+                  mz_inflateEnd( &_inflate );
+               }
+            }
+
+            bool is_implemented()const { return true; }
+            bool is_enabled()const     { return _enabled; }
+
+            /** clients only, the offer of the opening handshake */
+            std::string generate_offer()const
+            {
+               _offered = get_compression( false ).enabled;
+               return _offered ? "permessage-deflate" : "";
+            }
+
+            /** the offer of a client on servers, the response of the server on clients */
+            err_str_pair negotiate( const websocketpp::http::attribute_list& attributes )
+            {
+               err_str_pair result;
+               const bool is_server = !_offered;
+               const auto compression = get_compression( is_server );
+               _level = compression.level;
+               if( !compression.enabled )
+               {
+                  result.first = websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::disabled );
+                  return result;
+               }
+
+               const std::string ours   = is_server ? "server_" : "client_";
+               const std::string theirs = is_server ? "client_" : "server_";
+               bool their_no_context_takeover = false;
+               _no_context_takeover = false;
+               for( const auto& attribute : attributes )
+               {
+                  if( attribute.first == ours + "no_context_takeover" )
+                     _no_context_takeover = true;
+                  else if( attribute.first == theirs + "no_context_takeover" )
+                     their_no_context_takeover = true;
+                  else if( attribute.first == ours + "max_window_bits" && attribute.second != "15" )
+                     result.first = websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+                  else if( attribute.first != ours + "max_window_bits" && attribute.first != theirs + "max_window_bits" )
+                     result.first = websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+               }
+               if( result.first )
+                  return result;
+
+               _enabled = true;
+               result.second = "permessage-deflate";
+               if( is_server && _no_context_takeover )
+                  result.second += "; server_no_context_takeover";
+               if( is_server && their_no_context_takeover )
+                  result.second += "; client_no_context_takeover";
+               return result;
+            }
+
+            websocketpp::lib::error_code init( bool is_server )
+            {
+               if( mz_deflateInit2( &_deflate, _level, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 9, MZ_DEFAULT_STRATEGY ) != MZ_OK )
+                  return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+               if( mz_inflateInit2( &_inflate, -MZ_DEFAULT_WINDOW_BITS ) != MZ_OK )
+               {
+                  mz_deflateEnd( &_deflate );
+                  return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+               }
+               _initialized = true;
+               return websocketpp::lib::error_code();
+            }
+
+            /** appends in compressed and sync flushed, websocketpp strips the trailing 00 00 ff ff */
+            websocketpp::lib::error_code compress( const std::string& in, std::string& out )
+            {
+               if( !_initialized )
+                  return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+               if( in.empty() )
+               {
+                  const char empty[6] = { 0x02, 0x00, 0x00, 0x00, char(0xff), char(0xff) };
+                  out.append( empty, sizeof(empty) );
+                  return websocketpp::lib::error_code();
+               }
+               if( _no_context_takeover )
+                  mz_deflateReset( &_deflate );
+
+               _deflate.next_in = reinterpret_cast<const unsigned char*>( in.data() );
+               _deflate.avail_in = in.size();
+               do {
+                  _deflate.next_out = _buffer;
+                  _deflate.avail_out = sizeof(_buffer);
+                  if( mz_deflate( &_deflate, MZ_SYNC_FLUSH ) < 0 )
+                     return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+                  out.append( reinterpret_cast<const char*>( _buffer ), sizeof(_buffer) - _deflate.avail_out );
+               } while( _deflate.avail_out == 0 );
+               return websocketpp::lib::error_code();
+            }
+
+            websocketpp::lib::error_code decompress( const uint8_t* buf, size_t len, std::string& out )
+            {
+               if( !_initialized )
+                  return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+
+               _inflate.next_in = buf;
+               _inflate.avail_in = len;
+               while( true )
+               {
+                  const size_t available = _inflate.avail_in;
+                  _inflate.next_out = _buffer;
+                  _inflate.avail_out = sizeof(_buffer);
+                  int status = mz_inflate( &_inflate, MZ_SYNC_FLUSH );
+                  const size_t produced = sizeof(_buffer) - _inflate.avail_out;
+                  out.append( reinterpret_cast<const char*>( _buffer ), produced );
+                  if( out.size() > max_message_size )
+                     return websocketpp::processor::error::make_error_code( websocketpp::processor::error::message_too_big );
+                  if( status == MZ_STREAM_END )
+                  {
+                     // the sender ended the stream with a final block, the next message starts a new one
+                     mz_inflateEnd( &_inflate );
+                     if( mz_inflateInit2( &_inflate, -MZ_DEFAULT_WINDOW_BITS ) != MZ_OK )
+                        return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+                     return websocketpp::lib::error_code();
+                  }
+                  if( status != MZ_OK && status != MZ_BUF_ERROR )
+                     return websocketpp::extensions::error::make_error_code( websocketpp::extensions::error::general );
+                  // miniz may hold back output even when all input is consumed, so stop only without progress
+                  if( produced == 0 && _inflate.avail_in == available )
+                     return websocketpp::lib::error_code();
+               }
+            }
+
+         private:
+            mutable bool   _offered = false;
+            bool           _enabled = false;
+            bool           _initialized = false;
+            bool           _no_context_takeover = false;
+            int            _level = -1;
+            mz_stream      _deflate;
+            mz_stream      _inflate;
+            unsigned char  _buffer[16384];
+      };
+
       struct asio_with_stub_log : public websocketpp::config::asio {
 
           typedef asio_with_stub_log type;
@@ -60,6 +236,8 @@ namespace fc { namespace http {
           typedef websocketpp::transport::asio::endpoint<transport_config>
               transport_type;
 
+          typedef permessage_deflate<permessage_deflate_config, max_message_size> permessage_deflate_type;
+
           static const long timeout_open_handshake = 0;
       };
       struct asio_tls_with_stub_log : public websocketpp::config::asio_tls {
@@ -101,6 +279,8 @@ namespace fc { namespace http {
           typedef websocketpp::transport::asio::endpoint<transport_config>
               transport_type;
 
+          typedef permessage_deflate<permessage_deflate_config, max_message_size> permessage_deflate_type;
+
           static const long timeout_open_handshake = 0;
       };
       struct asio_tls_stub_log : public websocketpp::config::asio_tls {
@@ -134,6 +314,8 @@ namespace fc { namespace http {
 
          typedef websocketpp::transport::asio::endpoint<transport_config>
          transport_type;
+
+         typedef permessage_deflate<permessage_deflate_config, max_message_size> permessage_deflate_type;
       };
 
 
@@ -148,8 +330,8 @@ namespace fc { namespace http {
       class websocket_connection_impl : public websocket_connection
       {
          public:
-            websocket_connection_impl( T con )
-            :_ws_connection(con){
+            websocket_connection_impl( T con, bool is_server )
+            :_ws_connection(con),_min_compressed_size( get_compression( is_server ).min_size ){
             }
 
             ~websocket_connection_impl()
@@ -158,9 +340,17 @@ namespace fc { namespace http {
 
             virtual void send_message( const std::string& message )override
             {
-               idump((message));
+               ddump((message));
                //std::cerr<<"send: "<<message<<"\n";
-               auto ec = _ws_connection->send( message );
+               // only the string overload asks websocketpp to compress, if permessage-deflate was negotiated
+               auto ec = message.size() < _min_compressed_size
+                         ? _ws_connection->send( message.data(), message.size(), websocketpp::frame::opcode::text )
+                         : _ws_connection->send( message );
+               FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
+            }
+            virtual void send_binary_message( const std::string& message )override
+            {
+               auto ec = _ws_connection->send( message, websocketpp::frame::opcode::binary );
                FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
             }
             virtual void close( int64_t code, const std::string& reason  )override
@@ -173,7 +363,18 @@ namespace fc { namespace http {
               return _ws_connection->get_request_header(key);
             }
 
-            T _ws_connection;
+            virtual std::string get_remote_endpoint_string()override
+            {
+              return _ws_connection->get_remote_endpoint();
+            }
+
+            virtual bool is_compressed()override
+            {
+               return _ws_connection->get_response_header( "Sec-WebSocket-Extensions" ).find( "permessage-deflate" ) != std::string::npos;
+            }
+
+            T        _ws_connection;
+            uint32_t _min_compressed_size;
       };
 
       typedef websocketpp::lib::shared_ptr<boost::asio::ssl::context> context_ptr;
@@ -190,7 +391,7 @@ namespace fc { namespace http {
                _server.set_reuse_addr(true);
                _server.set_open_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
-                       auto new_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
+                       auto new_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl), true );
                        _on_connection( _connections[hdl] = new_con );
                     }).wait();
                });
@@ -198,7 +399,7 @@ namespace fc { namespace http {
                     _server_thread.async( [&](){
                        auto current_con = _connections.find(hdl);
                        assert( current_con != _connections.end() );
-                       wdump(("server")(msg->get_payload()));
+                       ddump(("server")(msg->get_payload()));
                        //std::cerr<<"recv: "<<msg->get_payload()<<"\n";
                        auto payload = msg->get_payload();
                        std::shared_ptr<websocket_connection> con = current_con->second;
@@ -216,17 +417,17 @@ namespace fc { namespace http {
 
                _server.set_http_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
-                       auto current_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
+                       auto current_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl), true );
                        _on_connection( current_con );
 
                        auto con = _server.get_con_from_hdl(hdl);
                        con->defer_http_response();
                        std::string request_body = con->get_request_body();
-                       wdump(("server")(request_body));
+                       ddump(("server")(request_body));
 
                        fc::async([current_con, request_body, con] {
                           std::string response = current_con->on_http(request_body);
-                          idump((response));
+                          ddump((response));
                           con->set_body( response );
                           con->set_status( websocketpp::http::status_code::ok );
                           con->send_http_response();
@@ -325,7 +526,7 @@ namespace fc { namespace http {
                _server.set_reuse_addr(true);
                _server.set_open_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
-                       auto new_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
+                       auto new_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl), true );
                        _on_connection( _connections[hdl] = new_con );
                     }).wait();
                });
@@ -342,14 +543,14 @@ namespace fc { namespace http {
                _server.set_http_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
 
-                       auto current_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
+                       auto current_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl), true );
                        try{
                           _on_connection( current_con );
 
                           auto con = _server.get_con_from_hdl(hdl);
-                          wdump(("server")(con->get_request_body()));
+                          ddump(("server")(con->get_request_body()));
                           auto response = current_con->on_http( con->get_request_body() );
-                          idump((response));
+                          ddump((response));
                           con->set_body( response );
                           con->set_status( websocketpp::http::status_code::ok );
                        } catch ( const fc::exception& e )
@@ -428,7 +629,7 @@ namespace fc { namespace http {
                 _client.clear_access_channels( websocketpp::log::alevel::all );
                 _client.set_message_handler( [&]( connection_hdl hdl, message_ptr msg ){
                    _client_thread.async( [&](){
-                        wdump((msg->get_payload()));
+                        ddump((msg->get_payload()));
                         //std::cerr<<"recv: "<<msg->get_payload()<<"\n";
                         auto received = msg->get_payload();
                         fc::async( [=](){
@@ -488,7 +689,7 @@ namespace fc { namespace http {
                 _client.clear_access_channels( websocketpp::log::alevel::all );
                 _client.set_message_handler( [&]( connection_hdl hdl, message_ptr msg ){
                    _client_thread.async( [&](){
-                        wdump((msg->get_payload()));
+                        ddump((msg->get_payload()));
                       _connection->on_message( msg->get_payload() );
                    }).wait();
                 });
@@ -596,6 +797,18 @@ namespace fc { namespace http {
 
    } // namespace detail
 
+   void set_server_compression( const websocket_compression& compression )
+   {
+      std::lock_guard<std::mutex> guard( detail::compression_lock );
+      detail::server_compression = compression;
+   }
+
+   void set_client_compression( const websocket_compression& compression )
+   {
+      std::lock_guard<std::mutex> guard( detail::compression_lock );
+      detail::client_compression = compression;
+   }
+
    websocket_server::websocket_server():my( new detail::websocket_server_impl() ) {}
    websocket_server::~websocket_server(){}
 
@@ -664,7 +877,7 @@ namespace fc { namespace http {
 
        my->_client.set_open_handler( [=]( websocketpp::connection_hdl hdl ){
           auto con =  my->_client.get_con_from_hdl(hdl);
-          my->_connection = std::make_shared<detail::websocket_connection_impl<detail::websocket_client_connection_type>>( con );
+          my->_connection = std::make_shared<detail::websocket_connection_impl<detail::websocket_client_connection_type>>( con, false );
           my->_closed = fc::promise<void>::ptr( new fc::promise<void>("websocket::closed") );
           my->_connected->set_value();
        });
@@ -691,7 +904,7 @@ namespace fc { namespace http {
 
        smy->_client.set_open_handler( [=]( websocketpp::connection_hdl hdl ){
           auto con =  smy->_client.get_con_from_hdl(hdl);
-          smy->_connection = std::make_shared<detail::websocket_connection_impl<detail::websocket_tls_client_connection_type>>( con );
+          smy->_connection = std::make_shared<detail::websocket_connection_impl<detail::websocket_tls_client_connection_type>>( con, false );
           smy->_closed = fc::promise<void>::ptr( new fc::promise<void>("websocket::closed") );
           smy->_connected->set_value();
        });
@@ -713,7 +926,7 @@ namespace fc { namespace http {
 
        my->_client.set_open_handler( [=]( websocketpp::connection_hdl hdl ){
           auto con =  my->_client.get_con_from_hdl(hdl);
-          my->_connection = std::make_shared<detail::websocket_connection_impl<detail::websocket_tls_client_connection_type>>( con );
+          my->_connection = std::make_shared<detail::websocket_connection_impl<detail::websocket_tls_client_connection_type>>( con, false );
           my->_closed = fc::promise<void>::ptr( new fc::promise<void>("websocket::closed") );
           my->_connected->set_value();
        });
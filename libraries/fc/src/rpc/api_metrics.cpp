@@ -0,0 +1,186 @@
+#include <fc/rpc/api_metrics.hpp>
+#include <fc/log/logger.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+
+namespace fc { namespace rpc {
+
+   namespace
+   {
+      /** bucket i holds the durations in [2^(i-1), 2^i) microseconds, bucket 0 holds zero */
+      size_t bucket_of( uint64_t us )
+      {
+         size_t b = 0;
+         while( us && b < 39 )
+         {
+            us >>= 1;
+            ++b;
+         }
+         return b;
+      }
+   }
+
+   constexpr const char* api_metrics::unknown_method;
+
+   api_metrics& api_metrics::instance()
+   {
+      static api_metrics metrics;
+      return metrics;
+   }
+
+   std::string api_metrics::method_name( const request& call )
+   {
+      if( call.method == "call" && call.params.size() >= 2 && call.params[1].is_string() )
+         return call.params[1].get_string();
+      return call.method;
+   }
+
+   std::string api_metrics::client_name( const std::string& forwarded_for, const std::string& remote_endpoint )
+   {
+      auto port = remote_endpoint.rfind( ':' );
+      std::string address = ( port == std::string::npos || port == 0 ) ? remote_endpoint : remote_endpoint.substr( 0, port );
+      if( forwarded_for.empty() )
+         return address;
+
+      auto& metrics = instance();
+      {
+         std::lock_guard<std::mutex> guard( metrics._lock );
+         if( !metrics._trusted_proxies.count( address ) )
+            return address;
+      }
+      // the proxy appends the address it received the request from, earlier entries come from the client
+      auto last = forwarded_for.rfind( ',' );
+      std::string forwarded = boost::trim_copy( last == std::string::npos ? forwarded_for : forwarded_for.substr( last + 1 ) );
+      return forwarded.empty() ? address : forwarded;
+   }
+
+   void api_metrics::set_trusted_proxies( std::set<std::string> proxies )
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      _trusted_proxies = std::move( proxies );
+   }
+
+   void api_metrics::entry::add( uint64_t us, size_t bytes, bool failed )
+   {
+      ++calls;
+      if( failed )
+         ++errors;
+      total_us += us;
+      max_us = std::max( max_us, us );
+      response_bytes += bytes;
+      ++buckets[ bucket_of( us ) ];
+   }
+
+   api_call_metrics api_metrics::entry::get( const std::string& name )const
+   {
+      api_call_metrics result;
+      result.name = name;
+      result.calls = calls;
+      result.errors = errors;
+      result.total_us = total_us;
+      result.max_us = max_us;
+      result.response_bytes = response_bytes;
+
+      // the upper end of the bucket holding the requested rank, but never more than the maximum
+      auto percentile = [this]( uint64_t permille ) -> uint64_t {
+         uint64_t rank = ( calls * permille + 999 ) / 1000;
+         uint64_t seen = 0;
+         for( size_t b = 0; b < buckets.size(); ++b )
+         {
+            seen += buckets[b];
+            if( seen >= rank && seen > 0 )
+               return std::min( max_us, b ? ( uint64_t(1) << b ) - 1 : uint64_t(0) );
+         }
+         return max_us;
+      };
+      result.p50_us = percentile( 500 );
+      result.p90_us = percentile( 900 );
+      result.p99_us = percentile( 990 );
+      return result;
+   }
+
+   void api_metrics::record( const std::string& client, const std::string& method, const variants& params,
+                             const microseconds& elapsed, size_t response_bytes, bool failed )
+   {
+      uint64_t us = std::max<int64_t>( elapsed.count(), 0 );
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         ++_calls;
+         _methods[method].add( us, response_bytes, failed );
+         auto itr = _clients.find( client );
+         if( itr == _clients.end() )
+            itr = _clients.emplace( _clients.size() < max_clients ? client : std::string( "other" ), entry() ).first;
+         itr->second.add( us, response_bytes, failed );
+      }
+
+      if( elapsed > max_threshold() )
+         elog( "API call execution time limit exceeded. client: ${c} method: ${m} params: ${p} time: ${t}",
+               ("c",client)("m",method)("p",params)("t",elapsed) );
+      else if( elapsed > warn_threshold() )
+         wlog( "API call execution time nearing limit. client: ${c} method: ${m} params: ${p} time: ${t}",
+               ("c",client)("m",method)("p",params)("t",elapsed) );
+   }
+
+   std::vector<api_call_metrics> api_metrics::sorted( const std::unordered_map<std::string,entry>& entries )
+   {
+      std::vector<api_call_metrics> result;
+      result.reserve( entries.size() );
+      for( const auto& e : entries )
+         result.push_back( e.second.get( e.first ) );
+      std::sort( result.begin(), result.end(), []( const api_call_metrics& a, const api_call_metrics& b ) {
+         return a.total_us > b.total_us;
+      });
+      return result;
+   }
+
+   std::vector<api_call_metrics> api_metrics::get_method_metrics()const
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      return sorted( _methods );
+   }
+
+   std::vector<api_call_metrics> api_metrics::get_client_metrics()const
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      return sorted( _clients );
+   }
+
+   void api_metrics::reset()
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      _methods.clear();
+      _clients.clear();
+      _calls = 0;
+      _calls_at_last_summary = 0;
+   }
+
+   void api_metrics::set_thresholds( const microseconds& warn, const microseconds& max )
+   {
+      FC_ASSERT( warn <= max, "The warn threshold must not exceed the max threshold" );
+      _warn_us = warn.count();
+      _max_us = max.count();
+   }
+
+   void api_metrics::log_summary( size_t top )
+   {
+      uint64_t calls;
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         calls = _calls - _calls_at_last_summary;
+         _calls_at_last_summary = _calls;
+      }
+      if( calls == 0 )
+         return;
+
+      auto methods = get_method_metrics();
+      std::string busiest;
+      for( size_t i = 0; i < methods.size() && i < top; ++i )
+      {
+         const auto& m = methods[i];
+         busiest += ( i ? ", " : "" ) + m.name + " " + std::to_string( m.calls ) + " calls "
+                  + std::to_string( m.total_us / 1000 ) + "ms p99 " + std::to_string( m.p99_us / 1000 ) + "ms";
+      }
+      ilog( "API: ${n} calls since last summary, busiest methods since reset: ${b}", ("n",calls)("b",busiest) );
+   }
+
+} } // namespace fc::rpc
@@ -0,0 +1,126 @@
+#include <fc/rpc/api_rate_limiter.hpp>
+#include <fc/exception/exception.hpp>
+#include <algorithm>
+
+namespace fc { namespace rpc {
+
+   double api_rate_limits::cost_of( const std::string& method )const
+   {
+      auto itr = method_costs.find( method );
+      return itr == method_costs.end() ? default_cost : itr->second;
+   }
+
+   void api_budget::refill( double capacity, double per_second, const time_point& now )
+   {
+      if( !initialized )
+      {
+         units = capacity;
+         initialized = true;
+      }
+      else if( now > updated )
+         units = std::min( capacity, units + per_second * ( now - updated ).count() / 1000000.0 );
+      updated = now;
+   }
+
+   const size_t api_rate_limiter::max_clients;
+
+   api_rate_limiter& api_rate_limiter::instance()
+   {
+      static api_rate_limiter limiter;
+      return limiter;
+   }
+
+   void api_rate_limiter::set_limits( const api_rate_limits& limits )
+   {
+      FC_ASSERT( limits.connection_budget >= 0 && limits.connection_refill_per_second >= 0
+                 && limits.client_budget >= 0 && limits.client_refill_per_second >= 0,
+                 "API budgets and refill rates must not be negative" );
+      FC_ASSERT( limits.default_cost >= 0 && limits.cost_per_ms >= 0, "API call costs must not be negative" );
+      for( const auto& cost : limits.method_costs )
+         FC_ASSERT( cost.second >= 0, "API call costs must not be negative", ("method",cost.first) );
+
+      std::lock_guard<std::mutex> guard( _lock );
+      _limits = limits;
+      _clients.clear();
+      _client_order.clear();
+   }
+
+   api_rate_limits api_rate_limiter::get_limits()const
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      return _limits;
+   }
+
+   void api_rate_limiter::start_call( const std::string& client, api_budget& connection, const std::string& method )
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      if( _limits.connection_budget == 0 && _limits.client_budget == 0 )
+         return;
+
+      const double cost = _limits.cost_of( method );
+      const auto now = time_point::now();
+      if( _limits.connection_budget > 0 )
+      {
+         connection.refill( _limits.connection_budget, _limits.connection_refill_per_second, now );
+         FC_ASSERT( connection.units >= cost,
+                    "API rate limit exceeded for this connection: ${m} costs ${c}, ${u} of ${b} units left, refilled at ${r} per second",
+                    ("m",method)("c",cost)("u",connection.units)("b",_limits.connection_budget)("r",_limits.connection_refill_per_second) );
+      }
+      if( _limits.client_budget > 0 )
+      {
+         auto& budget = client_budget( client );
+         budget.refill( _limits.client_budget, _limits.client_refill_per_second, now );
+         FC_ASSERT( budget.units >= cost,
+                    "API rate limit exceeded for ${client}: ${m} costs ${c}, ${u} of ${b} units left, refilled at ${r} per second",
+                    ("client",client)("m",method)("c",cost)("u",budget.units)("b",_limits.client_budget)("r",_limits.client_refill_per_second) );
+         budget.units -= cost;
+      }
+      if( _limits.connection_budget > 0 )
+         connection.units -= cost;
+   }
+
+   void api_rate_limiter::finish_call( const std::string& client, api_budget& connection, const microseconds& elapsed )
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      if( _limits.cost_per_ms == 0 )
+         return;
+
+      // budgets may go negative here, the client then has to wait until they are refilled
+      const double cost = _limits.cost_per_ms * elapsed.count() / 1000.0;
+      if( _limits.connection_budget > 0 )
+         connection.units -= cost;
+      if( _limits.client_budget > 0 )
+      {
+         auto itr = _clients.find( client );
+         if( itr != _clients.end() )
+            itr->second.budget.units -= cost;
+      }
+   }
+
+   api_budget& api_rate_limiter::client_budget( const std::string& client )
+   {
+      auto itr = _clients.find( client );
+      if( itr != _clients.end() )
+      {
+         _client_order.splice( _client_order.begin(), _client_order, itr->second.position );
+         return itr->second.budget;
+      }
+
+      if( _clients.size() >= max_clients )
+      {
+         _clients.erase( _client_order.back() );
+         _client_order.pop_back();
+      }
+      _client_order.push_front( client );
+      auto& entry = _clients[client];
+      entry.position = _client_order.begin();
+      return entry.budget;
+   }
+
+   size_t api_rate_limiter::client_count()const
+   {
+      std::lock_guard<std::mutex> guard( _lock );
+      return _clients.size();
+   }
+
+} } // namespace fc::rpc
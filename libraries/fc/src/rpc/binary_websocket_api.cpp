@@ -0,0 +1,146 @@
+#include <fc/rpc/binary_websocket_api.hpp>
+#include <fc/scoped_exit.hpp>
+
+namespace fc { namespace rpc {
+
+binary_websocket_api_connection::~binary_websocket_api_connection()
+{
+}
+
+binary_websocket_api_connection::binary_websocket_api_connection( fc::http::websocket_connection& c )
+   : _connection(c)
+{
+   _client = api_metrics::client_name( _connection.get_request_header( "X-Forwarded-For" ),
+                                       _connection.get_remote_endpoint_string() );
+
+   _rpc_state.add_method( "notice", [this]( const params_type& args ) -> result_type
+   {
+      auto notice = fc::raw::unpack<bcallback>( args );
+      this->receive_notice( notice.callback_id, notice.params );
+      return result_type();
+   } );
+
+   _rpc_state.add_method( "callback", [this]( const params_type& args ) -> result_type
+   {
+      auto callback = fc::raw::unpack<bcallback>( args );
+      return this->receive_callback( callback.callback_id, callback.params );
+   } );
+
+   _rpc_state.on_unhandled( [&]( const std::string& method_name, const params_type& args )
+   {
+      return this->receive_call( 0, method_name, args );
+   } );
+
+   _connection.on_message_handler( [&]( const std::string& msg ){ on_message(msg); } );
+   _connection.closed.connect( [this](){ closed(); } );
+}
+
+result_type binary_websocket_api_connection::send_call(
+   api_id_type api_id,
+   string method_name,
+   params_type args /* = params_type() */ )
+{
+   auto request = _rpc_state.start_remote_call( "call", fc::raw::pack( bcall{ api_id, std::move(method_name), std::move(args) } ) );
+   send( request );
+   return _rpc_state.wait_for_response( *request.id );
+}
+
+result_type binary_websocket_api_connection::send_callback(
+   uint64_t callback_id,
+   params_type args /* = params_type() */ )
+{
+   auto request = _rpc_state.start_remote_call( "callback", fc::raw::pack( bcallback{ callback_id, std::move(args) } ) );
+   send( request );
+   return _rpc_state.wait_for_response( *request.id );
+}
+
+void binary_websocket_api_connection::send_notice(
+   uint64_t callback_id,
+   params_type args /* = params_type() */ )
+{
+   brequest req{ optional<uint64_t>(), "notice", fc::raw::pack( bcallback{ callback_id, std::move(args) } ) };
+   send( req );
+}
+
+void binary_websocket_api_connection::send( const bmessage& message )
+{
+   auto packed = fc::raw::pack( message );
+   _connection.send_binary_message( std::string( packed.begin(), packed.end() ) );
+}
+
+result_type binary_websocket_api_connection::handle_request( const brequest& call, std::string& method )
+{
+   // "call" is unpacked here rather than in _rpc_state, so that the API method is known before the call runs
+   optional<bcall> api_call;
+   if( call.method == "call" )
+   {
+      api_call = fc::raw::unpack<bcall>( call.params );
+      method = api_call->method;
+   }
+   else
+      method = call.method;
+   if( !has_method( method ) )
+      method = api_metrics::unknown_method;
+
+   api_rate_limiter::instance().start_call( _client, _budget, method );
+   auto start = time_point::now();
+   auto charge_time = fc::make_scoped_exit( [this,start]() {
+      api_rate_limiter::instance().finish_call( _client, _budget, time_point::now() - start );
+   });
+
+   result_type result;
+   auto invoke = [this,&call,&api_call,&result]() {
+      if( api_call )
+         result = this->receive_call( api_call->api_id, api_call->method, api_call->params );
+      else
+         result = _rpc_state.local_call( call.method, call.params );
+   };
+   if( _call_executor )
+      _call_executor( method, invoke );
+   else
+      invoke();
+   return result;
+}
+
+void binary_websocket_api_connection::on_message( const std::string& message )
+{
+   try
+   {
+      auto msg = fc::raw::unpack<bmessage>( std::vector<char>( message.begin(), message.end() ) );
+      if( msg.which() == bmessage::tag<brequest>::value )
+      {
+         const auto& call = msg.get<brequest>();
+         std::string method = api_metrics::unknown_method;
+         auto start = time_point::now();
+         optional<error_object> error;
+         try
+         {
+            try
+            {
+               auto result = handle_request( call, method );
+               api_metrics::instance().record( _client, method, variants(), time_point::now() - start, result.size(), false );
+               if( call.id )
+                  send( bresponse( *call.id, result ) );
+               return;
+            }
+            FC_CAPTURE_AND_RETHROW( (call.method) )
+         }
+         catch ( const fc::exception& e )
+         {
+            api_metrics::instance().record( _client, method, variants(), time_point::now() - start, 0, true );
+            if( call.id )
+               error = error_object{ 1, e.to_string(), fc::variant( e, FC_PACK_MAX_DEPTH ) };
+         }
+         if( error )
+            send( bresponse( *call.id, *error ) );
+      }
+      else
+         _rpc_state.handle_reply( msg.get<bresponse>() );
+   }
+   catch ( const fc::exception& e )
+   {
+      wdump((e.to_detail_string()));
+   }
+}
+
+} } // namespace fc::rpc
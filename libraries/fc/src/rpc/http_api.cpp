@@ -1,5 +1,6 @@
 
 #include <fc/rpc/http_api.hpp>
+#include <fc/scoped_exit.hpp>
 
 namespace fc { namespace rpc {
 
@@ -79,6 +80,15 @@ void http_api_connection::send_notice(
    return;
 }
 
+namespace {
+   /** the JSON-RPC 2.0 reply to an entry that is not a request object */
+   std::string invalid_request_reply( const std::string& message )
+   {
+      return fc::json::to_string( mutable_variant_object( "id", variant() )( "jsonrpc", "2.0" )
+                                     ( "error", mutable_variant_object( "code", invalid_request_code )( "message", message ) ) );
+   }
+}
+
 void http_api_connection::on_request( const fc::http::request& req, const fc::http::server::response& resp )
 {
    // this must be called by outside HTTP server's on_request method
@@ -89,35 +99,8 @@ void http_api_connection::on_request( const fc::http::request& req, const fc::ht
    {
       resp.add_header( "Content-Type", "application/json" );
       std::string req_body( req.body.begin(), req.body.end() );
-      auto var = fc::json::from_string( req_body, fc::json::legacy_parser, _max_conversion_depth );
-      const auto& var_obj = var.get_object();
-
-      if( var_obj.contains( "method" ) )
-      {
-         auto call = var.as<fc::rpc::request>(_max_conversion_depth);
-         try
-         {
-            try
-            {
-               fc::variant result( _rpc_state.local_call( call.method, call.params ), _max_conversion_depth );
-               resp_body = fc::json::to_string( fc::variant( fc::rpc::response( *call.id, result ), _max_conversion_depth),
-                                                fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
-               resp_status = http::reply::OK;
-            }
-            FC_CAPTURE_AND_RETHROW( (call.method)(call.params) );
-         }
-         catch ( const fc::exception& e )
-         {
-            resp_body = fc::json::to_string( fc::variant( fc::rpc::response( *call.id, error_object{ 1, e.to_detail_string(), fc::variant(e, _max_conversion_depth)} ), _max_conversion_depth),
-                                             fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
-            resp_status = http::reply::InternalServerError;
-         }
-      }
-      else
-      {
-         resp_status = http::reply::BadRequest;
-         resp_body = "";
-      }
+      const std::string client = api_metrics::client_name( req.get_header( "X-Forwarded-For" ), req.remote_endpoint );
+      resp_status = handle_body( req_body, client, resp_body );
    }
    catch ( const fc::exception& e )
    {
@@ -138,4 +121,88 @@ void http_api_connection::on_request( const fc::http::request& req, const fc::ht
    return;
 }
 
+http::reply::status_code http_api_connection::handle_body( std::string& req_body, const std::string& client, std::string& resp_body )
+{
+   auto var = fc::json::from_string( req_body, fc::json::insitu_parser, _max_conversion_depth );
+   if( !var.is_array() || var.get_array().empty() )
+      return handle_request( var, client, resp_body );
+
+   // a JSON-RPC 2.0 batch: the calls run in order and their responses go back in one array,
+   // failed calls are reported in their own response and do not fail the batch
+   const auto& batch = var.get_array();
+   if( batch.size() > max_batch_size )
+   {
+      resp_body = invalid_request_reply( "Batch of " + std::to_string( batch.size() ) + " requests exceeds the limit of "
+                                         + std::to_string( max_batch_size ) );
+      return http::reply::BadRequest;
+   }
+   for( const auto& item : batch )
+   {
+      std::string item_body;
+      handle_request( item, client, item_body );
+      if( item_body.empty() )
+         continue;
+      resp_body += resp_body.empty() ? '[' : ',';
+      resp_body += item_body;
+   }
+   if( resp_body.empty() )
+      return http::reply::NoContent;
+   resp_body += ']';
+   return http::reply::OK;
+}
+
+http::reply::status_code http_api_connection::handle_request( const variant& var, const std::string& client, std::string& resp_body )
+{
+   if( !var.is_object() || !var.get_object().contains( "method" ) )
+   {
+      resp_body = invalid_request_reply( "Invalid Request" );
+      return http::reply::BadRequest;
+   }
+
+   fc::rpc::request call;
+   try
+   {
+      call = var.as<fc::rpc::request>(_max_conversion_depth);
+   }
+   catch ( const fc::exception& e )
+   {
+      // e.g. params that are no array or a method that is no string
+      resp_body = invalid_request_reply( e.to_string() );
+      return http::reply::BadRequest;
+   }
+   const std::string method = api_metrics::method_name( call, *this );
+   http::reply::status_code resp_status;
+   auto start = fc::time_point::now();
+   try
+   {
+      try
+      {
+         api_rate_limiter::instance().start_call( client, _budget, method );
+         auto charge_time = fc::make_scoped_exit( [this,&client,start]() {
+            api_rate_limiter::instance().finish_call( client, _budget, fc::time_point::now() - start );
+         });
+
+         fc::variant result( _rpc_state.local_call( call.method, call.params ), _max_conversion_depth );
+         // a notification is performed, but gets no response
+         if( call.id )
+            resp_body = fc::json::to_string( fc::variant( fc::rpc::response( *call.id, result ), _max_conversion_depth),
+                                             fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
+         resp_status = http::reply::OK;
+      }
+      FC_CAPTURE_AND_RETHROW( (call.method)(call.params) );
+   }
+   catch ( const fc::exception& e )
+   {
+      if( call.id )
+         resp_body = fc::json::to_string( fc::variant( fc::rpc::response( *call.id, error_object{ 1, e.to_detail_string(), fc::variant(e, _max_conversion_depth)} ), _max_conversion_depth),
+                                          fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
+      resp_status = http::reply::InternalServerError;
+   }
+   api_metrics::instance().record( client, method, call.params, fc::time_point::now() - start,
+                                   resp_body.size(), resp_status != http::reply::OK );
+   if( !call.id )
+      return http::reply::NoContent;
+   return resp_status;
+}
+
 } } // namespace fc::rpc
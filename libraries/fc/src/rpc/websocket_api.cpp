@@ -1,8 +1,18 @@
 
 #include <fc/rpc/websocket_api.hpp>
+#include <fc/scoped_exit.hpp>
 
 namespace fc { namespace rpc {
 
+namespace {
+   /** the JSON-RPC 2.0 reply to a batch, or an entry of one, that is not a valid request */
+   std::string invalid_request_reply( const std::string& message )
+   {
+      return fc::json::to_string( mutable_variant_object( "id", variant() )( "jsonrpc", "2.0" )
+                                     ( "error", mutable_variant_object( "code", invalid_request_code )( "message", message ) ) );
+   }
+}
+
 websocket_api_connection::~websocket_api_connection()
 {
 }
@@ -10,23 +20,8 @@ websocket_api_connection::~websocket_api_connection()
 websocket_api_connection::websocket_api_connection( fc::http::websocket_connection& c, uint32_t max_depth )
    : api_connection(max_depth),_connection(c)
 {
-   _rpc_state.add_method( "call", [this]( const variants& args ) -> variant
-   {
-      FC_ASSERT( args.size() == 3 && args[2].is_array() );
-      api_id_type api_id;
-      if( args[0].is_string() )
-      {
-         variant subresult = this->receive_call( 1, args[0].as_string() );
-         api_id = subresult.as_uint64();
-      }
-      else
-         api_id = args[0].as_uint64();
-
-      return this->receive_call(
-         api_id,
-         args[1].as_string(),
-         args[2].get_array() );
-   } );
+   _client = api_metrics::client_name( _connection.get_request_header( "X-Forwarded-For" ),
+                                       _connection.get_remote_endpoint_string() );
 
    _rpc_state.add_method( "notice", [this]( const variants& args ) -> variant
    {
@@ -88,71 +83,150 @@ std::string websocket_api_connection::on_message(
 {
    try
    {
-      auto var = fc::json::from_string(message, fc::json::legacy_parser, _max_conversion_depth);
-      const auto& var_obj = var.get_object();
+      auto var = fc::json::from_string(message, fc::json::insitu_parser, _max_conversion_depth);
 
-      if( var_obj.contains( "method" ) )
+      std::string reply;
+      if( var.is_array() )
       {
-         auto call = var.as<fc::rpc::request>(_max_conversion_depth);
-         exception_ptr optexcept;
-         try
+         // a JSON-RPC 2.0 batch: the calls run in order and their replies go back in one array
+         // an empty or oversized batch is refused as a whole with a single error reply
+         const auto& batch = var.get_array();
+         if( batch.empty() )
+            reply = invalid_request_reply( "Invalid Request" );
+         else if( batch.size() > max_batch_size )
+            reply = invalid_request_reply( "Batch of " + std::to_string( batch.size() ) + " requests exceeds the limit of "
+                                           + std::to_string( max_batch_size ) );
+         else
          {
-            try
+            for( const auto& item : batch )
             {
-#ifdef LOG_LONG_API
-               auto start = time_point::now();
-#endif
-
-               auto result = _rpc_state.local_call( call.method, call.params );
-
-#ifdef LOG_LONG_API
-               auto end = time_point::now();
-
-               if( end - start > fc::milliseconds( LOG_LONG_API_MAX_MS ) )
-                  elog( "API call execution time limit exceeded. method: ${m} params: ${p} time: ${t}", ("m",call.method)("p",call.params)("t", end - start) );
-               else if( end - start > fc::milliseconds( LOG_LONG_API_WARN_MS ) )
-                  wlog( "API call execution time nearing limit. method: ${m} params: ${p} time: ${t}", ("m",call.method)("p",call.params)("t", end - start) );
-#endif
-
-               if( call.id )
+               std::string item_reply;
+               try
+               {
+                  if( !item.is_object() )
+                     item_reply = invalid_request_reply( "Invalid Request" );
+                  else
+                     item_reply = handle_message( item );
+               }
+               catch ( const fc::exception& e )
                {
-                  auto reply = fc::json::to_string( response( *call.id, result, "2.0" ), fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
-                  if( send_message )
-                     _connection.send_message( reply );
-                  return reply;
+                  // failed calls are answered by handle_message, what escapes it is an entry that cannot be converted
+                  item_reply = invalid_request_reply( e.to_string() );
                }
+               if( item_reply.empty() )
+                  continue;
+               reply += reply.empty() ? '[' : ',';
+               reply += item_reply;
             }
-            FC_CAPTURE_AND_RETHROW( (call.method)(call.params) )
+            if( !reply.empty() )
+               reply += ']';
          }
-         catch ( const fc::exception& e )
+      }
+      else
+         reply = handle_message( var );
+
+      if( !reply.empty() && send_message )
+         _connection.send_message( reply );
+      return reply;
+   }
+   catch ( const fc::exception& e )
+   {
+      wdump((e.to_detail_string()));
+      return e.to_detail_string();
+   }
+}
+
+std::string websocket_api_connection::handle_message( const variant& var )
+{
+   const auto& var_obj = var.get_object();
+
+   if( var_obj.contains( "method" ) )
+   {
+      auto call = var.as<fc::rpc::request>(_max_conversion_depth);
+      const std::string method = api_metrics::method_name( call, *this );
+      exception_ptr optexcept;
+      auto start = time_point::now();
+      try
+      {
+         try
          {
+            api_rate_limiter::instance().start_call( _client, _budget, method );
+            auto charge_time = fc::make_scoped_exit( [this,start]() {
+               api_rate_limiter::instance().finish_call( _client, _budget, time_point::now() - start );
+            });
+
+            // the result is written straight into the reply, without an intermediate variant
+            std::string reply;
+            json_writer out( reply, fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
             if( call.id )
             {
-               optexcept = e.dynamic_copy_exception();
+               reply += "{\"id\":";
+               out.write( int64_t( *call.id ) );
+               reply += ",\"jsonrpc\":\"2.0\",\"result\":";
             }
-         }
-         if( optexcept ) {
 
-               auto reply = fc::json::to_string( variant(response( *call.id, error_object{ 1, optexcept->to_string(), fc::variant(*optexcept, _max_conversion_depth)}, "2.0" ), _max_conversion_depth ),
-                                                 fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
-               if( send_message )
-                  _connection.send_message( reply );
+            auto invoke = [this,&call,&out]() { write_call_result( call, out ); };
+            if( _call_executor )
+               _call_executor( method, invoke );
+            else
+               invoke();
 
+            if( call.id )
+               reply += '}';
+            api_metrics::instance().record( _client, method, call.params,
+                                            time_point::now() - start, reply.size(), false );
+            if( call.id )
                return reply;
          }
+         FC_CAPTURE_AND_RETHROW( (call.method)(call.params) )
       }
-      else
+      catch ( const fc::exception& e )
       {
-         auto reply = var.as<fc::rpc::response>(_max_conversion_depth);
-         _rpc_state.handle_reply( reply );
+         if( call.id )
+         {
+            optexcept = e.dynamic_copy_exception();
+         }
+         else
+            api_metrics::instance().record( _client, method, call.params,
+                                            time_point::now() - start, 0, true );
+      }
+      if( optexcept ) {
+
+            auto reply = fc::json::to_string( variant(response( *call.id, error_object{ 1, optexcept->to_string(), fc::variant(*optexcept, _max_conversion_depth)}, "2.0" ), _max_conversion_depth ),
+                                              fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
+            api_metrics::instance().record( _client, method, call.params,
+                                            time_point::now() - start, reply.size(), true );
+            return reply;
       }
    }
-   catch ( const fc::exception& e )
+   else
    {
-      wdump((e.to_detail_string()));
-      return e.to_detail_string();
+      auto reply = var.as<fc::rpc::response>(_max_conversion_depth);
+      _rpc_state.handle_reply( reply );
    }
    return string();
 }
 
+void websocket_api_connection::write_call_result( const request& call, json_writer& out )
+{
+   if( call.method != "call" )
+   {
+      out.write( _rpc_state.local_call( call.method, call.params ) );
+      return;
+   }
+
+   const auto& args = call.params;
+   FC_ASSERT( args.size() == 3 && args[2].is_array() );
+   api_id_type api_id;
+   if( args[0].is_string() )
+   {
+      variant subresult = this->receive_call( 1, args[0].as_string() );
+      api_id = subresult.as_uint64();
+   }
+   else
+      api_id = args[0].as_uint64();
+
+   this->receive_call( api_id, args[1].as_string(), args[2].get_array(), out );
+}
+
 } } // namespace fc::rpc
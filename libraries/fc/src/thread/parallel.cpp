@@ -30,6 +30,8 @@
 #include <boost/atomic/atomic.hpp>
 #include <boost/lockfree/queue.hpp>
 
+#include <memory>
+
 namespace fc {
    namespace detail {
       class idle_notifier_impl : public thread_idle_notifier
@@ -60,6 +62,12 @@ namespace fc {
          boost::atomic<bool> is_idle;
       };
 
+      /**
+       *  Every worker has its own queue. Tasks posted by a worker, typically parts of the task it is
+       *  running, go to its own queue, all others to the shared queue. A worker that runs out of work
+       *  takes tasks from its own queue, then from the shared queue, then steals from the other
+       *  workers, and only then waits to be handed a task by post().
+       */
       class pool_impl
       {
       public:
@@ -67,11 +75,13 @@ namespace fc {
             : idle_threads( 2 * num_threads ), waiting_tasks( 200 )
          {
             notifiers.resize( num_threads );
+            local_tasks.reserve( num_threads );
             threads.reserve( num_threads );
             for( uint32_t i = 0; i < num_threads; i++ )
             {
                notifiers[i].id = i;
                notifiers[i].my_pool = this;
+               local_tasks.emplace_back( new boost::lockfree::queue<task_base*>( 64 ) );
                threads.push_back( new thread( "pool worker " + fc::to_string(i), &notifiers[i] ) );
             }
          }
@@ -79,11 +89,16 @@ namespace fc {
          {
             for( thread* t : threads)
                delete t; // also calls quit()
-            waiting_tasks.consume_all( [] ( task_base* t ) {
+            auto cancel = [] ( task_base* t ) {
                t->cancel( "thread pool quitting" );
-            });
+            };
+            waiting_tasks.consume_all( cancel );
+            for( auto& queue : local_tasks )
+               queue->consume_all( cancel );
          }
 
+         uint16_t num_threads()const { return threads.size(); }
+
          thread* post( task_base* task )
          {
             idle_notifier_impl* ini;
@@ -98,31 +113,52 @@ namespace fc {
                { // minor race condition here, a thread might receive a task while it's busy
                   return threads[ini->id];
                }
-            while( !waiting_tasks.push( task ) )
+            auto& queue = current_worker && current_worker->my_pool == this ? *local_tasks[current_worker->id]
+                                                                             : waiting_tasks;
+            while( !queue.push( task ) )
                elog( "Worker pool internal error" );
             return 0;
          }
 
-         task_base* enqueue_idle_thread( idle_notifier_impl* ini )
+         task_base* next_task( uint32_t id )
          {
             task_base* task;
-            if( waiting_tasks.pop( task ) )
+            if( local_tasks[id]->pop( task ) || waiting_tasks.pop( task ) )
+               return task;
+            for( uint32_t i = 1; i < local_tasks.size(); i++ )
+               if( local_tasks[ (id + i) % local_tasks.size() ]->pop( task ) )
+                  return task;
+            return 0;
+         }
+
+         task_base* enqueue_idle_thread( idle_notifier_impl* ini )
+         {
+            current_worker = ini;
+            task_base* task = next_task( ini->id );
+            if( task )
                return task;
             fc::unique_lock<fc::spin_yield_lock> lock(pool_lock);
-            if( waiting_tasks.pop( task ) )
+            task = next_task( ini->id );
+            if( task )
                return task;
             while( !idle_threads.push( ini ) )
                elog( "Worker pool internal error" );
             return 0;
          }
       private:
+         /** the worker running on this thread, if any */
+         static thread_local idle_notifier_impl*        current_worker;
+
          std::vector<idle_notifier_impl>                notifiers;
+         std::vector<std::unique_ptr<boost::lockfree::queue<task_base*>>> local_tasks;
          std::vector<thread*>                           threads;
          boost::lockfree::queue<idle_notifier_impl*>    idle_threads;
          boost::lockfree::queue<task_base*>             waiting_tasks;
          fc::spin_yield_lock                            pool_lock;
       };
 
+      thread_local idle_notifier_impl* pool_impl::current_worker = nullptr;
+
       task_base* idle_notifier_impl::idle()
       {
          is_idle.store( true );
@@ -142,6 +178,11 @@ namespace fc {
          delete my;
       }
 
+      uint16_t worker_pool::num_threads()const
+      {
+         return my->num_threads();
+      }
+
       void worker_pool::post( task_base* task )
       {
          thread* worker = my->post( task );
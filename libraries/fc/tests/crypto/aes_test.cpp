@@ -67,4 +67,44 @@ BOOST_AUTO_TEST_CASE(aes_test)
 //    BOOST_CHECK( !memcmp( dcrypt.data(), data.data(), len) );
 }
 
+BOOST_AUTO_TEST_CASE(aes_gcm_test)
+{
+    fc::sha256 key = fc::sha256::hash( std::string("hello") );
+    fc::aes_gcm_encoder enc;
+    fc::aes_gcm_decoder dec;
+    enc.init( key );
+    dec.init( key );
+
+    std::string header( "header" );
+    std::string body( 1000, 'x' );
+    for( int i = 0; i < 3; ++i )
+    {
+        // header and body are encoded separately, but authenticated as one message
+        std::vector<char> crypt( header.size() + body.size() );
+        char tag[fc::aes_gcm_encoder::tag_size];
+        enc.begin_message();
+        enc.encode( header.data(), header.size(), crypt.data() );
+        enc.encode( body.data(), body.size(), crypt.data() + header.size() );
+        enc.end_message( tag );
+        BOOST_CHECK( memcmp( crypt.data() + header.size(), body.data(), body.size() ) );
+
+        std::vector<char> plain( crypt.size() );
+        dec.begin_message();
+        dec.decode( crypt.data(), crypt.size(), plain.data() );
+        dec.end_message( tag );
+        BOOST_CHECK( std::string( plain.begin(), plain.end() ) == header + body );
+    }
+
+    // a flipped bit fails authentication
+    std::vector<char> crypt( body.size() );
+    char tag[fc::aes_gcm_encoder::tag_size];
+    enc.begin_message();
+    enc.encode( body.data(), body.size(), crypt.data() );
+    enc.end_message( tag );
+    crypt[500] ^= 1;
+    dec.begin_message();
+    dec.decode( crypt.data(), crypt.size(), crypt.data() );
+    BOOST_CHECK_THROW( dec.end_message( tag ), fc::aes_exception );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,9 +8,45 @@
 #include <fc/io/fstream.hpp>
 #include <fc/io/iostream.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_writer.hpp>
 #include <fc/io/sstream.hpp>
+#include <fc/container/flat.hpp>
 
 #include <fstream>
+#include <random>
+
+namespace fc { namespace test {
+   enum json_writer_color { red, green };
+
+   struct json_writer_inner
+   {
+      int32_t      small = -5;
+      uint64_t     big = 5000000000ULL;
+      int64_t      negative = -5000000000LL;
+      std::string  text = "q\"\\\n\x01\x7f";
+   };
+
+   struct json_writer_outer
+   {
+      std::vector<json_writer_inner>                  items = std::vector<json_writer_inner>( 2 );
+      fc::optional<int32_t>                           unset;
+      fc::optional<json_writer_inner>                 set = json_writer_inner();
+      std::map<std::string,uint32_t>                  by_name = { {"x",1}, {"y",2} };
+      fc::static_variant<int64_t,json_writer_inner>   choice = json_writer_inner();
+      json_writer_color                               color = green;
+      bool                                            flag = true;
+      double                                          ratio = 1.5;
+      std::vector<char>                               blob = { 'a', 'b' };
+      fc::flat_set<uint16_t>                          numbers = { 3, 1 };
+      fc::variant                                     var = fc::variant( "hi" );
+      std::pair<int32_t,std::string>                  pair = { 1, "z" };
+      fc::variants                                    vars = { fc::variant( 1 ), fc::variant() };
+   };
+} }
+
+FC_REFLECT_ENUM( fc::test::json_writer_color, (red)(green) )
+FC_REFLECT( fc::test::json_writer_inner, (small)(big)(negative)(text) )
+FC_REFLECT( fc::test::json_writer_outer, (items)(unset)(set)(by_name)(choice)(color)(flag)(ratio)(blob)(numbers)(var)(pair)(vars) )
 
 BOOST_AUTO_TEST_SUITE(json_tests)
 
@@ -23,12 +59,15 @@ static void replace_some( std::string& str )
 
 static void test_fail_string( const std::string& str )
 {
-   try {
-      fc::json::from_string( str );
-      BOOST_FAIL( "json::from_string('" + str + "') failed" );
-   } catch( const fc::parse_error_exception& ) { // ignore, ok
-   } catch( const fc::eof_exception& ) { // ignore, ok
-   } FC_CAPTURE_LOG_AND_RETHROW( ("json::from_string failed")(str) )
+   for( auto ptype : { fc::json::legacy_parser, fc::json::insitu_parser } )
+   {
+      try {
+         fc::json::from_string( str, ptype );
+         BOOST_FAIL( "json::from_string('" + str + "') failed" );
+      } catch( const fc::parse_error_exception& ) { // ignore, ok
+      } catch( const fc::eof_exception& ) { // ignore, ok
+      } FC_CAPTURE_LOG_AND_RETHROW( ("json::from_string failed")(str)((int)ptype) )
+   }
 }
 
 static void test_fail_stream( const std::string& str )
@@ -198,6 +237,10 @@ static void test_recursive( const fc::variant& v )
 
    BOOST_CHECK( equal( v, fc::json::from_string( json + " " ) ) );
    BOOST_CHECK( equal( v, fc::json::from_string( pretty + " " ) ) );
+   BOOST_CHECK( equal( v, fc::json::from_string( json + " ", fc::json::insitu_parser ) ) );
+   BOOST_CHECK( equal( v, fc::json::from_string( pretty + " ", fc::json::insitu_parser ) ) );
+   BOOST_CHECK( fc::json::is_valid( json, fc::json::insitu_parser ) );
+   BOOST_CHECK( !fc::json::is_valid( json + " ", fc::json::insitu_parser ) );
    BOOST_CHECK( equal( v, fc::json::from_file( file.path() ) ) );
 
    if( v.get_type() == fc::variant::type_id::array_type )
@@ -326,12 +369,111 @@ BOOST_AUTO_TEST_CASE(recursion_test)
    std::string ten_levels = "[[[[[[[[[[]]]]]]]]]]";
    fc::variant nested = fc::json::from_string( ten_levels );
    BOOST_CHECK_THROW( fc::json::from_string( ten_levels, fc::json::legacy_parser, 9 ), fc::parse_error_exception );
+   BOOST_CHECK_THROW( fc::json::from_string( ten_levels, fc::json::insitu_parser, 9 ), fc::parse_error_exception );
+   BOOST_CHECK_EQUAL( ten_levels, fc::json::to_string( fc::json::from_string( ten_levels, fc::json::insitu_parser, 10 ) ) );
 
    std::string back = fc::json::to_string( nested );
    BOOST_CHECK_EQUAL( ten_levels, back );
    BOOST_CHECK_THROW( fc::json::to_string( nested, fc::json::stringify_large_ints_and_doubles, 9 ), fc::assert_exception );
 }
 
+BOOST_AUTO_TEST_CASE(json_writer_test)
+{
+   fc::test::json_writer_outer outer;
+   for( auto format : { fc::json::stringify_large_ints_and_doubles, fc::json::legacy_generator } )
+   {
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( outer, 20 ), format, 20 ),
+                         fc::json_writer::to_string( outer, format, 20 ) );
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( outer.items, 20 ), format, 20 ),
+                         fc::json_writer::to_string( outer.items, format, 20 ) );
+   }
+
+   std::string ten_levels = "[[[[[[[[[[]]]]]]]]]]";
+   fc::variant nested = fc::json::from_string( ten_levels );
+   BOOST_CHECK_EQUAL( ten_levels, fc::json_writer::to_string( nested ) );
+   BOOST_CHECK_THROW( fc::json_writer::to_string( nested, fc::json::stringify_large_ints_and_doubles, 9 ), fc::assert_exception );
+}
+
+/** parses str with both parsers and checks they agree on the result or on the kind of error */
+static void compare_parsers( const std::string& str )
+{
+   std::string legacy;
+   std::string insitu;
+   try {
+      legacy = fc::json::to_string( fc::json::from_string( str, fc::json::legacy_parser, 20 ) );
+   } catch( const fc::exception& e ) {
+      legacy = "error " + fc::to_string( e.code() );
+   }
+   try {
+      insitu = fc::json::to_string( fc::json::from_string( str, fc::json::insitu_parser, 20 ) );
+   } catch( const fc::exception& e ) {
+      insitu = "error " + fc::to_string( e.code() );
+   }
+   BOOST_CHECK_MESSAGE( legacy == insitu, "'" + str + "': legacy " + legacy + ", insitu " + insitu );
+}
+
+BOOST_AUTO_TEST_CASE(insitu_parser_test)
+{
+   std::vector<std::string> tests
+   {
+      "", " ", "\"\"", "\"abc\"", "\"a\\tb\\\\c\\\"d\\u0041\"", "\"a\\", "\"abc", "\"a\x04\"",
+      "0", "-", ".", "-.", "1.5", "1..5", "-12", "18446744073709551615", "12abc", "1 2", "-x",
+      "null", "true", "false", "nul", "nullx", "tru e", "fals", "trueee", "n",
+      "[]", "[1,2,,3]", "[1 2]", "[1", "{}", "{\"a\":1,\"b\":[true,null]}", "{\"a\" 1}", "{\"a\":}",
+      "{\"a\":1,}", "{a:1}", std::string( "\0", 1 ), std::string( "[\0]", 3 ), "\x04", "@", "\xff"
+   };
+   for( const auto& test : tests )
+      compare_parsers( test );
+
+   // mutations of a document that exercises every kind of token
+   const std::string doc = "{\"id\":7,\"method\":\"call\",\"params\":[0,\"get_objects\",[[\"1.2.0\",\"esc\\\"aped\"]]],"
+                           "\"x\":[-1.25,true,false,null,{}],\"y\":\"\"}";
+   const std::string alphabet = std::string( "{}[]\",:\\ -.0123456789ntrueflsx\x04" ) + std::string( "\0", 1 );
+   std::mt19937 rng( 4711 );
+   for( int i = 0; i < 5000; i++ )
+   {
+      std::string test = doc;
+      for( int changes = 1 + rng() % 3; changes > 0 && !test.empty(); --changes )
+      {
+         size_t pos = rng() % test.size();
+         switch( rng() % 3 )
+         {
+            case 0: test[pos] = alphabet[ rng() % alphabet.size() ]; break;
+            case 1: test.erase( pos, 1 ); break;
+            default: test.resize( pos ); break;
+         }
+      }
+      compare_parsers( test );
+   }
+   for( int i = 0; i < 5000; i++ )
+   {
+      std::string test( rng() % 16, ' ' );
+      for( char& c : test )
+         c = alphabet[ rng() % alphabet.size() ];
+      compare_parsers( test );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(insitu_parser_benchmark)
+{
+   fc::mutable_variant_object obj;
+   obj( "id", 12345 )( "name", "some-account-name" )( "balance", int64_t(-5000000000LL) )
+      ( "ratio", 0.25 )( "flags", fc::variants{ fc::variant( true ), fc::variant( false ), fc::variant() } )
+      ( "memo", "a longer text with \"escapes\" and\nline breaks that does not fit a small string" );
+   fc::variants items( 200, fc::variant( obj ) );
+   const std::string json = fc::json::to_string( fc::variant( items ) );
+
+   for( auto ptype : { fc::json::legacy_parser, fc::json::insitu_parser } )
+   {
+      fc::time_point start = fc::time_point::now();
+      for( int i = 0; i < 100; i++ )
+         BOOST_CHECK_EQUAL( 200u, fc::json::from_string( json, ptype ).get_array().size() );
+      fc::time_point end = fc::time_point::now();
+      ilog( "parsed ${n} bytes 100 times with parser ${p} in ${t}µs",
+            ("n",json.size())("p",int(ptype))("t",(end-start).count()) );
+   }
+}
+
 BOOST_AUTO_TEST_CASE(rethrow_test)
 {
    fc::variants biggie;
@@ -16,6 +16,8 @@
 #include <thread>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(logging_tests)
 
@@ -69,4 +71,54 @@ BOOST_AUTO_TEST_CASE(log_reboot)
     BOOST_TEST_MESSAGE("Loop complete");
 }
 
+BOOST_AUTO_TEST_CASE(async_file_appender)
+{
+    fc::path log_file = fc::temp_directory_path() / "async_file_appender.log";
+    fc::remove_all( log_file );
+
+    fc::file_appender::config conf( log_file );
+    conf.async = true;
+    conf.queue_size = 1 << 16;
+
+    const int threads = 4;
+    const int messages = 10000;
+    {
+        fc::appender::ptr fa = fc::appender::create( "async", "file", fc::variant( conf, 10 ) );
+        fc::time_point start = fc::time_point::now();
+        std::vector<std::thread> writers;
+        for( int t = 0; t < threads; ++t )
+            writers.emplace_back( [fa,t]() {
+                for( int i = 0; i < messages; ++i )
+                {
+                    fc::log_context ctx( fc::log_level::info, "async.cpp", i, "writer()" );
+                    fa->log( fc::log_message( ctx, "${t}:${i}", fc::mutable_variant_object("t",t)("i",i) ) );
+                }
+            });
+        for( auto& w : writers )
+            w.join();
+        ilog( "queued ${n} messages in ${us} us", ("n",threads*messages)("us",(fc::time_point::now() - start).count()) );
+    }
+    // destroying the appender drains the queue
+    fc::configure_logging( fc::logging_config::default_config() );
+
+    std::string contents;
+    fc::read_file_contents( log_file, contents );
+    std::istringstream lines( contents );
+    std::vector<int> next( threads, 0 );
+    std::string line;
+    while( std::getline( lines, line ) )
+    {
+        auto pos = line.find( "] " );
+        BOOST_REQUIRE( pos != std::string::npos );
+        int t, i;
+        BOOST_REQUIRE( sscanf( line.c_str() + pos + 2, "%d:%d", &t, &i ) == 2 );
+        BOOST_REQUIRE( t >= 0 && t < threads );
+        // nothing is dropped with a queue this large, and each thread's messages stay in order
+        BOOST_CHECK_EQUAL( i, next[t] );
+        next[t] = i + 1;
+    }
+    for( int t = 0; t < threads; ++t )
+        BOOST_CHECK_EQUAL( next[t], messages );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -1,9 +1,35 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/network/http/websocket.hpp>
+#include <fc/rpc/http_api.hpp>
+#include <fc/rpc/websocket_api.hpp>
 
 #include <iostream>
 
+namespace fc { namespace test {
+   class batch_calculator
+   {
+      public:
+         int32_t add( int32_t a, int32_t b ) { return a + b; }
+         int32_t fail() { FC_THROW( "failed on purpose" ); }
+         void    note( int32_t a ) { noted += a; }
+         int32_t noted = 0;
+   };
+
+   /** records what the API connection sends instead of talking to a socket */
+   class recording_connection : public fc::http::websocket_connection
+   {
+      public:
+         virtual void send_message( const std::string& message )override { sent.push_back( message ); }
+         virtual void send_binary_message( const std::string& message )override { sent.push_back( message ); }
+         virtual std::string get_request_header( const std::string& key )override { return std::string(); }
+         virtual std::string get_remote_endpoint_string()override { return "127.0.0.1:1234"; }
+         std::vector<std::string> sent;
+   };
+} }
+
+FC_API( fc::test::batch_calculator, (add)(fail)(note) )
+
 BOOST_AUTO_TEST_SUITE(fc_network)
 
 BOOST_AUTO_TEST_CASE(websocket_test)
@@ -89,4 +115,272 @@ BOOST_AUTO_TEST_CASE(websocket_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(websocket_deflate_test)
+{
+    fc::http::websocket_compression compression;
+    compression.enabled = true;
+    compression.level = 9;
+    fc::http::set_server_compression( compression );
+    fc::http::set_client_compression( compression );
+
+    fc::http::websocket_client client;
+    fc::http::websocket_connection_ptr s_conn;
+    fc::http::websocket_server server;
+    server.on_connection([&]( const fc::http::websocket_connection_ptr& c ){
+            s_conn = c;
+            c->on_message_handler([&](const std::string& s){
+                s_conn->send_message("echo: " + s);
+            });
+        });
+
+    int port;
+    bool listen_ok = false;
+    for( int i = 0; !listen_ok && i < 5; ++i )
+    {
+       port = std::rand() % 50000 + 10000;
+       try
+       {
+          server.listen( port );
+          listen_ok = true;
+       }
+       catch( std::exception& ignore )
+       {
+       }
+    }
+    BOOST_REQUIRE( listen_ok );
+    server.start_accept();
+
+    std::string echo;
+    auto c_conn = client.connect( "ws://localhost:" + fc::to_string(port) );
+    c_conn->on_message_handler([&](const std::string& s){
+                echo = s;
+            });
+    bool server_closed = false;
+    c_conn->send_message( "hello" );
+    fc::usleep( fc::seconds(1) );
+    BOOST_REQUIRE( s_conn );
+    s_conn->closed.connect( [&server_closed](){ server_closed = true; } );
+    BOOST_CHECK( c_conn->is_compressed() );
+    BOOST_CHECK( s_conn->is_compressed() );
+
+    // short messages go out uncompressed, long ones compressed, in both directions
+    c_conn->send_message( "hello world" );
+    fc::usleep( fc::seconds(1) );
+    BOOST_CHECK_EQUAL("echo: hello world", echo);
+
+    std::string big;
+    for( int i = 0; i < 10000; ++i )
+       big += "{\"id\":" + fc::to_string(i) + ",\"method\":\"call\"}";
+    c_conn->send_message( big );
+    fc::usleep( fc::seconds(1) );
+    BOOST_CHECK( "echo: " + big == echo );
+
+    // a message that only inflates past the size limit of the connection closes it
+    c_conn->send_message( std::string( 33000000, 'a' ) );
+    fc::usleep( fc::seconds(2) );
+    BOOST_CHECK( "echo: " + big == echo );
+    BOOST_CHECK( server_closed );
+
+    fc::http::set_server_compression( fc::http::websocket_compression() );
+    fc::http::set_client_compression( fc::http::websocket_compression() );
+}
+
+BOOST_AUTO_TEST_CASE(websocket_api_batch_test)
+{
+   fc::test::recording_connection con;
+   auto wsc = std::make_shared<fc::rpc::websocket_api_connection>( con, 10 );
+   wsc->register_api( fc::api<fc::test::batch_calculator>( std::make_shared<fc::test::batch_calculator>() ) );
+
+   con.on_message( "{\"id\":1,\"method\":\"add\",\"params\":[1,2]}" );
+   BOOST_REQUIRE_EQUAL( 1u, con.sent.size() );
+   BOOST_CHECK_EQUAL( "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":3}", con.sent[0] );
+
+   // replies come back in order, in one message, skipping notifications and reporting failures in place
+   con.on_message( "[{\"id\":2,\"method\":\"add\",\"params\":[2,2]},"
+                   "{\"method\":\"add\",\"params\":[0,0]},"
+                   "{\"id\":3,\"method\":\"fail\",\"params\":[]},"
+                   "{\"id\":4,\"method\":\"call\",\"params\":[0,\"add\",[3,4]]}]" );
+   BOOST_REQUIRE_EQUAL( 2u, con.sent.size() );
+   fc::variants replies = fc::json::from_string( con.sent[1] ).get_array();
+   BOOST_REQUIRE_EQUAL( 3u, replies.size() );
+   BOOST_CHECK_EQUAL( 2, replies[0]["id"].as_int64() );
+   BOOST_CHECK_EQUAL( 4, replies[0]["result"].as_int64() );
+   BOOST_CHECK_EQUAL( 3, replies[1]["id"].as_int64() );
+   BOOST_CHECK( replies[1].get_object().contains( "error" ) );
+   BOOST_CHECK_EQUAL( 4, replies[2]["id"].as_int64() );
+   BOOST_CHECK_EQUAL( 7, replies[2]["result"].as_int64() );
+
+   // entries with fields of the wrong type get an invalid request error, the rest of the batch still runs
+   con.on_message( "[{\"id\":5,\"method\":\"add\",\"params\":5},"
+                   "{\"id\":6,\"method\":{},\"params\":[]},"
+                   "{\"id\":7,\"method\":\"add\",\"params\":[1,1]}]" );
+   BOOST_REQUIRE_EQUAL( 3u, con.sent.size() );
+   replies = fc::json::from_string( con.sent[2] ).get_array();
+   BOOST_REQUIRE_EQUAL( 3u, replies.size() );
+   BOOST_CHECK( replies[0]["id"].is_null() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, replies[0]["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, replies[1]["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( 7, replies[2]["id"].as_int64() );
+   BOOST_CHECK_EQUAL( 2, replies[2]["result"].as_int64() );
+
+   // a batch of notifications has no reply at all
+   con.on_message( "[{\"method\":\"add\",\"params\":[0,0]}]" );
+   BOOST_CHECK_EQUAL( 3u, con.sent.size() );
+
+   // empty batches and batches longer than the limit are refused as a whole with one error
+   con.on_message( "[]" );
+   BOOST_REQUIRE_EQUAL( 4u, con.sent.size() );
+   fc::variant reply = fc::json::from_string( con.sent[3] );
+   BOOST_REQUIRE( reply.is_object() );
+   BOOST_CHECK( reply["id"].is_null() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, reply["error"]["code"].as_int64() );
+
+   std::string batch = "[";
+   for( size_t i = 0; i <= fc::rpc::max_batch_size; ++i )
+      batch += std::string( i ? "," : "" ) + "{\"id\":" + std::to_string( i ) + ",\"method\":\"add\",\"params\":[1,1]}";
+   batch += "]";
+   con.on_message( batch );
+   BOOST_REQUIRE_EQUAL( 5u, con.sent.size() );
+   reply = fc::json::from_string( con.sent[4] );
+   BOOST_REQUIRE( reply.is_object() );
+   BOOST_CHECK( reply["id"].is_null() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, reply["error"]["code"].as_int64() );
+}
+
+BOOST_AUTO_TEST_CASE(http_api_batch_test)
+{
+   auto calc = std::make_shared<fc::test::batch_calculator>();
+   auto http = std::make_shared<fc::rpc::http_api_connection>( 10 );
+   http->register_api( fc::api<fc::test::batch_calculator>( calc ) );
+
+   // notifications run but get no entry, entries that are no request objects get an invalid request error
+   std::string body = "[{\"id\":1,\"method\":\"add\",\"params\":[1,2]},"
+                      "{\"method\":\"note\",\"params\":[5]},"
+                      "7,"
+                      "{\"id\":2,\"method\":\"fail\",\"params\":[]},"
+                      "{\"id\":3,\"params\":[]},"
+                      "{\"id\":4,\"method\":\"call\",\"params\":[0,\"add\",[3,4]]}]";
+   std::string reply;
+   BOOST_CHECK_EQUAL( fc::http::reply::OK, http->handle_body( body, "127.0.0.1", reply ) );
+   BOOST_CHECK_EQUAL( 5, calc->noted );
+   fc::variants replies = fc::json::from_string( reply ).get_array();
+   BOOST_REQUIRE_EQUAL( 5u, replies.size() );
+   BOOST_CHECK_EQUAL( 3, replies[0]["result"].as_int64() );
+   BOOST_CHECK( replies[1]["id"].is_null() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, replies[1]["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( 2, replies[2]["id"].as_int64() );
+   BOOST_CHECK( replies[2].get_object().contains( "error" ) );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, replies[3]["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( 7, replies[4]["result"].as_int64() );
+
+   // entries with fields of the wrong type get an invalid request error, the rest of the batch still runs
+   body = "[{\"id\":5,\"method\":\"add\",\"params\":5},"
+          "{\"id\":6,\"method\":{},\"params\":[]},"
+          "{\"id\":7,\"method\":\"add\",\"params\":[1,1]}]";
+   reply.clear();
+   BOOST_CHECK_EQUAL( fc::http::reply::OK, http->handle_body( body, "127.0.0.1", reply ) );
+   replies = fc::json::from_string( reply ).get_array();
+   BOOST_REQUIRE_EQUAL( 3u, replies.size() );
+   BOOST_CHECK( replies[0]["id"].is_null() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, replies[0]["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, replies[1]["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( 7, replies[2]["id"].as_int64() );
+   BOOST_CHECK_EQUAL( 2, replies[2]["result"].as_int64() );
+   body = "{\"id\":8,\"method\":\"add\",\"params\":5}";
+   reply.clear();
+   BOOST_CHECK_EQUAL( fc::http::reply::BadRequest, http->handle_body( body, "127.0.0.1", reply ) );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, fc::json::from_string( reply )["error"]["code"].as_int64() );
+
+   // a single notification and a batch of notifications get no body
+   body = "{\"method\":\"note\",\"params\":[1]}";
+   reply.clear();
+   BOOST_CHECK_EQUAL( fc::http::reply::NoContent, http->handle_body( body, "127.0.0.1", reply ) );
+   BOOST_CHECK( reply.empty() );
+   body = "[{\"method\":\"note\",\"params\":[1]},{\"method\":\"fail\",\"params\":[]}]";
+   BOOST_CHECK_EQUAL( fc::http::reply::NoContent, http->handle_body( body, "127.0.0.1", reply ) );
+   BOOST_CHECK( reply.empty() );
+   BOOST_CHECK_EQUAL( 7, calc->noted );
+
+   // batches longer than the limit are refused as a whole
+   body = "[";
+   for( size_t i = 0; i <= fc::rpc::max_batch_size; ++i )
+      body += std::string( i ? "," : "" ) + "{\"method\":\"note\",\"params\":[1]}";
+   body += "]";
+   BOOST_CHECK_EQUAL( fc::http::reply::BadRequest, http->handle_body( body, "127.0.0.1", reply ) );
+   BOOST_CHECK_EQUAL( fc::rpc::invalid_request_code, fc::json::from_string( reply )["error"]["code"].as_int64() );
+   BOOST_CHECK_EQUAL( 7, calc->noted );
+}
+
+BOOST_AUTO_TEST_CASE(websocket_api_rate_limit_test)
+{
+   fc::rpc::api_rate_limits limits;
+   limits.connection_budget = 3;
+   limits.method_costs["fail"] = 5;
+   fc::rpc::api_rate_limiter::instance().set_limits( limits );
+
+   fc::test::recording_connection con;
+   auto wsc = std::make_shared<fc::rpc::websocket_api_connection>( con, 10 );
+   wsc->register_api( fc::api<fc::test::batch_calculator>( std::make_shared<fc::test::batch_calculator>() ) );
+
+   // more expensive than the whole budget
+   con.on_message( "{\"id\":1,\"method\":\"fail\",\"params\":[]}" );
+   // three calls of cost 1 fit, the fourth does not as nothing is refilled
+   for( int i = 2; i <= 5; i++ )
+      con.on_message( "{\"id\":" + std::to_string(i) + ",\"method\":\"add\",\"params\":[1,2]}" );
+   BOOST_REQUIRE_EQUAL( 5u, con.sent.size() );
+   BOOST_CHECK( con.sent[0].find( "API rate limit exceeded" ) != std::string::npos );
+   BOOST_CHECK_EQUAL( "{\"id\":2,\"jsonrpc\":\"2.0\",\"result\":3}", con.sent[1] );
+   BOOST_CHECK_EQUAL( "{\"id\":4,\"jsonrpc\":\"2.0\",\"result\":3}", con.sent[3] );
+   BOOST_CHECK( con.sent[4].find( "API rate limit exceeded" ) != std::string::npos );
+
+   // a new connection from the same address has its own budget
+   fc::test::recording_connection con2;
+   auto wsc2 = std::make_shared<fc::rpc::websocket_api_connection>( con2, 10 );
+   wsc2->register_api( fc::api<fc::test::batch_calculator>( std::make_shared<fc::test::batch_calculator>() ) );
+   con2.on_message( "{\"id\":1,\"method\":\"add\",\"params\":[1,2]}" );
+   BOOST_REQUIRE_EQUAL( 1u, con2.sent.size() );
+   BOOST_CHECK_EQUAL( "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":3}", con2.sent[0] );
+
+   fc::rpc::api_rate_limiter::instance().set_limits( fc::rpc::api_rate_limits() );
+}
+
+BOOST_AUTO_TEST_CASE(api_rate_limit_clients_test)
+{
+   auto& limiter = fc::rpc::api_rate_limiter::instance();
+   fc::rpc::api_rate_limits limits;
+   limits.client_budget = 2;
+   limiter.set_limits( limits );
+
+   // the busy client spends its budget, then a flood of new addresses passes through
+   fc::rpc::api_budget connection;
+   limiter.start_call( "10.0.0.1", connection, "add" );
+   limiter.start_call( "10.0.0.1", connection, "add" );
+   BOOST_CHECK_THROW( limiter.start_call( "10.0.0.1", connection, "add" ), fc::assert_exception );
+   for( size_t i = 0; i < fc::rpc::api_rate_limiter::max_clients / 2; ++i )
+      limiter.start_call( "flood-" + std::to_string( i ), connection, "add" );
+   // the busy client stays recently used and keeps its empty budget
+   BOOST_CHECK_THROW( limiter.start_call( "10.0.0.1", connection, "add" ), fc::assert_exception );
+   for( size_t i = fc::rpc::api_rate_limiter::max_clients / 2; i < 2 * fc::rpc::api_rate_limiter::max_clients; ++i )
+      limiter.start_call( "flood-" + std::to_string( i ), connection, "add" );
+   BOOST_CHECK_EQUAL( fc::rpc::api_rate_limiter::max_clients, limiter.client_count() );
+
+   limiter.set_limits( fc::rpc::api_rate_limits() );
+}
+
+BOOST_AUTO_TEST_CASE(api_client_name_test)
+{
+   auto& metrics = fc::rpc::api_metrics::instance();
+   metrics.set_trusted_proxies( std::set<std::string>() );
+   BOOST_CHECK_EQUAL( "10.0.0.1", fc::rpc::api_metrics::client_name( "", "10.0.0.1:4321" ) );
+   // nobody is trusted to name the client
+   BOOST_CHECK_EQUAL( "10.0.0.1", fc::rpc::api_metrics::client_name( "1.2.3.4", "10.0.0.1:4321" ) );
+
+   metrics.set_trusted_proxies( { "127.0.0.1" } );
+   BOOST_CHECK_EQUAL( "10.0.0.1", fc::rpc::api_metrics::client_name( "1.2.3.4", "10.0.0.1:4321" ) );
+   BOOST_CHECK_EQUAL( "1.2.3.4", fc::rpc::api_metrics::client_name( "1.2.3.4", "127.0.0.1:4321" ) );
+   // earlier entries come from the client itself, only the one the proxy appended counts
+   BOOST_CHECK_EQUAL( "1.2.3.4", fc::rpc::api_metrics::client_name( "6.6.6.6, 1.2.3.4", "127.0.0.1:4321" ) );
+   metrics.set_trusted_proxies( std::set<std::string>() );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/rpc/api_connection.hpp>
+#include <fc/rpc/api_metrics.hpp>
+
+#include <algorithm>
+
+namespace fc { namespace test {
+   class metrics_calculator
+   {
+      public:
+         int32_t add( int32_t a, int32_t b ) { return a + b; }
+   };
+
+   static fc::rpc::api_call_metrics find_metrics( const std::vector<fc::rpc::api_call_metrics>& all, const std::string& name )
+   {
+      auto itr = std::find_if( all.begin(), all.end(), [&name]( const fc::rpc::api_call_metrics& m ) { return m.name == name; } );
+      BOOST_REQUIRE( itr != all.end() );
+      return *itr;
+   }
+} }
+
+FC_API( fc::test::metrics_calculator, (add) )
+
+using fc::rpc::api_metrics;
+
+BOOST_AUTO_TEST_SUITE(fc_rpc)
+
+BOOST_AUTO_TEST_CASE(api_metrics_percentiles)
+{
+   auto& metrics = api_metrics::instance();
+   metrics.reset();
+
+   // 50 calls in the [8,16) bucket, 40 in [64,128) and 10 in [4096,8192)
+   for( int i = 0; i < 50; ++i )
+      metrics.record( "client", "fast", fc::variants(), fc::microseconds( 10 ), 100, false );
+   for( int i = 0; i < 40; ++i )
+      metrics.record( "client", "fast", fc::variants(), fc::microseconds( 100 ), 100, false );
+   for( int i = 0; i < 10; ++i )
+      metrics.record( "client", "fast", fc::variants(), fc::microseconds( 5000 ), 100, i == 0 );
+
+   auto m = fc::test::find_metrics( metrics.get_method_metrics(), "fast" );
+   BOOST_CHECK_EQUAL( m.calls, 100u );
+   BOOST_CHECK_EQUAL( m.errors, 1u );
+   BOOST_CHECK_EQUAL( m.total_us, 50u * 10 + 40u * 100 + 10u * 5000 );
+   BOOST_CHECK_EQUAL( m.max_us, 5000u );
+   BOOST_CHECK_EQUAL( m.response_bytes, 10000u );
+   // each percentile is the upper end of its bucket
+   BOOST_CHECK_EQUAL( m.p50_us, 15u );
+   BOOST_CHECK_EQUAL( m.p90_us, 127u );
+   // the top bucket reaches 8191, but no call took longer than the maximum
+   BOOST_CHECK_EQUAL( m.p99_us, 5000u );
+
+   // zero length calls land in bucket 0
+   metrics.record( "client", "instant", fc::variants(), fc::microseconds( 0 ), 0, false );
+   auto instant = fc::test::find_metrics( metrics.get_method_metrics(), "instant" );
+   BOOST_CHECK_EQUAL( instant.p50_us, 0u );
+   BOOST_CHECK_EQUAL( instant.p99_us, 0u );
+
+   auto client = fc::test::find_metrics( metrics.get_client_metrics(), "client" );
+   BOOST_CHECK_EQUAL( client.calls, 101u );
+
+   metrics.reset();
+   BOOST_CHECK( metrics.get_method_metrics().empty() );
+   BOOST_CHECK( metrics.get_client_metrics().empty() );
+}
+
+BOOST_AUTO_TEST_CASE(api_metrics_unknown_methods)
+{
+   auto apis = std::make_shared<fc::local_api_connection>( 10 );
+   apis->register_api( fc::api<fc::test::metrics_calculator>( std::make_shared<fc::test::metrics_calculator>() ) );
+
+   fc::rpc::request known{ 1, "call", { fc::variant( 0 ), fc::variant( "add" ), fc::variant( fc::variants() ) } };
+   BOOST_CHECK_EQUAL( api_metrics::method_name( known, *apis ), "add" );
+
+   auto& metrics = api_metrics::instance();
+   metrics.reset();
+   // a client inventing method names does not get an entry per name
+   for( int i = 0; i < 100; ++i )
+   {
+      fc::rpc::request invented{ uint64_t( i ), "call", { fc::variant( 0 ), fc::variant( "no_such_method_" + std::to_string( i ) ),
+                                              fc::variant( fc::variants() ) } };
+      metrics.record( "client", api_metrics::method_name( invented, *apis ), invented.params,
+                      fc::microseconds( 1 ), 0, true );
+   }
+   metrics.record( "client", api_metrics::method_name( known, *apis ), known.params, fc::microseconds( 1 ), 0, false );
+
+   auto methods = metrics.get_method_metrics();
+   BOOST_CHECK_EQUAL( methods.size(), 2u );
+   BOOST_CHECK_EQUAL( fc::test::find_metrics( methods, api_metrics::unknown_method ).calls, 100u );
+   BOOST_CHECK_EQUAL( fc::test::find_metrics( methods, "add" ).calls, 1u );
+   metrics.reset();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
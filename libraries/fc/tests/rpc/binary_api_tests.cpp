@@ -0,0 +1,140 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/rpc/api_connection.hpp>
+#include <fc/rpc/binary_api_connection.hpp>
+#include <fc/rpc/binary_websocket_api.hpp>
+
+namespace fc { namespace test {
+   class binary_calculator
+   {
+      public:
+         int32_t add( int32_t a, int32_t b ) { if( _cb ) _cb( a + b ); return a + b; }
+         void    on_result( const std::function<void(int32_t)>& cb ) { _cb = cb; }
+         std::function<void(int32_t)> _cb;
+   };
+
+   class binary_login
+   {
+      public:
+         fc::api<binary_calculator> get_calc()const { return calc; }
+         fc::api<binary_calculator> calc{ std::make_shared<binary_calculator>() };
+   };
+
+   /** records the binary frames the API connection sends instead of talking to a socket */
+   class binary_recording_connection : public fc::http::websocket_connection
+   {
+      public:
+         virtual void send_message( const std::string& message )override { FC_THROW( "unexpected text frame" ); }
+         virtual void send_binary_message( const std::string& message )override
+         {
+            sent.push_back( fc::raw::unpack<fc::rpc::bmessage>( std::vector<char>( message.begin(), message.end() ) )
+                               .get<fc::rpc::bresponse>() );
+         }
+         virtual std::string get_request_header( const std::string& key )override { return std::string(); }
+         virtual std::string get_remote_endpoint_string()override { return "127.0.0.1:1234"; }
+
+         void receive( const fc::rpc::brequest& request )
+         {
+            auto packed = fc::raw::pack( fc::rpc::bmessage( request ) );
+            on_message( std::string( packed.begin(), packed.end() ) );
+         }
+
+         std::vector<fc::rpc::bresponse> sent;
+   };
+
+   static fc::rpc::brequest add_request( uint64_t id, int32_t a, int32_t b )
+   {
+      auto params = fc::raw::pack( a );
+      auto second = fc::raw::pack( b );
+      params.insert( params.end(), second.begin(), second.end() );
+      return fc::rpc::brequest{ id, "call", fc::raw::pack( fc::rpc::bcall{ 0, "add", params } ) };
+   }
+} }
+
+FC_API( fc::test::binary_calculator, (add)(on_result) )
+FC_API( fc::test::binary_login, (get_calc) )
+
+BOOST_AUTO_TEST_SUITE(fc_rpc)
+
+BOOST_AUTO_TEST_CASE(binary_api_nested_test)
+{
+   auto client_side = std::make_shared<fc::local_binary_api_connection>();
+   auto server_side = std::make_shared<fc::local_binary_api_connection>();
+   server_side->set_remote_connection( client_side );
+   client_side->set_remote_connection( server_side );
+
+   server_side->register_api( fc::api<fc::test::binary_login>( std::make_shared<fc::test::binary_login>() ) );
+
+   auto remote_api = client_side->get_remote_api<fc::test::binary_login>();
+   auto remote_calc = remote_api->get_calc();
+   int32_t called_back = 0;
+   remote_calc->on_result( [&called_back]( int32_t r ) { called_back = r; } );
+   int32_t r = remote_calc->add( 4, 5 );
+   BOOST_CHECK_EQUAL( r, 9 );
+   BOOST_CHECK_EQUAL( called_back, 9 );
+
+   // once the connection is gone, calling back fails instead of crashing
+   auto calc = std::make_shared<fc::test::binary_calculator>();
+   {
+      auto server = std::make_shared<fc::local_binary_api_connection>();
+      auto client = std::make_shared<fc::local_binary_api_connection>();
+      server->set_remote_connection( client );
+      client->set_remote_connection( server );
+      server->register_api( fc::api<fc::test::binary_calculator>( calc ) );
+      client->get_remote_api<fc::test::binary_calculator>()->on_result( []( int32_t ) {} );
+      server->_remote_connection.reset();
+      client->_remote_connection.reset();
+   }
+   BOOST_CHECK_THROW( calc->add( 1, 2 ), fc::eof_exception );
+}
+
+BOOST_AUTO_TEST_CASE(binary_websocket_api_hooks_test)
+{
+   auto& metrics = fc::rpc::api_metrics::instance();
+   metrics.reset();
+   fc::rpc::api_rate_limits limits;
+   limits.connection_budget = 2;
+   fc::rpc::api_rate_limiter::instance().set_limits( limits );
+
+   fc::test::binary_recording_connection con;
+   auto bwsc = std::make_shared<fc::rpc::binary_websocket_api_connection>( con );
+   bwsc->register_api( fc::api<fc::test::binary_calculator>( std::make_shared<fc::test::binary_calculator>() ) );
+   std::vector<std::string> executed;
+   bwsc->set_call_executor( [&executed]( const std::string& method, const std::function<void()>& invoke ) {
+      executed.push_back( method );
+      invoke();
+   } );
+
+   con.receive( fc::test::add_request( 1, 4, 5 ) );
+   // a method the API does not have is counted as unknown and fails
+   con.receive( fc::rpc::brequest{ uint64_t( 2 ), "call", fc::raw::pack( fc::rpc::bcall{ 0, "no_such_method", {} } ) } );
+   // the budget of two calls is spent
+   con.receive( fc::test::add_request( 3, 1, 1 ) );
+
+   BOOST_REQUIRE_EQUAL( 3u, con.sent.size() );
+   BOOST_REQUIRE( con.sent[0].result.valid() );
+   BOOST_CHECK_EQUAL( 9, fc::raw::unpack<int32_t>( *con.sent[0].result ) );
+   BOOST_CHECK( con.sent[1].error.valid() );
+   BOOST_REQUIRE( con.sent[2].error.valid() );
+   BOOST_CHECK( con.sent[2].error->message.find( "API rate limit exceeded" ) != std::string::npos );
+
+   BOOST_REQUIRE_EQUAL( 2u, executed.size() );
+   BOOST_CHECK_EQUAL( "add", executed[0] );
+   BOOST_CHECK_EQUAL( fc::rpc::api_metrics::unknown_method, executed[1] );
+
+   uint64_t add_calls = 0, unknown_calls = 0;
+   for( const auto& m : metrics.get_method_metrics() )
+   {
+      if( m.name == "add" )
+         add_calls = m.calls;
+      else if( m.name == fc::rpc::api_metrics::unknown_method )
+         unknown_calls = m.calls;
+   }
+   BOOST_CHECK_EQUAL( 2u, add_calls );
+   BOOST_CHECK_EQUAL( 1u, unknown_calls );
+
+   metrics.reset();
+   fc::rpc::api_rate_limiter::instance().set_limits( fc::rpc::api_rate_limits() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -34,6 +34,7 @@
 #include <fc/time.hpp>
 
 #include <iostream>
+#include <vector>
 
 struct thread_config {
   thread_config() {
@@ -194,6 +195,89 @@ BOOST_AUTO_TEST_CASE( sign_verify_parallel )
    }
 }
 
+BOOST_AUTO_TEST_CASE( parallel_for_each_index )
+{
+   std::vector<boost::atomic<uint32_t>> calls( 10007 );
+   for( auto& c : calls )
+      c.store( 0 );
+   fc::parallel_for( calls.size(), [&calls] ( size_t i ) { calls[i].fetch_add( 1 ); } );
+   for( const auto& c : calls )
+      BOOST_CHECK_EQUAL( 1u, c.load() );
+
+   fc::parallel_for( 0, [] ( size_t i ) { BOOST_FAIL( "called for an empty range" ); } );
+
+   boost::atomic<uint32_t> done( 0 );
+   BOOST_CHECK_THROW( fc::parallel_for( 1000, [&done] ( size_t i ) {
+                         FC_ASSERT( i != 500 );
+                         done.fetch_add( 1 );
+                      }, 10 ), fc::assert_exception );
+   // the exception is only rethrown once all other chunks are done
+   const uint32_t finished = done.load();
+   BOOST_CHECK( finished < 1000u );
+   fc::usleep( fc::milliseconds( 10 ) );
+   BOOST_CHECK_EQUAL( finished, done.load() );
+}
+
+BOOST_AUTO_TEST_CASE( dispatch_overhead )
+{
+   const size_t count = 20000;
+   {
+      std::vector<fc::future<void>> results;
+      results.reserve( count );
+      fc::time_point start = fc::time_point::now();
+      for( size_t i = 0; i < count; i++ )
+         results.push_back( fc::do_parallel( [] () {} ) );
+      for( auto& result : results )
+         result.wait();
+      fc::time_point end = fc::time_point::now();
+      ilog( "${c} empty tasks on ${n} workers in ${t}µs, ${p}ns per task",
+            ("c",count)("n",fc::parallel_concurrency())("t",end-start)("p",(end-start).count() * 1000 / count) );
+   }
+   {  // tasks that split their work further, the parts land on the queue of their worker
+      boost::atomic<uint32_t> leaves( 0 );
+      fc::time_point start = fc::time_point::now();
+      fc::parallel_for( 100, [&leaves] ( size_t ) {
+         std::vector<fc::future<void>> parts;
+         for( int i = 0; i < 100; i++ )
+            parts.push_back( fc::do_parallel( [&leaves] () { leaves.fetch_add( 1 ); } ) );
+         for( auto& part : parts )
+            part.wait();
+      } );
+      fc::time_point end = fc::time_point::now();
+      BOOST_CHECK_EQUAL( 10000u, leaves.load() );
+      ilog( "${c} nested empty tasks in ${t}µs", ("c",leaves.load())("t",end-start) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( parallel_scaling )
+{
+   const size_t count = 4000;
+   auto work = [] ( size_t i ) {
+      fc::sha256 h = fc::sha256::hash( TEXT + fc::to_string( i ) );
+      for( int r = 0; r < 200; r++ )
+         h = fc::sha256::hash( h );
+      return h;
+   };
+
+   std::vector<fc::sha256> expected( count );
+   fc::time_point start = fc::time_point::now();
+   for( size_t i = 0; i < count; i++ )
+      expected[i] = work( i );
+   const fc::microseconds single = fc::time_point::now() - start;
+
+   for( size_t grain : { size_t(1), size_t(16), size_t(256) } )
+   {
+      std::vector<fc::sha256> results( count );
+      start = fc::time_point::now();
+      fc::parallel_for( count, [&results,&work] ( size_t i ) { results[i] = work( i ); }, grain );
+      const fc::microseconds parallel = fc::time_point::now() - start;
+      BOOST_CHECK( expected == results );
+      ilog( "${c} hash chains single-threaded in ${s}µs, on ${n} workers with grain ${g} in ${p}µs, speedup ${x}%",
+            ("c",count)("s",single)("n",fc::parallel_concurrency())("g",grain)("p",parallel)
+            ("x",single.count() * 100 / std::max<int64_t>( parallel.count(), 1 )) );
+   }
+}
+
 BOOST_AUTO_TEST_CASE( serial_valve )
 {
    boost::atomic<uint32_t> counter(0);
@@ -68,6 +68,13 @@
  */
 #define GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS        5
 
+/**
+ * How many of the blocks we most recently sent as compact blocks we keep in
+ * their compact form, so serving the same block to more peers, or the
+ * transactions they were missing, doesn't have to take it apart again.
+ */
+#define GRAPHENE_NET_RECENT_COMPACT_BLOCKS                   8
+
 /**
  * We prevent a peer from offering us a list of blocks which, if we fetched them
  * all, would result in a blockchain that extended into the future.
@@ -81,6 +88,22 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * During sync, each peer gets its own window of blocks we request from it at
+ * a time.  It starts at the initial size and then follows the peer's
+ * bandwidth-delay product: the rate at which it streams the blocks of a
+ * window times the delay until the first of them arrives.  It never goes
+ * below the minimum or past maximum_blocks_per_peer_during_syncing.
+ */
+#define GRAPHENE_NET_INITIAL_SYNC_REQUEST_WINDOW             20
+#define GRAPHENE_NET_MIN_SYNC_REQUEST_WINDOW                 2
+/**
+ * The next window is only requested once the last one is complete, so the
+ * link idles for one delay per window.  Windows this many times the
+ * bandwidth-delay product keep it busy most of the time.
+ */
+#define GRAPHENE_NET_SYNC_WINDOW_BDP_MULTIPLE                4
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -108,3 +131,20 @@
 #define GRAPHENE_NET_MAX_NESTED_OBJECTS                      (250)
 
 #define MAXIMUM_PEERDB_SIZE 1000
+
+/**
+ * Peers are scored by how well they serve the items we fetch from them, see
+ * peer_connection::get_quality_score().  An average item latency of the
+ * reference latency halves a peer's score, and its connection counts fully
+ * once it is as old as the grace period.  Younger peers are never dropped for
+ * their score; older ones are replaced, one at a time, when they score below
+ * the given fraction of the median of our connections.
+ */
+#define GRAPHENE_NET_PEER_QUALITY_REFERENCE_LATENCY_MS       500
+#define GRAPHENE_NET_PEER_QUALITY_GRACE_PERIOD_SEC           (10 * 60)
+#define GRAPHENE_NET_PEER_QUALITY_REPLACEMENT_RATIO          0.25
+/**
+ * What a connection that hasn't delivered anything yet scores, used to rank
+ * peers we have never measured against the ones we have
+ */
+#define GRAPHENE_NET_PEER_QUALITY_UNMEASURED_SCORE           0.125
@@ -44,6 +44,7 @@ namespace graphene { namespace net {
   using graphene::chain::block_id_type;
   using graphene::chain::transaction_id_type;
   using graphene::chain::signed_block;
+  using graphene::chain::operation_result;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -86,6 +87,9 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    get_compact_block_transactions_message_type  = 5019,
+    compact_block_transactions_message_type      = 5020,
     core_message_type_last                       = 5099
   };
 
@@ -115,6 +119,59 @@ namespace graphene { namespace net {
 
    };
 
+  /**
+   * A transaction of a compact_block_message.  It is sent in full if the receiver probably
+   * doesn't have it yet, otherwise only the first eight bytes of the hash of its trx_message are
+   * sent and the receiver looks the transaction up in its message cache.
+   */
+  struct compact_block_transaction
+  {
+    uint64_t                          short_id = 0;
+    fc::optional<signed_transaction>  trx;
+    std::vector<operation_result>     operation_results;
+  };
+
+  /**
+   * Sent instead of a block_message to peers that support it when they fetch a recent block.
+   * The receiver rebuilds the block_message from the block without its transactions and the
+   * transactions it already has, and asks for the missing ones with a
+   * get_compact_block_transactions_message.  The rebuilt block_message must hash to
+   * block_message_hash, the item the receiver asked for.
+   */
+  struct compact_block_message
+  {
+    static const core_message_type_enum type;
+
+    item_hash_t                             block_message_hash;
+    signed_block                            block;
+    block_id_type                           block_id;
+    std::vector<compact_block_transaction>  transactions;
+  };
+
+  struct get_compact_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    item_hash_t            block_message_hash;
+    std::vector<uint32_t>  transaction_indexes;
+
+    get_compact_block_transactions_message() {}
+    get_compact_block_transactions_message(const item_hash_t& block_message_hash,
+                                           const std::vector<uint32_t>& transaction_indexes) :
+      block_message_hash(block_message_hash),
+      transaction_indexes(transaction_indexes)
+    {}
+  };
+
+  /** the transactions asked for by a get_compact_block_transactions_message, in the order asked for */
+  struct compact_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    item_hash_t                      block_message_hash;
+    std::vector<signed_transaction>  transactions;
+  };
+
   struct item_ids_inventory_message
   {
     static const core_message_type_enum type;
@@ -424,10 +481,17 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (get_compact_block_transactions_message_type)
+                 (compact_block_transactions_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
 FC_REFLECT( graphene::net::block_message, (block)(block_id) )
+FC_REFLECT( graphene::net::compact_block_transaction, (short_id)(trx)(operation_results) )
+FC_REFLECT( graphene::net::compact_block_message, (block_message_hash)(block)(block_id)(transactions) )
+FC_REFLECT( graphene::net::get_compact_block_transactions_message, (block_message_hash)(transaction_indexes) )
+FC_REFLECT( graphene::net::compact_block_transactions_message, (block_message_hash)(transactions) )
 
 FC_REFLECT( graphene::net::item_id, (item_type)
                                (item_hash) )
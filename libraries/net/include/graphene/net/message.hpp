@@ -29,6 +29,8 @@
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <memory>
+
 namespace graphene { namespace net {
 
   /**
@@ -108,7 +110,11 @@ namespace graphene { namespace net {
      }
   };
 
-
+  /**
+   *  A message packed once and queued for any number of peers, or kept in the
+   *  message cache, without copying it.  It must not change once shared.
+   */
+  typedef std::shared_ptr<const message> shared_message_ptr;
 
 
 } } // graphene::net
@@ -61,6 +61,11 @@ namespace graphene { namespace net {
        fc::time_point get_last_message_received_time() const;
        fc::time_point get_connection_time() const;
        fc::sha512     get_shared_secret() const;
+
+       /** switch the outgoing messages to authenticated encryption, see stcp_socket */
+       void           start_authenticated_sending();
+       /** must be called between reading the last message sent the old way and the first one sent the new way */
+       void           start_authenticated_receiving();
      private:
        std::unique_ptr<detail::message_oriented_connection_impl> my;
   };
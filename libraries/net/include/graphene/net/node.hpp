@@ -68,6 +68,13 @@ namespace graphene { namespace net {
           */
          virtual bool has_item( const net::item_id& id ) = 0;
 
+         /**
+          *  has_item() for several items at once, returns one flag per item.  The node calls the delegate
+          *  from its own thread, so each call is a round trip between threads; the batch variants make that
+          *  one round trip per batch.  Their default implementations call the single item methods in turn.
+          */
+         virtual std::vector<bool> has_items( const std::vector<net::item_id>& ids );
+
          /**
           *  @brief Called when a new block comes in from the network
           *
@@ -88,6 +95,14 @@ namespace graphene { namespace net {
           */
          virtual void handle_transaction( const graphene::net::trx_message& trx_msg ) = 0;
 
+         /**
+          *  handle_block() for several blocks, in order, e.g. sync blocks that are ready to be pushed.
+          *
+          *  @returns for each block, the exception handle_block() threw for it, or null if it was accepted
+          */
+         virtual std::vector<fc::exception_ptr> handle_blocks( const std::vector<graphene::net::block_message>& blk_msgs,
+                                                               bool sync_mode );
+
          /**
           *  @brief Called when a new message comes in from the network other than a
           *         block or a transaction.  Currently there are no other possible 
@@ -114,6 +129,9 @@ namespace graphene { namespace net {
           */
          virtual message get_item( const item_id& id ) = 0;
 
+         /** get_item() for several items, with an empty optional for each item we don't have */
+         virtual std::vector<fc::optional<message>> get_items( const std::vector<item_id>& ids );
+
          virtual chain_id_type get_chain_id()const = 0;
 
          /**
@@ -183,6 +201,46 @@ namespace graphene { namespace net {
       fc::variant_object info;
    };
 
+   /** traffic exchanged with one peer in messages of one type */
+   struct message_type_metrics
+   {
+      std::string message_type;
+      uint64_t    messages_sent = 0;
+      uint64_t    bytes_sent = 0;
+      uint64_t    messages_received = 0;
+      uint64_t    bytes_received = 0;
+   };
+
+   /**
+    *  What one peer has cost and given us since we connected: its traffic by message type, how
+    *  quickly it served the items we fetched from it, and how much of the inventory it
+    *  advertised was new to us.
+    */
+   struct peer_metrics
+   {
+      fc::ip::endpoint                  host;
+      node_id_t                         node_id;
+      std::string                       user_agent;
+      uint32_t                          connection_duration = 0; /// in seconds
+      std::vector<message_type_metrics> messages; /// the most bytes first
+
+      uint64_t items_requested = 0;
+      uint64_t items_received = 0;
+      uint64_t items_not_available = 0;
+      /** percentiles are estimated from power of two buckets, so they are accurate to a factor of two */
+      uint64_t item_latency_p50_us = 0;
+      uint64_t item_latency_p90_us = 0;
+      uint64_t item_latency_p99_us = 0;
+      uint64_t item_latency_max_us = 0;
+
+      uint64_t inventory_items_advertised = 0;
+      uint64_t inventory_items_new = 0; /// the ones no other peer had told us about yet
+
+      uint64_t invalid_items = 0;
+      uint64_t stale_items = 0;
+      double   quality_score = 0; /// see peer_connection::get_quality_score()
+   };
+
    /**
     *  @class node
     *  @brief provides application independent P2P broadcast and data synchronization
@@ -252,6 +310,11 @@ namespace graphene { namespace net {
          */
         std::vector<peer_status> get_connected_peers() const;
 
+        /**
+         * @return traffic and service metrics of every connected peer
+         */
+        std::vector<peer_metrics> get_peer_metrics() const;
+
         /** return the number of peers we're actively connected to */
         virtual uint32_t get_connection_count() const;
 
@@ -299,11 +362,21 @@ namespace graphene { namespace net {
         std::unique_ptr<detail::node_impl, detail::node_impl_deleter> my;
    };
 
+    /**
+     *  Delivers everything broadcast on it straight to the delegates added to it, as
+     *  if each were one hop away over its own link.  Links deliver instantly unless
+     *  given a latency and bandwidth, in which case messages queue up on each link.
+     */
     class simulated_network : public node
     {
     public:
       ~simulated_network();
       simulated_network(const std::string& user_agent) : node(user_agent) {}
+
+      /** how long a message takes to cross a link once it's been sent */
+      void      set_latency(fc::microseconds latency) { _latency = latency; }
+      /** bytes per second each link can send, 0 for unlimited */
+      void      set_bandwidth(uint64_t bytes_per_second) { _bytes_per_second = bytes_per_second; }
       void      listen_to_p2p_network() override {}
       void      connect_to_p2p_network() override {}
       void      connect_to_endpoint(const fc::ip::endpoint& ep) override {}
@@ -319,6 +392,8 @@ namespace graphene { namespace net {
       struct node_info;
       void message_sender(node_info* destination_node);
       std::list<node_info*> network_nodes;
+      fc::microseconds _latency;
+      uint64_t _bytes_per_second = 0;
     };
 
 
@@ -329,3 +404,8 @@ namespace graphene { namespace net {
 
 FC_REFLECT(graphene::net::message_propagation_data, (received_time)(validated_time)(originating_peer));
 FC_REFLECT( graphene::net::peer_status, (version)(host)(info) );
+FC_REFLECT( graphene::net::message_type_metrics, (message_type)(messages_sent)(bytes_sent)(messages_received)(bytes_received) )
+FC_REFLECT( graphene::net::peer_metrics, (host)(node_id)(user_agent)(connection_duration)(messages)
+            (items_requested)(items_received)(items_not_available)
+            (item_latency_p50_us)(item_latency_p90_us)(item_latency_p99_us)(item_latency_max_us)
+            (inventory_items_advertised)(inventory_items_new)(invalid_items)(stale_items)(quality_score) )
@@ -40,6 +40,7 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 
+#include <array>
 #include <queue>
 #include <boost/container/deque.hpp>
 #include <fc/thread/future.hpp>
@@ -118,12 +119,15 @@ namespace graphene { namespace net
         fc::time_point enqueue_time;
         fc::time_point transmission_start_time;
         fc::time_point transmission_finish_time;
+        bool           start_authenticated_sending_after; /// the messages queued after this one use authenticated encryption
 
         queued_message(fc::time_point enqueue_time = fc::time_point::now()) :
-          enqueue_time(enqueue_time)
+          enqueue_time(enqueue_time),
+          start_authenticated_sending_after(false)
         {}
 
-        virtual message get_message(peer_connection_delegate* node) = 0;
+        /** the message to send, valid until the queued_message is destroyed */
+        virtual const message& get_message(peer_connection_delegate* node) = 0;
         /** returns roughly the number of bytes of memory the message is consuming while
          * it is sitting on the queue
          */
@@ -145,7 +149,22 @@ namespace graphene { namespace net
           message_send_time_field_offset(message_send_time_field_offset)
         {}
 
-        message get_message(peer_connection_delegate* node) override;
+        const message& get_message(peer_connection_delegate* node) override;
+        size_t get_size_in_queue() override;
+      };
+
+      /* when you queue up a 'shared_queued_message', the message is shared with
+       * every other peer it was queued for and with the message cache
+       */
+      struct shared_queued_message : queued_message
+      {
+        shared_message_ptr message_to_send;
+
+        shared_queued_message(shared_message_ptr message_to_send) :
+          message_to_send(std::move(message_to_send))
+        {}
+
+        const message& get_message(peer_connection_delegate* node) override;
         size_t get_size_in_queue() override;
       };
 
@@ -156,12 +175,13 @@ namespace graphene { namespace net
       struct virtual_queued_message : queued_message
       {
         item_id item_to_send;
+        std::unique_ptr<message> generated_message;
 
         virtual_queued_message(item_id item_to_send) :
           item_to_send(std::move(item_to_send))
         {}
 
-        message get_message(peer_connection_delegate* node) override;
+        const message& get_message(peer_connection_delegate* node) override;
         size_t get_size_in_queue() override;
       };
 
@@ -207,6 +227,10 @@ namespace graphene { namespace net
       fc::optional<fc::time_point_sec> fc_git_revision_unix_timestamp;
       fc::optional<std::string> platform;
       fc::optional<uint32_t> bitness;
+      /** true if the peer announced in its hello that it takes compact_block_messages */
+      bool             supports_compact_blocks;
+      /** true if the peer announced in its hello that it can switch to authenticated encryption */
+      bool             supports_authenticated_encryption;
 
       // for inbound connections, these fields record what the peer sent us in
       // its hello message.  For outbound, they record what we sent the peer
@@ -230,6 +254,13 @@ namespace graphene { namespace net
       item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
       fc::time_point_sec last_block_time_delegate_has_seen;
       bool inhibit_fetching_sync_blocks;
+      uint32_t sync_request_window; /// how many sync blocks we ask this peer for at a time
+      fc::time_point sync_window_request_time; /// when we asked for the window of sync blocks outstanding
+      uint32_t sync_window_size; /// how many sync blocks we asked for in that window
+      fc::time_point sync_window_first_item_time; /// when the first block of that window arrived
+      fc::time_point last_sync_item_received_time; /// a peer still delivering the window isn't timing out
+      double sync_blocks_per_second; /// the rate a window streams in after its first block, zero until measured
+      fc::microseconds sync_window_latency; /// the delay until the first block of a window arrives, on average
       /// @}
 
       /// non-synchronization state data
@@ -253,6 +284,43 @@ namespace graphene { namespace net
       timestamped_items_set_type inventory_advertised_to_peer;
 
       item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
+
+      /** a compact block this peer sent us, while we wait for the transactions we didn't have */
+      struct partial_compact_block
+      {
+        compact_block_message                           compact_block;
+        std::vector<fc::optional<signed_transaction>>   transactions;
+        std::vector<uint32_t>                           requested_indexes;
+      };
+      std::map<item_hash_t, partial_compact_block> compact_blocks_being_assembled; /// by the hash of the block_message
+      /// @}
+
+      /// traffic and service metrics, see node::get_peer_metrics()
+      /// @{
+      struct message_counters
+      {
+        uint64_t messages_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t messages_received = 0;
+        uint64_t bytes_received = 0;
+      };
+      std::map<uint32_t, message_counters> message_counters_by_type;
+      uint64_t items_requested_count;
+      uint64_t items_received_count;
+      uint64_t items_not_available_count;
+      uint64_t inventory_items_advertised_count;
+      uint64_t inventory_items_new_count;
+      uint64_t invalid_items_count; /// items the delegate rejected
+      uint64_t stale_items_count; /// blocks that arrived after we had accepted them from another peer
+      double item_latency_average_us; /// moving average, 0 until the first item arrives
+      std::array<uint64_t, 32> item_latency_buckets; /// bucket i holds latencies in [2^(i-1), 2^i) microseconds
+      uint64_t item_latency_max_us;
+
+      /** an item we asked for at request_time arrived */
+      void record_item_received(fc::time_point request_time);
+      uint64_t get_item_latency_percentile_us(uint32_t permille) const;
+      /** how well this peer has served us so far, in (0, 1]; drives fetch selection and connection retention */
+      double get_quality_score() const;
       /// @}
 
       // if they're flooding us with transactions, we set this to avoid fetching for a few seconds to let the
@@ -285,7 +353,12 @@ namespace graphene { namespace net
 
       void send_queueable_message(std::unique_ptr<queued_message>&& message_to_send);
       void send_message(const message& message_to_send, size_t message_send_time_field_offset = (size_t)-1);
+      void send_message(shared_message_ptr message_to_send);
       void send_item(const item_id& item_to_send);
+      /** everything queued after this call goes out with authenticated encryption */
+      void start_authenticated_sending_after_queued_messages();
+      /** call from the handler of the last message the peer sent the old way */
+      void start_authenticated_receiving();
       void close_connection();
       void destroy_connection();
 
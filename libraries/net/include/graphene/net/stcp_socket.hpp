@@ -31,6 +31,11 @@ namespace graphene { namespace net {
 /**
  *  Uses ECDH to negotiate a aes key for communicating
  *  with other nodes on the network.
+ *
+ *  Connections start out with AES-256-CBC over the raw stream.  Once both
+ *  peers have said in their hellos that they understand it, each direction
+ *  switches to AES-256-GCM records, which authenticate every message and
+ *  need no padding.
  */
 class stcp_socket : public virtual fc::iostream
 {
@@ -56,8 +61,26 @@ class stcp_socket : public virtual fc::iostream
     using istream::get;
     void             get( char& c ) { read( &c, 1 ); }
     fc::sha512       get_shared_secret() const { return _shared_secret; }
+
+    /** everything written from now on goes out as AES-256-GCM records */
+    void             start_authenticated_sending();
+    /** everything read from now on must be AES-256-GCM records */
+    void             start_authenticated_receiving();
+    bool             is_sending_authenticated() const { return _sending_authenticated; }
+    bool             is_receiving_authenticated() const { return _receiving_authenticated; }
+
+    /** writes one record holding header followed by body, and its tag */
+    void             write_authenticated( const char* header, size_t header_len, const char* body, size_t body_len );
+    /**
+     *  reads a record in two steps, so the start can say how long the rest is.  The start
+     *  isn't authenticated until read_authenticated_rest() returns.
+     */
+    void             read_authenticated_start( char* buffer, size_t len );
+    void             read_authenticated_rest( char* buffer, size_t len );
   private:
     void do_key_exchange();
+    fc::sha256 authenticated_key( bool initiator_to_acceptor ) const;
+    static void reserve_buffer( std::shared_ptr<char>& buffer, size_t& capacity, size_t len );
 
     fc::sha512           _shared_secret;
     fc::ecc::private_key _priv_key;
@@ -68,6 +91,16 @@ class stcp_socket : public virtual fc::iostream
     fc::aes_decoder      _recv_aes;
     std::shared_ptr<char> _read_buffer;
     std::shared_ptr<char> _write_buffer;
+
+    bool                  _is_initiator;
+    bool                  _sending_authenticated;
+    bool                  _receiving_authenticated;
+    fc::aes_gcm_encoder   _send_gcm;
+    fc::aes_gcm_decoder   _recv_gcm;
+    std::shared_ptr<char> _authenticated_read_buffer;
+    size_t                _authenticated_read_buffer_size;
+    std::shared_ptr<char> _authenticated_write_buffer;
+    size_t                _authenticated_write_buffer_size;
 #ifndef NDEBUG
     bool _read_buffer_in_use;
     bool _write_buffer_in_use;
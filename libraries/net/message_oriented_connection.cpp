@@ -81,6 +81,8 @@ namespace graphene { namespace net {
       void send_message(const message& message_to_send);
       void close_connection();
       void destroy_connection();
+      void start_authenticated_sending();
+      void start_authenticated_receiving();
 
       uint64_t get_total_bytes_sent() const;
       uint64_t get_total_bytes_received() const;
@@ -155,22 +157,34 @@ namespace graphene { namespace net {
         message m;
         while( true )
         {
-          char buffer[BUFFER_SIZE];
-          _sock.read(buffer, BUFFER_SIZE);
-          _bytes_received += BUFFER_SIZE;
-          memcpy((char*)&m, buffer, sizeof(message_header));
-
-          FC_ASSERT( m.size <= MAX_MESSAGE_SIZE, "", ("m.size",m.size)("MAX_MESSAGE_SIZE",MAX_MESSAGE_SIZE) );
-
-          size_t remaining_bytes_with_padding = 16 * ((m.size - LEFTOVER + 15) / 16);
-          m.data.resize(LEFTOVER + remaining_bytes_with_padding); //give extra 16 bytes to allow for padding added in send call
-          std::copy(buffer + sizeof(message_header), buffer + sizeof(buffer), m.data.begin());
-          if (remaining_bytes_with_padding)
+          if (_sock.is_receiving_authenticated())
+          {
+            // an unpadded record: the header, the message body, and a tag covering both
+            _sock.read_authenticated_start((char*)&m, sizeof(message_header));
+            FC_ASSERT( m.size <= MAX_MESSAGE_SIZE, "", ("m.size",m.size)("MAX_MESSAGE_SIZE",MAX_MESSAGE_SIZE) );
+            m.data.resize(m.size);
+            _sock.read_authenticated_rest(m.data.data(), m.size);
+            _bytes_received += sizeof(message_header) + m.size + fc::aes_gcm_decoder::tag_size;
+          }
+          else
           {
-            _sock.read(&m.data[LEFTOVER], remaining_bytes_with_padding);
-            _bytes_received += remaining_bytes_with_padding;
+            char buffer[BUFFER_SIZE];
+            _sock.read(buffer, BUFFER_SIZE);
+            _bytes_received += BUFFER_SIZE;
+            memcpy((char*)&m, buffer, sizeof(message_header));
+
+            FC_ASSERT( m.size <= MAX_MESSAGE_SIZE, "", ("m.size",m.size)("MAX_MESSAGE_SIZE",MAX_MESSAGE_SIZE) );
+
+            size_t remaining_bytes_with_padding = 16 * ((m.size - LEFTOVER + 15) / 16);
+            m.data.resize(LEFTOVER + remaining_bytes_with_padding); //give extra 16 bytes to allow for padding added in send call
+            std::copy(buffer + sizeof(message_header), buffer + sizeof(buffer), m.data.begin());
+            if (remaining_bytes_with_padding)
+            {
+              _sock.read(&m.data[LEFTOVER], remaining_bytes_with_padding);
+              _bytes_received += remaining_bytes_with_padding;
+            }
+            m.data.resize(m.size); // truncate off the padding bytes
           }
-          m.data.resize(m.size); // truncate off the padding bytes
 
           _last_message_received_time = fc::time_point::now();
 
@@ -255,9 +269,18 @@ namespace graphene { namespace net {
 
       try
       {
-        size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size;
         if( message_to_send.size > MAX_MESSAGE_SIZE )
            elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
+        if (_sock.is_sending_authenticated())
+        {
+          _sock.write_authenticated((const char*)&message_to_send, sizeof(message_header),
+                                    message_to_send.data.data(), message_to_send.size);
+          _sock.flush();
+          _bytes_sent += sizeof(message_header) + message_to_send.size + fc::aes_gcm_encoder::tag_size;
+          _last_message_sent_time = fc::time_point::now();
+          return;
+        }
+        size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size;
         //pad the message we send to a multiple of 16 bytes
         size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
         std::unique_ptr<char[]> padded_message(new char[size_with_padding]);
@@ -334,6 +357,19 @@ namespace graphene { namespace net {
       return _sock.get_shared_secret();
     }
 
+    void message_oriented_connection_impl::start_authenticated_sending()
+    {
+      VERIFY_CORRECT_THREAD();
+      assert(!_send_message_in_progress);
+      _sock.start_authenticated_sending();
+    }
+
+    void message_oriented_connection_impl::start_authenticated_receiving()
+    {
+      VERIFY_CORRECT_THREAD();
+      _sock.start_authenticated_receiving();
+    }
+
   } // end namespace graphene::net::detail
 
 
@@ -408,5 +444,13 @@ namespace graphene { namespace net {
   {
     return my->get_shared_secret();
   }
+  void message_oriented_connection::start_authenticated_sending()
+  {
+    my->start_authenticated_sending();
+  }
+  void message_oriented_connection::start_authenticated_receiving()
+  {
+    my->start_authenticated_receiving();
+  }
 
 } } // end namespace graphene::net
@@ -29,6 +29,7 @@
 #include <forward_list>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 #include <tuple>
 #include <boost/tuple/tuple.hpp>
 #include <boost/circular_buffer.hpp>
@@ -63,6 +64,7 @@
 #include <fc/thread/non_preemptable_scope_check.hpp>
 #include <fc/thread/mutex.hpp>
 #include <fc/thread/scoped_lock.hpp>
+#include <fc/scoped_exit.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
 #include <fc/io/enum_type.hpp>
@@ -124,6 +126,16 @@ namespace graphene { namespace net {
   namespace detail
   {
     namespace bmi = boost::multi_index;
+
+    /** the short id of a transaction in a compact_block_message, the first eight bytes of the hash of its trx_message */
+    uint64_t short_transaction_id( const message_hash_type& trx_message_hash )
+    {
+      uint64_t short_id = 0;
+      for( size_t i = 0; i < sizeof(short_id); ++i )
+        short_id = ( short_id << 8 ) | uint8_t( trx_message_hash.data()[i] );
+      return short_id;
+    }
+
     class blockchain_tied_message_cache
     {
     private:
@@ -134,8 +146,8 @@ namespace graphene { namespace net {
       struct block_clock_index{};
       struct message_info
       {
-        message_hash_type message_hash;
-        message           message_body;
+        message_hash_type  message_hash;
+        shared_message_ptr message_body; // shared with the send queues of the peers we're sending it to
         uint32_t          block_clock_when_received;
 
         // for network performance stats
@@ -143,12 +155,12 @@ namespace graphene { namespace net {
         fc::uint160_t     message_contents_hash; // hash of whatever the message contains (if it's a transaction, this is the transaction id, if it's a block, it's the block_id)
 
         message_info( const message_hash_type& message_hash,
-                      const message&           message_body,
+                      shared_message_ptr       message_body,
                       uint32_t                 block_clock_when_received,
                       const message_propagation_data& propagation_data,
                       fc::uint160_t            message_contents_hash ) :
           message_hash( message_hash ),
-          message_body( message_body ),
+          message_body( std::move(message_body) ),
           block_clock_when_received( block_clock_when_received ),
           propagation_data( propagation_data ),
           message_contents_hash( message_contents_hash )
@@ -173,9 +185,13 @@ namespace graphene { namespace net {
         block_clock( 0 )
       {}
       void block_accepted();
-      void cache_message( const message& message_to_cache, const message_hash_type& hash_of_message_to_cache,
+      void cache_message( shared_message_ptr message_to_cache, const message_hash_type& hash_of_message_to_cache,
                         const message_propagation_data& propagation_data, const fc::uint160_t& message_content_hash );
-      message get_message( const message_hash_type& hash_of_message_to_lookup );
+      shared_message_ptr get_message( const message_hash_type& hash_of_message_to_lookup ) const;
+      /** what the message contains, the block_id or transaction id */
+      fc::uint160_t get_message_contents_hash( const message_hash_type& hash_of_message_to_lookup ) const;
+      /** the transaction whose trx_message has the given short id, if there is exactly one */
+      fc::optional<signed_transaction> find_transaction( uint64_t short_id ) const;
       message_propagation_data get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
       size_t size() const { return _message_cache.size(); }
     };
@@ -188,19 +204,19 @@ namespace graphene { namespace net {
                                                       _message_cache.get<block_clock_index>().lower_bound(block_clock - cache_duration_in_blocks ) );
     }
 
-    void blockchain_tied_message_cache::cache_message( const message& message_to_cache,
+    void blockchain_tied_message_cache::cache_message( shared_message_ptr message_to_cache,
                                                      const message_hash_type& hash_of_message_to_cache,
                                                      const message_propagation_data& propagation_data,
                                                      const fc::uint160_t& message_content_hash )
     {
       _message_cache.insert( message_info(hash_of_message_to_cache,
-                                         message_to_cache,
+                                         std::move(message_to_cache),
                                          block_clock,
                                          propagation_data,
                                          message_content_hash ) );
     }
 
-    message blockchain_tied_message_cache::get_message( const message_hash_type& hash_of_message_to_lookup )
+    shared_message_ptr blockchain_tied_message_cache::get_message( const message_hash_type& hash_of_message_to_lookup ) const
     {
       message_cache_container::index<message_hash_index>::type::const_iterator iter =
          _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup );
@@ -209,6 +225,36 @@ namespace graphene { namespace net {
       FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
     }
 
+    fc::uint160_t blockchain_tied_message_cache::get_message_contents_hash( const message_hash_type& hash_of_message_to_lookup ) const
+    {
+      message_cache_container::index<message_hash_index>::type::const_iterator iter =
+         _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup );
+      if( iter != _message_cache.get<message_hash_index>().end() )
+        return iter->message_contents_hash;
+      FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
+    }
+
+    fc::optional<signed_transaction> blockchain_tied_message_cache::find_transaction( uint64_t short_id ) const
+    {
+      // the short id is a prefix of the message hash, so all candidates are adjacent in the hash index
+      message_hash_type first_candidate;
+      for( size_t i = 0; i < sizeof(short_id); ++i )
+        first_candidate.data()[i] = char( short_id >> ( 8 * ( sizeof(short_id) - 1 - i ) ) );
+
+      fc::optional<signed_transaction> result;
+      const auto& index = _message_cache.get<message_hash_index>();
+      for( auto iter = index.lower_bound( first_candidate );
+           iter != index.end() && short_transaction_id( iter->message_hash ) == short_id; ++iter )
+      {
+        if( iter->message_body->msg_type != trx_message_type )
+          continue;
+        if( result )
+          return fc::optional<signed_transaction>(); // ambiguous, let the peer send it
+        result = iter->message_body->as<trx_message>().trx;
+      }
+      return result;
+    }
+
     message_propagation_data blockchain_tied_message_cache::get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const
     {
       if( hash_of_message_contents_to_lookup != fc::uint160_t() )
@@ -286,11 +332,14 @@ namespace graphene { namespace net { namespace detail {
                                                                                        boost::accumulators::tag::sum,
                                                                                        boost::accumulators::tag::count> > call_stats_accumulator;
 #define NODE_DELEGATE_METHOD_NAMES (has_item) \
+                                   (has_items) \
                                    (handle_message) \
                                    (handle_block) \
+                                   (handle_blocks) \
                                    (handle_transaction) \
                                    (get_block_ids) \
                                    (get_item) \
+                                   (get_items) \
                                    (get_chain_id) \
                                    (get_blockchain_synopsis) \
                                    (sync_status) \
@@ -382,13 +431,16 @@ namespace graphene { namespace net { namespace detail {
       fc::variant_object get_call_statistics();
 
       bool has_item( const net::item_id& id ) override;
+      std::vector<bool> has_items( const std::vector<net::item_id>& ids ) override;
       void handle_message( const message& ) override;
       bool handle_block( const graphene::net::block_message& block_message, bool sync_mode, std::vector<fc::uint160_t>& contained_transaction_message_ids ) override;
+      std::vector<fc::exception_ptr> handle_blocks( const std::vector<graphene::net::block_message>& block_messages, bool sync_mode ) override;
       void handle_transaction( const graphene::net::trx_message& transaction_message ) override;
       std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                              uint32_t& remaining_item_count,
                                              uint32_t limit = 2000) override;
       message get_item( const item_id& id ) override;
+      std::vector<fc::optional<message>> get_items( const std::vector<item_id>& ids ) override;
       chain_id_type get_chain_id() const override;
       std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t& reference_point, 
                                                        uint32_t number_of_blocks_after_reference_point) override;
@@ -415,7 +467,7 @@ namespace graphene { namespace net { namespace detail {
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -530,6 +582,15 @@ namespace graphene { namespace net { namespace detail {
 
       blockchain_tied_message_cache _message_cache; /// cache message we have received and might be required to provide to other peers via inventory requests
 
+      /** a block we served as a compact block, with everything needed to serve it to more peers */
+      struct compact_block_template
+      {
+        compact_block_message             compact_block; /// without any transactions sent in full
+        std::vector<signed_transaction>   transactions;
+        std::vector<message_hash_type>    transaction_message_hashes;
+      };
+      std::map<item_hash_t, compact_block_template> _recent_compact_blocks; /// by the hash of the block_message
+
       fc::rate_limiting_group _rate_limiter;
 
       uint32_t _last_reported_number_of_connections; // number of connections last reported to the client (to avoid sending duplicate messages)
@@ -578,6 +639,9 @@ namespace graphene { namespace net { namespace detail {
       unsigned _maximum_blocks_per_peer_during_syncing;
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
+      std::deque<graphene::net::block_message> _sync_blocks_to_send_to_delegate; /// in chain order, sent by a single task to keep that order
+      fc::future<void> _send_sync_blocks_to_node_delegate_done;
+      unsigned _number_of_sync_blocks_being_handled; /// queued in _sync_blocks_to_send_to_delegate or being handled by the delegate
 
       node_impl(const std::string& user_agent);
       virtual ~node_impl();
@@ -590,6 +654,7 @@ namespace graphene { namespace net { namespace detail {
       bool have_already_received_sync_item( const item_hash_t& item_hash );
       void request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request );
       void request_sync_items_from_peer( const peer_connection_ptr& peer, const std::vector<item_hash_t>& items_to_request );
+      void adjust_sync_request_window( const peer_connection_ptr& peer );
       void fetch_sync_items_loop();
       void trigger_fetch_sync_items_loop();
 
@@ -652,6 +717,21 @@ namespace graphene { namespace net { namespace detail {
       void on_item_not_available_message( peer_connection* originating_peer,
                                           const item_not_available_message& item_not_available_message_received );
 
+      const compact_block_template& get_compact_block_template( const item_hash_t& block_message_hash );
+      compact_block_message make_compact_block_for_peer( peer_connection* peer, const item_hash_t& block_message_hash );
+
+      void on_compact_block_message( peer_connection* originating_peer,
+                                     const compact_block_message& compact_block_message_received );
+
+      void on_get_compact_block_transactions_message( peer_connection* originating_peer,
+                                                      const get_compact_block_transactions_message& get_compact_block_transactions_message_received );
+
+      void on_compact_block_transactions_message( peer_connection* originating_peer,
+                                                  const compact_block_transactions_message& compact_block_transactions_message_received );
+
+      void assemble_compact_block( peer_connection* originating_peer, const item_hash_t& block_message_hash,
+                                   peer_connection::partial_compact_block&& partial_block );
+
       void on_item_ids_inventory_message( peer_connection* originating_peer,
                                           const item_ids_inventory_message& item_ids_inventory_message_received );
 
@@ -680,7 +760,9 @@ namespace graphene { namespace net { namespace detail {
 
       void on_connection_closed(peer_connection* originating_peer) override;
 
-      void send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send);
+      void send_sync_blocks_to_node_delegate();
+      void trigger_send_sync_blocks_to_node_delegate();
+      void on_sync_block_handled(const graphene::net::block_message& block_message_to_send, const fc::exception_ptr& handle_block_exception);
       void process_backlog_of_sync_blocks();
       void trigger_process_backlog_of_sync_blocks();
       void process_block_during_sync(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
@@ -732,6 +814,7 @@ namespace graphene { namespace net { namespace detail {
 
       fc::ip::endpoint         get_actual_listening_endpoint() const;
       std::vector<peer_status> get_connected_peers() const;
+      std::vector<peer_metrics> get_peer_metrics() const;
       uint32_t                 get_connection_count() const;
 
       void broadcast(const message& item_to_broadcast, const message_propagation_data& propagation_data);
@@ -790,6 +873,8 @@ namespace graphene { namespace net { namespace detail {
 #endif
 
 #define MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME 200
+// sync blocks are handed to the delegate a few at a time, so neither its thread nor the handling of the results waits for long
+#define MAXIMUM_NUMBER_OF_SYNC_BLOCKS_PER_DELEGATE_CALL 10
 #define MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH (10 * MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME)
 
     node_impl::node_impl(const std::string& user_agent) :
@@ -825,7 +910,8 @@ namespace graphene { namespace net { namespace detail {
       _node_is_shutting_down(false),
       _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
       _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING)
+      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+      _number_of_sync_blocks_being_handled(0)
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_bytes(&_node_id.data[0], (int)_node_id.size());
@@ -921,8 +1007,17 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
+            // try the peers that served us best first, the ones we never measured rank as a new connection
+            std::vector<potential_peer_record> candidates(_potential_peer_db.begin(), _potential_peer_db.end());
+            auto expected_quality_score = [](const potential_peer_record& record) {
+              return record.quality_score > 0 ? record.quality_score : GRAPHENE_NET_PEER_QUALITY_UNMEASURED_SCORE;
+            };
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [&expected_quality_score](const potential_peer_record& a, const potential_peer_record& b) {
+                               return expected_quality_score(a) > expected_quality_score(b);
+                             });
+            for (auto iter = candidates.begin();
+                 iter != candidates.end() && is_wanting_new_connections();
                  ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
@@ -1007,6 +1102,7 @@ namespace graphene { namespace net { namespace detail {
       item_id item_id_to_request( graphene::net::block_message_type, item_to_request );
       _active_sync_requests.insert( active_sync_requests_map::value_type(item_to_request, fc::time_point::now() ) );
       peer->sync_items_requested_from_peer.insert( peer_connection::item_to_time_map_type::value_type(item_id_to_request, fc::time_point::now() ) );
+      ++peer->items_requested_count;
       std::vector<item_hash_t> items_to_fetch;
       peer->send_message( fetch_items_message(item_id_to_request.item_type, std::vector<item_hash_t>{item_id_to_request.item_hash} ) );
     }
@@ -1022,9 +1118,44 @@ namespace graphene { namespace net { namespace detail {
         item_id item_id_to_request( graphene::net::block_message_type, item_to_request );
         peer->sync_items_requested_from_peer.insert( peer_connection::item_to_time_map_type::value_type(item_id_to_request, fc::time_point::now() ) );
       }
+      peer->items_requested_count += items_to_request.size();
+      peer->sync_window_request_time = fc::time_point::now();
+      peer->sync_window_size = items_to_request.size();
       peer->send_message(fetch_items_message(graphene::net::block_message_type, items_to_request));
     }
 
+    void node_impl::adjust_sync_request_window( const peer_connection_ptr& peer )
+    {
+      VERIFY_CORRECT_THREAD();
+      if( peer->sync_window_size == 0 || peer->sync_window_first_item_time < peer->sync_window_request_time )
+        return;
+      const fc::microseconds latency = peer->sync_window_first_item_time - peer->sync_window_request_time;
+      peer->sync_window_latency = peer->sync_window_latency.count() == 0 ? latency
+                                  : fc::microseconds( ( 7 * peer->sync_window_latency.count() + 3 * latency.count() ) / 10 );
+      // the time to the first block is latency, the rest of the window shows how fast the peer streams blocks
+      if( peer->sync_window_size > 1 )
+      {
+        fc::microseconds streaming = std::max( fc::time_point::now() - peer->sync_window_first_item_time, fc::milliseconds(1) );
+        double blocks_per_second = ( peer->sync_window_size - 1 ) * 1000000.0 / streaming.count();
+        peer->sync_blocks_per_second = peer->sync_blocks_per_second == 0 ? blocks_per_second
+                                                                         : 0.7 * peer->sync_blocks_per_second + 0.3 * blocks_per_second;
+      }
+      peer->sync_window_size = 0;
+      if( peer->sync_blocks_per_second == 0 )
+        return;
+
+      // a bigger window streams at the same rate, so only a slower peer or a longer delay shrinks it
+      double bandwidth_delay_product = peer->sync_blocks_per_second * peer->sync_window_latency.count() / 1000000.0;
+      uint64_t target = uint64_t( std::ceil( bandwidth_delay_product * GRAPHENE_NET_SYNC_WINDOW_BDP_MULTIPLE ) );
+      target = std::min<uint64_t>( target, uint64_t( peer->sync_request_window ) * 2 );
+      target = std::max<uint64_t>( target, peer->sync_request_window / 2 );
+      target = std::min<uint64_t>( target, _maximum_blocks_per_peer_during_syncing );
+      peer->sync_request_window = std::max<uint32_t>( uint32_t( target ), GRAPHENE_NET_MIN_SYNC_REQUEST_WINDOW );
+      dlog( "peer ${endpoint} streams ${rate} blocks/s after ${ms} ms on average, sync window is now ${window}",
+            ("endpoint", peer->get_remote_endpoint())("rate", peer->sync_blocks_per_second)
+            ("ms", peer->sync_window_latency.count() / 1000)("window", peer->sync_request_window) );
+    }
+
     void node_impl::fetch_sync_items_loop()
     {
       VERIFY_CORRECT_THREAD();
@@ -1041,8 +1172,12 @@ namespace graphene { namespace net { namespace detail {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
 
-            // for each idle peer that we're syncing with
-            for( const peer_connection_ptr& peer : _active_connections )
+            // for each idle peer that we're syncing with, fastest first, so they get the blocks we need soonest
+            std::vector<peer_connection_ptr> peers_by_sync_speed( _active_connections.begin(), _active_connections.end() );
+            std::stable_sort( peers_by_sync_speed.begin(), peers_by_sync_speed.end(),
+                              []( const peer_connection_ptr& a, const peer_connection_ptr& b ) {
+                                return a->sync_blocks_per_second > b->sync_blocks_per_second; } );
+            for( const peer_connection_ptr& peer : peers_by_sync_speed )
             {
               if( peer->we_need_sync_items_from_peer &&
                   sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
@@ -1062,7 +1197,7 @@ namespace graphene { namespace net { namespace detail {
                       // then schedule a request from this peer
                       sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                       sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _maximum_blocks_per_peer_during_syncing)
+                      if (sync_item_requests_to_send[peer].size() >= std::min<uint32_t>(peer->sync_request_window, _maximum_blocks_per_peer_during_syncing))
                         break;
                     }
                   }
@@ -1122,20 +1257,22 @@ namespace graphene { namespace net { namespace detail {
 
         // we need to construct a list of items to request from each peer first,
         // then send the messages (in two steps, to avoid yielding while iterating)
-        // we want to evenly distribute our requests among our peers.
-        struct requested_item_count_index {};
+        // we want to distribute our requests among our peers in proportion to how well they serve us,
+        // so an item goes to the peer with the lowest load per unit of quality that has it
+        struct fetch_cost_index {};
         struct peer_and_items_to_fetch
         {
           peer_connection_ptr peer;
+          double quality_score;
           std::vector<item_id> item_ids;
-          peer_and_items_to_fetch(const peer_connection_ptr& peer) : peer(peer) {}
+          peer_and_items_to_fetch(const peer_connection_ptr& peer) : peer(peer), quality_score(peer->get_quality_score()) {}
           bool operator<(const peer_and_items_to_fetch& rhs) const { return peer < rhs.peer; }
-          size_t number_of_items() const { return item_ids.size(); }
+          double fetch_cost() const { return (item_ids.size() + 1) / quality_score; }
         };
         typedef boost::multi_index_container<peer_and_items_to_fetch,
                                              boost::multi_index::indexed_by<boost::multi_index::ordered_unique<boost::multi_index::member<peer_and_items_to_fetch, peer_connection_ptr, &peer_and_items_to_fetch::peer> >,
-                                                                            boost::multi_index::ordered_non_unique<boost::multi_index::tag<requested_item_count_index>,
-                                                                                                                   boost::multi_index::const_mem_fun<peer_and_items_to_fetch, size_t, &peer_and_items_to_fetch::number_of_items> > > > fetch_messages_to_send_set;
+                                                                            boost::multi_index::ordered_non_unique<boost::multi_index::tag<fetch_cost_index>,
+                                                                                                                   boost::multi_index::const_mem_fun<peer_and_items_to_fetch, double, &peer_and_items_to_fetch::fetch_cost> > > > fetch_messages_to_send_set;
         fetch_messages_to_send_set items_by_peer;
 
         // initialize the fetch_messages_to_send with an empty set of items for all idle peers
@@ -1156,9 +1293,9 @@ namespace graphene { namespace net { namespace detail {
           }
           else
           {
-            // find a peer that has it, we'll use the one who has the least requests going to it to load balance
+            // find a peer that has it, we'll use the cheapest one to load balance
             bool item_fetched = false;
-            for (auto peer_iter = items_by_peer.get<requested_item_count_index>().begin(); peer_iter != items_by_peer.get<requested_item_count_index>().end(); ++peer_iter)
+            for (auto peer_iter = items_by_peer.get<fetch_cost_index>().begin(); peer_iter != items_by_peer.get<fetch_cost_index>().end(); ++peer_iter)
             {
               const peer_connection_ptr& peer = peer_iter->peer;
               // if they have the item and we haven't already decided to ask them for too many other items
@@ -1173,9 +1310,10 @@ namespace graphene { namespace net { namespace detail {
                   //     ("hash", iter->item.item_hash)("endpoint", peer->get_remote_endpoint()));
                   item_id item_id_to_fetch = item_iter->item;
                   peer->items_requested_from_peer.insert(peer_connection::item_to_time_map_type::value_type(item_id_to_fetch, fc::time_point::now()));
+                  ++peer->items_requested_count;
                   item_iter = _items_to_fetch.erase(item_iter);
                   item_fetched = true;
-                  items_by_peer.get<requested_item_count_index>().modify(peer_iter, [&item_id_to_fetch](peer_and_items_to_fetch& peer_and_items) {
+                  items_by_peer.get<fetch_cost_index>().modify(peer_iter, [&item_id_to_fetch](peer_and_items_to_fetch& peer_and_items) {
                     peer_and_items.item_ids.push_back(item_id_to_fetch);
                   });
                   break;
@@ -1317,6 +1455,7 @@ namespace graphene { namespace net { namespace detail {
       std::list<peer_connection_ptr> peers_to_disconnect_forcibly;
       std::list<peer_connection_ptr> peers_to_send_keep_alive;
       std::list<peer_connection_ptr> peers_to_terminate;
+      std::list<peer_connection_ptr> peers_to_replace;
 
       _recent_block_interval_in_seconds = _delegate->get_current_block_interval_in_seconds();
 
@@ -1387,7 +1526,8 @@ namespace graphene { namespace net { namespace detail {
           {
             bool disconnect_due_to_request_timeout = false;
             for (const peer_connection::item_to_time_map_type::value_type& item_and_time : active_peer->sync_items_requested_from_peer)
-              if (item_and_time.second < active_ignored_request_threshold)
+              if (item_and_time.second < active_ignored_request_threshold &&
+                  active_peer->last_sync_item_received_time < active_ignored_request_threshold) // still delivering the window
               {
                 wlog("Disconnecting peer ${peer} because they didn't respond to my request for sync item ${id}",
                       ("peer", active_peer->get_remote_endpoint())("id", item_and_time.first.item_hash));
@@ -1429,6 +1569,35 @@ namespace graphene { namespace net { namespace detail {
           }
         }
 
+        // replace the connection that serves us worst, once it has had its chance, so that the connect loop can
+        // find a better one.  Only when we have all the connections we want, so we never isolate ourselves
+        if (!_active_connections.empty() && _active_connections.size() >= _desired_number_of_connections)
+        {
+          fc::time_point quality_grace_threshold = fc::time_point::now() - fc::seconds(GRAPHENE_NET_PEER_QUALITY_GRACE_PERIOD_SEC);
+          std::vector<std::pair<double, peer_connection_ptr> > scored_peers;
+          for (const peer_connection_ptr& active_peer : _active_connections)
+            scored_peers.emplace_back(active_peer->get_quality_score(), active_peer);
+          std::sort(scored_peers.begin(), scored_peers.end(),
+                    [](const std::pair<double, peer_connection_ptr>& a, const std::pair<double, peer_connection_ptr>& b) { return a.first < b.first; });
+          double median_quality_score = scored_peers[scored_peers.size() / 2].first;
+          for (const auto& scored_peer : scored_peers)
+          {
+            if (scored_peer.first >= GRAPHENE_NET_PEER_QUALITY_REPLACEMENT_RATIO * median_quality_score)
+              break;
+            const peer_connection_ptr& peer = scored_peer.second;
+            if (peer->get_connection_time() < quality_grace_threshold &&
+                !peer->we_need_sync_items_from_peer &&
+                std::find(peers_to_disconnect_gently.begin(), peers_to_disconnect_gently.end(), peer) == peers_to_disconnect_gently.end() &&
+                std::find(peers_to_disconnect_forcibly.begin(), peers_to_disconnect_forcibly.end(), peer) == peers_to_disconnect_forcibly.end())
+            {
+              wlog("Replacing the connection to peer ${peer}, its quality score ${score} is far below the median of ${median}",
+                   ("peer", peer->get_remote_endpoint())("score", scored_peer.first)("median", median_quality_score));
+              peers_to_replace.push_back(peer);
+              break;
+            }
+          }
+        }
+
         fc::time_point closing_disconnect_threshold = fc::time_point::now() - fc::seconds(GRAPHENE_NET_PEER_DISCONNECT_TIMEOUT);
         for( const peer_connection_ptr& closing_peer : _closing_connections )
           if( closing_peer->connection_closed_time < closing_disconnect_threshold )
@@ -1487,6 +1656,10 @@ namespace graphene { namespace net { namespace detail {
       }
       peers_to_disconnect_gently.clear();
 
+      for( const peer_connection_ptr& peer : peers_to_replace )
+        disconnect_from_peer( peer.get(), "Replacing a connection that serves me poorly", false );
+      peers_to_replace.clear();
+
       for( const peer_connection_ptr& peer : peers_to_send_keep_alive )
         peer->send_message(current_time_request_message(),
                            offsetof(current_time_request_message, request_sent_time));
@@ -1811,6 +1984,15 @@ namespace graphene { namespace net { namespace detail {
       case core_message_type_enum::get_current_connections_reply_message_type:
         on_get_current_connections_reply_message(originating_peer, received_message.as<get_current_connections_reply_message>());
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::get_compact_block_transactions_message_type:
+        on_get_compact_block_transactions_message(originating_peer, received_message.as<get_compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::compact_block_transactions_message_type:
+        on_compact_block_transactions_message(originating_peer, received_message.as<compact_block_transactions_message>());
+        break;
 
       default:
         // ignore any message in between core_message_type_first and _last that we don't handle above
@@ -1853,6 +2035,8 @@ namespace graphene { namespace net { namespace detail {
 
       if (!_hard_fork_block_numbers.empty())
         user_data["last_known_fork_block_number"] = _hard_fork_block_numbers.back();
+      user_data["compact_blocks"] = true;
+      user_data["authenticated_encryption"] = "aes-256-gcm";
 
       return user_data;
     }
@@ -1876,6 +2060,10 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>(1);
+      if (user_data.contains("compact_blocks"))
+        originating_peer->supports_compact_blocks = user_data["compact_blocks"].as_bool();
+      if (user_data.contains("authenticated_encryption"))
+        originating_peer->supports_authenticated_encryption = user_data["authenticated_encryption"].as_string() == "aes-256-gcm";
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2069,6 +2257,9 @@ namespace graphene { namespace net { namespace detail {
           {
             originating_peer->their_state = peer_connection::their_connection_state::connection_accepted;
             originating_peer->send_message(message(connection_accepted_message()));
+            // the peer switches how it reads from us when it gets the connection_accepted
+            if (originating_peer->supports_authenticated_encryption)
+              originating_peer->start_authenticated_sending_after_queued_messages();
             dlog("Received a hello_message from peer ${peer}, sending reply to accept connection",
                  ("peer", originating_peer->get_remote_endpoint()));
           }
@@ -2096,6 +2287,9 @@ namespace graphene { namespace net { namespace detail {
     {
       VERIFY_CORRECT_THREAD();
       dlog("Received a connection_accepted in response to my \"hello\" from ${peer}", ("peer", originating_peer->get_remote_endpoint()));
+      // having seen our hello, the peer sends everything after this with authenticated encryption
+      if (originating_peer->supports_authenticated_encryption)
+        originating_peer->start_authenticated_receiving();
       originating_peer->negotiation_status = peer_connection::connection_negotiation_status::peer_connection_accepted;
       originating_peer->our_state = peer_connection::our_connection_state::connection_accepted;
       originating_peer->send_message(address_request_message());
@@ -2571,19 +2765,26 @@ namespace graphene { namespace net { namespace detail {
                ("is_first", is_first_item_for_other_peer)("size", item_hashes_received.size()));
           if (!is_first_item_for_other_peer)
           {
-            while (!item_hashes_received.empty() &&
-                   _delegate->has_item(item_id(blockchain_item_ids_inventory_message_received.item_type,
-                                               item_hashes_received.front())))
+            // ask the delegate about the whole list at once rather than one item at a time
+            std::vector<item_id> items_received;
+            items_received.reserve(item_hashes_received.size());
+            for (const item_hash_t& item_hash : item_hashes_received)
+              items_received.emplace_back(blockchain_item_ids_inventory_message_received.item_type, item_hash);
+            std::vector<bool> delegate_has_items = _delegate->has_items(items_received);
+
+            size_t items_already_seen = 0;
+            while (items_already_seen < delegate_has_items.size() && delegate_has_items[items_already_seen])
+              ++items_already_seen;
+            if (items_already_seen > 0)
             {
-              assert(item_hashes_received.front() != item_hash_t());
-              originating_peer->last_block_delegate_has_seen = item_hashes_received.front();
-              originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(item_hashes_received.front());
-              dlog("popping item because delegate has already seen it.  peer ${peer}'s last block the delegate has seen is now ${block_id} (actual block #${actual_block_num})",
+              assert(item_hashes_received[items_already_seen - 1] != item_hash_t());
+              originating_peer->last_block_delegate_has_seen = item_hashes_received[items_already_seen - 1];
+              originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(originating_peer->last_block_delegate_has_seen);
+              dlog("popping ${count} items because delegate has already seen them.  peer ${peer}'s last block the delegate has seen is now ${block_id}",
+                   ("count", items_already_seen)
                    ("peer", originating_peer->get_remote_endpoint())
-                   ("block_id", originating_peer->last_block_delegate_has_seen)
-                   ("actual_block_num", _delegate->get_block_number(item_hashes_received.front())));
-
-              item_hashes_received.pop_front();
+                   ("block_id", originating_peer->last_block_delegate_has_seen));
+              item_hashes_received.erase(item_hashes_received.begin(), item_hashes_received.begin() + items_already_seen);
             }
             dlog("after removing all items we have already seen, item_hashes_received.size() = ${size}", ("size", item_hashes_received.size()));
           }
@@ -2706,7 +2907,7 @@ namespace graphene { namespace net { namespace detail {
     {
       try
       {
-        return _message_cache.get_message(item.item_hash);
+        return *_message_cache.get_message(item.item_hash);
       }
       catch (fc::key_not_found_exception&)
       {}
@@ -2727,20 +2928,36 @@ namespace graphene { namespace net { namespace detail {
            ("type", fetch_items_message_received.item_type)
            ("endpoint", originating_peer->get_remote_endpoint()));
 
-      fc::optional<message> last_block_message_sent;
-
-      std::list<message> reply_messages;
+      // blocks from the chain are queued by id alone and only packed when they reach the front of the queue,
+      // everything else is queued as a message, shared with the message cache if it came from there
+      struct reply
+      {
+        item_id item_to_send;
+        shared_message_ptr message_to_send;
+        fc::optional<item_hash_t> block_id_sent;
+      };
+      std::vector<reply> replies;
+      replies.reserve(fetch_items_message_received.items_to_fetch.size());
+      // the items that are not in our cache are looked up with a single call to the delegate
+      std::vector<item_id> items_to_fetch_from_delegate;
+      std::vector<size_t> reply_indexes_for_delegate_items;
       for (const item_hash_t& item_hash : fetch_items_message_received.items_to_fetch)
       {
         try
         {
-          message requested_message = _message_cache.get_message(item_hash);
+          shared_message_ptr requested_message = _message_cache.get_message(item_hash);
           dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                ("endpoint", originating_peer->get_remote_endpoint())
-               ("id", requested_message.id()));
-          reply_messages.push_back(requested_message);
+               ("id", item_hash));
+          reply cached_reply{item_id(), requested_message, fc::optional<item_hash_t>()};
           if (fetch_items_message_received.item_type == block_message_type)
-            last_block_message_sent = requested_message;
+          {
+            cached_reply.block_id_sent = _message_cache.get_message_contents_hash(item_hash);
+            // a recent block, the peer probably has most of its transactions already
+            if (originating_peer->supports_compact_blocks)
+              cached_reply.message_to_send = std::make_shared<const message>(make_compact_block_for_peer(originating_peer, item_hash));
+          }
+          replies.push_back(std::move(cached_reply));
           continue;
         }
         catch (fc::key_not_found_exception&)
@@ -2749,40 +2966,67 @@ namespace graphene { namespace net { namespace detail {
         }
 
         item_id item_to_fetch(fetch_items_message_received.item_type, item_hash);
-        try
+        items_to_fetch_from_delegate.push_back(item_to_fetch);
+        reply_indexes_for_delegate_items.push_back(replies.size());
+        replies.push_back(reply{item_to_fetch, shared_message_ptr(), fc::optional<item_hash_t>()});
+      }
+
+      if (!items_to_fetch_from_delegate.empty())
+      {
+        if (fetch_items_message_received.item_type == block_message_type)
         {
-          message requested_message = _delegate->get_item(item_to_fetch);
-          dlog("received item request from peer ${endpoint}, returning the item from delegate with id ${id} size ${size}",
-               ("id", requested_message.id())
-               ("size", requested_message.size)
-               ("endpoint", originating_peer->get_remote_endpoint()));
-          reply_messages.push_back(requested_message);
-          if (fetch_items_message_received.item_type == block_message_type)
-            last_block_message_sent = requested_message;
-          continue;
+          // sync blocks are requested by block_id
+          std::vector<bool> delegate_has_items = _delegate->has_items(items_to_fetch_from_delegate);
+          for (size_t i = 0; i < items_to_fetch_from_delegate.size(); ++i)
+          {
+            reply& delegate_reply = replies[reply_indexes_for_delegate_items[i]];
+            if (delegate_has_items[i])
+            {
+              dlog("received item request from peer ${endpoint}, returning block ${id} from delegate",
+                   ("id", delegate_reply.item_to_send.item_hash)("endpoint", originating_peer->get_remote_endpoint()));
+              delegate_reply.block_id_sent = delegate_reply.item_to_send.item_hash;
+            }
+            else
+              delegate_reply.message_to_send = std::make_shared<const message>(item_not_available_message(delegate_reply.item_to_send));
+          }
         }
-        catch (fc::key_not_found_exception&)
+        else
         {
-          reply_messages.push_back(item_not_available_message(item_to_fetch));
-          dlog("received item request from peer ${endpoint} but we don't have it",
-               ("endpoint", originating_peer->get_remote_endpoint()));
+          std::vector<fc::optional<message>> delegate_items = _delegate->get_items(items_to_fetch_from_delegate);
+          for (size_t i = 0; i < items_to_fetch_from_delegate.size(); ++i)
+          {
+            reply& delegate_reply = replies[reply_indexes_for_delegate_items[i]];
+            if (delegate_items[i])
+            {
+              dlog("received item request from peer ${endpoint}, returning the item from delegate with id ${id} size ${size}",
+                   ("id", delegate_items[i]->id())
+                   ("size", delegate_items[i]->size)
+                   ("endpoint", originating_peer->get_remote_endpoint()));
+              delegate_reply.message_to_send = std::make_shared<const message>(std::move(*delegate_items[i]));
+            }
+            else
+              delegate_reply.message_to_send = std::make_shared<const message>(item_not_available_message(delegate_reply.item_to_send));
+          }
         }
       }
 
       // if we sent them a block, update our record of the last block they've seen accordingly
-      if (last_block_message_sent)
+      fc::optional<item_hash_t> last_block_id_sent;
+      for (const reply& queued_reply : replies)
+        if (queued_reply.block_id_sent)
+          last_block_id_sent = queued_reply.block_id_sent;
+      if (last_block_id_sent)
       {
-        graphene::net::block_message block = last_block_message_sent->as<graphene::net::block_message>();
-        originating_peer->last_block_delegate_has_seen = block.block_id;
-        originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(block.block_id);
+        originating_peer->last_block_delegate_has_seen = *last_block_id_sent;
+        originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(*last_block_id_sent);
       }
 
-      for (const message& reply : reply_messages)
+      for (const reply& queued_reply : replies)
       {
-        if (reply.msg_type == block_message_type)
-          originating_peer->send_item(item_id(block_message_type, reply.as<graphene::net::block_message>().block_id));
+        if (queued_reply.message_to_send)
+          originating_peer->send_message(queued_reply.message_to_send);
         else
-          originating_peer->send_message(reply);
+          originating_peer->send_item(queued_reply.item_to_send);
       }
     }
 
@@ -2790,10 +3034,12 @@ namespace graphene { namespace net { namespace detail {
     {
       VERIFY_CORRECT_THREAD();
       const item_id& requested_item = item_not_available_message_received.requested_item;
+      ++originating_peer->items_not_available_count;
       auto regular_item_iter = originating_peer->items_requested_from_peer.find(requested_item);
       if (regular_item_iter != originating_peer->items_requested_from_peer.end())
       {
         originating_peer->items_requested_from_peer.erase( regular_item_iter );
+        originating_peer->compact_blocks_being_assembled.erase( requested_item.item_hash );
         originating_peer->inventory_peer_advertised_to_us.erase( requested_item );
         if (is_item_in_any_peers_inventory(requested_item))
           _items_to_fetch.insert(prioritized_item_id(requested_item, _items_to_fetch_sequence_counter++));
@@ -2821,6 +3067,211 @@ namespace graphene { namespace net { namespace detail {
       dlog("Peer doesn't have an item we're looking for, which is fine because we weren't looking for it");
     }
 
+    const node_impl::compact_block_template& node_impl::get_compact_block_template( const item_hash_t& block_message_hash )
+    {
+      VERIFY_CORRECT_THREAD();
+      auto iter = _recent_compact_blocks.find( block_message_hash );
+      if( iter != _recent_compact_blocks.end() )
+        return iter->second;
+
+      graphene::net::block_message full_block = _message_cache.get_message( block_message_hash )->as<graphene::net::block_message>();
+      compact_block_template result;
+      result.compact_block.block_message_hash = block_message_hash;
+      result.compact_block.block_id = full_block.block_id;
+      result.compact_block.transactions.reserve( full_block.block.transactions.size() );
+      result.transactions.reserve( full_block.block.transactions.size() );
+      result.transaction_message_hashes.reserve( full_block.block.transactions.size() );
+      for( graphene::chain::processed_transaction& processed : full_block.block.transactions )
+      {
+        compact_block_transaction compact_transaction;
+        compact_transaction.operation_results = std::move( processed.operation_results );
+        result.transactions.push_back( std::move( static_cast<signed_transaction&>( processed ) ) );
+        result.transaction_message_hashes.push_back( message( trx_message( result.transactions.back() ) ).id() );
+        compact_transaction.short_id = short_transaction_id( result.transaction_message_hashes.back() );
+        result.compact_block.transactions.push_back( std::move( compact_transaction ) );
+      }
+      full_block.block.transactions.clear();
+      result.compact_block.block = std::move( full_block.block );
+
+      if( _recent_compact_blocks.size() >= GRAPHENE_NET_RECENT_COMPACT_BLOCKS )
+      {
+        auto oldest = _recent_compact_blocks.begin();
+        for( auto candidate = _recent_compact_blocks.begin(); candidate != _recent_compact_blocks.end(); ++candidate )
+          if( candidate->second.compact_block.block.block_num() < oldest->second.compact_block.block.block_num() )
+            oldest = candidate;
+        _recent_compact_blocks.erase( oldest );
+      }
+      return _recent_compact_blocks.emplace( block_message_hash, std::move( result ) ).first->second;
+    }
+
+    compact_block_message node_impl::make_compact_block_for_peer( peer_connection* peer, const item_hash_t& block_message_hash )
+    {
+      VERIFY_CORRECT_THREAD();
+      const compact_block_template& block_template = get_compact_block_template( block_message_hash );
+      compact_block_message result = block_template.compact_block;
+      // send the transactions in full that the peer neither offered us nor was offered by us
+      for( size_t i = 0; i < block_template.transactions.size(); ++i )
+      {
+        item_id transaction_item( trx_message_type, block_template.transaction_message_hashes[i] );
+        if( peer->inventory_peer_advertised_to_us.find( transaction_item ) == peer->inventory_peer_advertised_to_us.end() &&
+            peer->inventory_advertised_to_peer.find( transaction_item ) == peer->inventory_advertised_to_peer.end() )
+          result.transactions[i].trx = block_template.transactions[i];
+      }
+      return result;
+    }
+
+    void node_impl::on_compact_block_message( peer_connection* originating_peer,
+                                              const compact_block_message& compact_block_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = compact_block_message_received.block_message_hash;
+      if( originating_peer->items_requested_from_peer.find( item_id( block_message_type, block_message_hash ) ) ==
+            originating_peer->items_requested_from_peer.end() ||
+          originating_peer->compact_blocks_being_assembled.find( block_message_hash ) !=
+            originating_peer->compact_blocks_being_assembled.end() )
+      {
+        wlog( "received a compact block ${block_id} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+              ("endpoint", originating_peer->get_remote_endpoint())
+              ("block_id", compact_block_message_received.block_id) );
+        fc::exception detailed_error( FC_LOG_MESSAGE(error, "You sent me a block that I didn't ask for, block_id: ${block_id}",
+                                                     ("block_id", compact_block_message_received.block_id)) );
+        disconnect_from_peer( originating_peer, "You sent me a block that I didn't ask for", true, detailed_error );
+        return;
+      }
+
+      peer_connection::partial_compact_block partial_block;
+      partial_block.compact_block = compact_block_message_received;
+      partial_block.transactions.resize( partial_block.compact_block.transactions.size() );
+      for( uint32_t i = 0; i < partial_block.transactions.size(); ++i )
+      {
+        compact_block_transaction& compact_transaction = partial_block.compact_block.transactions[i];
+        if( compact_transaction.trx )
+        {
+          partial_block.transactions[i] = std::move( *compact_transaction.trx );
+          compact_transaction.trx.reset();
+        }
+        else
+        {
+          partial_block.transactions[i] = _message_cache.find_transaction( compact_transaction.short_id );
+          if( !partial_block.transactions[i] )
+            partial_block.requested_indexes.push_back( i );
+        }
+      }
+
+      dlog( "received compact block ${block_id} with ${n} transactions from peer ${endpoint}, ${missing} of them missing",
+            ("block_id", partial_block.compact_block.block_id)("n", partial_block.transactions.size())
+            ("missing", partial_block.requested_indexes.size())("endpoint", originating_peer->get_remote_endpoint()) );
+      if( partial_block.requested_indexes.empty() )
+        assemble_compact_block( originating_peer, block_message_hash, std::move( partial_block ) );
+      else
+      {
+        originating_peer->send_message( get_compact_block_transactions_message( block_message_hash, partial_block.requested_indexes ) );
+        originating_peer->compact_blocks_being_assembled[block_message_hash] = std::move( partial_block );
+      }
+    }
+
+    void node_impl::on_get_compact_block_transactions_message( peer_connection* originating_peer,
+                                                               const get_compact_block_transactions_message& get_compact_block_transactions_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = get_compact_block_transactions_message_received.block_message_hash;
+      compact_block_transactions_message reply;
+      reply.block_message_hash = block_message_hash;
+      try
+      {
+        const compact_block_template& block_template = get_compact_block_template( block_message_hash );
+        reply.transactions.reserve( get_compact_block_transactions_message_received.transaction_indexes.size() );
+        for( uint32_t index : get_compact_block_transactions_message_received.transaction_indexes )
+        {
+          if( index >= block_template.transactions.size() )
+          {
+            disconnect_from_peer( originating_peer, "You asked me for a transaction that isn't in the block", true,
+                                  fc::exception( FC_LOG_MESSAGE(error, "Transaction ${index} is not in block ${block_id}",
+                                                                ("index", index)("block_id", block_template.compact_block.block_id)) ) );
+            return;
+          }
+          reply.transactions.push_back( block_template.transactions[index] );
+        }
+      }
+      catch( const fc::key_not_found_exception& )
+      {
+        // the block has expired from our cache since we sent it, the peer will fetch it again
+        originating_peer->send_message( item_not_available_message( item_id( block_message_type, block_message_hash ) ) );
+        return;
+      }
+      originating_peer->send_message( reply );
+    }
+
+    void node_impl::on_compact_block_transactions_message( peer_connection* originating_peer,
+                                                           const compact_block_transactions_message& compact_block_transactions_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = compact_block_transactions_message_received.block_message_hash;
+      auto iter = originating_peer->compact_blocks_being_assembled.find( block_message_hash );
+      if( iter == originating_peer->compact_blocks_being_assembled.end() )
+      {
+        dlog( "received transactions for a compact block I'm no longer assembling from peer ${endpoint}",
+              ("endpoint", originating_peer->get_remote_endpoint()) );
+        return;
+      }
+
+      peer_connection::partial_compact_block partial_block = std::move( iter->second );
+      originating_peer->compact_blocks_being_assembled.erase( iter );
+      const auto& transactions = compact_block_transactions_message_received.transactions;
+      if( transactions.size() != partial_block.requested_indexes.size() )
+      {
+        disconnect_from_peer( originating_peer, "You sent me the wrong number of transactions for a compact block", true,
+                              fc::exception( FC_LOG_MESSAGE(error, "Asked for ${asked} transactions of block ${block_id}, received ${received}",
+                                                            ("asked", partial_block.requested_indexes.size())("received", transactions.size())
+                                                            ("block_id", partial_block.compact_block.block_id)) ) );
+        return;
+      }
+      for( size_t i = 0; i < transactions.size(); ++i )
+        partial_block.transactions[partial_block.requested_indexes[i]] = transactions[i];
+      assemble_compact_block( originating_peer, block_message_hash, std::move( partial_block ) );
+    }
+
+    void node_impl::assemble_compact_block( peer_connection* originating_peer, const item_hash_t& block_message_hash,
+                                            peer_connection::partial_compact_block&& partial_block )
+    {
+      VERIFY_CORRECT_THREAD();
+      graphene::net::block_message assembled_block;
+      assembled_block.block = partial_block.compact_block.block;
+      assembled_block.block_id = partial_block.compact_block.block_id;
+      assembled_block.block.transactions.reserve( partial_block.transactions.size() );
+      for( size_t i = 0; i < partial_block.transactions.size(); ++i )
+      {
+        assembled_block.block.transactions.emplace_back( *partial_block.transactions[i] );
+        assembled_block.block.transactions.back().operation_results = partial_block.compact_block.transactions[i].operation_results;
+      }
+
+      // the hash covers every byte of the block, so a match means we have exactly the block we asked for
+      message assembled_message( assembled_block );
+      if( assembled_message.id() == block_message_hash )
+      {
+        process_block_message( originating_peer, assembled_message, block_message_hash );
+        return;
+      }
+
+      const size_t transaction_count = partial_block.transactions.size();
+      if( partial_block.requested_indexes.size() < transaction_count )
+      {
+        // a transaction from our cache must have collided with a short id, ask the peer for all of them
+        wlog( "compact block ${block_id} from peer ${endpoint} didn't match after filling in transactions from my cache, fetching all of them",
+              ("block_id", partial_block.compact_block.block_id)("endpoint", originating_peer->get_remote_endpoint()) );
+        partial_block.requested_indexes.resize( transaction_count );
+        for( uint32_t i = 0; i < transaction_count; ++i )
+          partial_block.requested_indexes[i] = i;
+        originating_peer->send_message( get_compact_block_transactions_message( block_message_hash, partial_block.requested_indexes ) );
+        originating_peer->compact_blocks_being_assembled[block_message_hash] = std::move( partial_block );
+        return;
+      }
+
+      disconnect_from_peer( originating_peer, "You sent me a compact block that doesn't match the block I asked for", true,
+                            fc::exception( FC_LOG_MESSAGE(error, "Compact block ${block_id} doesn't hash to ${hash}",
+                                                          ("block_id", partial_block.compact_block.block_id)("hash", block_message_hash)) ) );
+    }
+
     void node_impl::on_item_ids_inventory_message(peer_connection* originating_peer, const item_ids_inventory_message& item_ids_inventory_message_received)
     {
       VERIFY_CORRECT_THREAD();
@@ -2833,6 +3284,7 @@ namespace graphene { namespace net { namespace detail {
       for( const item_hash_t& item_hash : item_ids_inventory_message_received.item_hashes_available )
       {
         item_id advertised_item_id(item_ids_inventory_message_received.item_type, item_hash);
+        ++originating_peer->inventory_items_advertised_count;
         bool we_advertised_this_item_to_a_peer = false;
         bool we_requested_this_item_from_a_peer = false;
         for (const peer_connection_ptr peer : _active_connections)
@@ -2870,6 +3322,7 @@ namespace graphene { namespace net { namespace detail {
               if (items_to_fetch_iter == _items_to_fetch.get<item_id_index>().end())
               {
                 // it's new to us
+                ++originating_peer->inventory_items_new_count;
                 _items_to_fetch.insert(prioritized_item_id(advertised_item_id, _items_to_fetch_sequence_counter++));
                 dlog("adding item ${item_hash} from inventory message to our list of items to fetch",
                      ("item_hash", item_hash));
@@ -2952,6 +3405,10 @@ namespace graphene { namespace net { namespace detail {
           if (updated_peer_record)
           {
             updated_peer_record->last_seen_time = fc::time_point::now();
+            double quality_score = originating_peer->get_quality_score();
+            updated_peer_record->quality_score = updated_peer_record->quality_score > 0 ?
+                                                   0.5 * updated_peer_record->quality_score + 0.5 * quality_score :
+                                                   quality_score;
             _potential_peer_db.update_entry(*updated_peer_record);
           }
         }
@@ -3008,9 +3465,70 @@ namespace graphene { namespace net { namespace detail {
       schedule_peer_for_deletion(originating_peer_ptr);
     }
 
-    void node_impl::send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send)
+    void node_impl::send_sync_blocks_to_node_delegate()
+    {
+      VERIFY_CORRECT_THREAD();
+      // also if handling the results fails, so that the backlog sends what is left
+      auto resume_backlog = fc::make_scoped_exit([this]() { trigger_process_backlog_of_sync_blocks(); });
+      while (!_sync_blocks_to_send_to_delegate.empty())
+      {
+        size_t count = std::min<size_t>(_sync_blocks_to_send_to_delegate.size(), MAXIMUM_NUMBER_OF_SYNC_BLOCKS_PER_DELEGATE_CALL);
+        std::vector<graphene::net::block_message> blocks_to_send(std::make_move_iterator(_sync_blocks_to_send_to_delegate.begin()),
+                                                                 std::make_move_iterator(_sync_blocks_to_send_to_delegate.begin() + count));
+        _sync_blocks_to_send_to_delegate.erase(_sync_blocks_to_send_to_delegate.begin(), _sync_blocks_to_send_to_delegate.begin() + count);
+        dlog("in send_sync_blocks_to_node_delegate(), sending ${count} blocks", ("count", count));
+
+        // one round trip to the delegate's thread for these blocks, which are no longer in flight afterwards
+        // however it ends
+        std::vector<fc::exception_ptr> results;
+        {
+          auto release_blocks = fc::make_scoped_exit([this, count]() { _number_of_sync_blocks_being_handled -= count; });
+          try
+          {
+            results = _delegate->handle_blocks(blocks_to_send, true);
+            FC_ASSERT(results.size() == blocks_to_send.size(), "node_delegate::handle_blocks() returned the wrong number of results");
+          }
+          catch (const fc::canceled_exception&)
+          {
+            throw;
+          }
+          catch (const fc::exception& e)
+          {
+            results.assign(count, e.dynamic_copy_exception());
+          }
+          catch (const std::exception& e)
+          {
+            results.assign(count, fc::unhandled_exception(FC_LOG_MESSAGE(warn, "${e}", ("e", e.what()))).dynamic_copy_exception());
+          }
+          catch (...)
+          {
+            results.assign(count, fc::unhandled_exception(FC_LOG_MESSAGE(warn, "${e}", ("e", fc::except_str()))).dynamic_copy_exception());
+          }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+          on_sync_block_handled(blocks_to_send[i], results[i]);
+
+        // these blocks are in flight no more, there may be room to queue more of the backlog
+        trigger_process_backlog_of_sync_blocks();
+      }
+      dlog("Leaving send_sync_blocks_to_node_delegate");
+    }
+
+    void node_impl::trigger_send_sync_blocks_to_node_delegate()
+    {
+      VERIFY_CORRECT_THREAD();
+      if (!_node_is_shutting_down && !_sync_blocks_to_send_to_delegate.empty() &&
+          (!_send_sync_blocks_to_node_delegate_done.valid() || _send_sync_blocks_to_node_delegate_done.ready()))
+      {
+        _send_sync_blocks_to_node_delegate_done = fc::async([this](){ send_sync_blocks_to_node_delegate(); },
+                                                            "send_sync_blocks_to_node_delegate");
+        _handle_message_calls_in_progress.push_back(_send_sync_blocks_to_node_delegate_done);
+      }
+    }
+
+    void node_impl::on_sync_block_handled(const graphene::net::block_message& block_message_to_send, const fc::exception_ptr& handle_block_exception)
     {
-      dlog("in send_sync_block_to_node_delegate()");
       bool client_accepted_block = false;
       bool discontinue_fetching_blocks_from_peer = false;
 
@@ -3018,8 +3536,8 @@ namespace graphene { namespace net { namespace detail {
 
       try
       {
-        std::vector<fc::uint160_t> contained_transaction_message_ids;
-        _delegate->handle_block(block_message_to_send, true, contained_transaction_message_ids);
+        if (handle_block_exception)
+          handle_block_exception->dynamic_rethrow_exception();
         ilog("Successfully pushed sync block ${num} (id:${id})",
              ("num", block_message_to_send.block.block_num())
              ("id", block_message_to_send.block_id));
@@ -3168,14 +3686,6 @@ namespace graphene { namespace net { namespace detail {
 
       for (const peer_connection_ptr& peer : peers_we_need_to_sync_to)
         start_synchronizing_with_peer(peer);
-
-      dlog("Leaving send_sync_block_to_node_delegate");
-
-      if (// _suspend_fetching_sync_blocks && <-- you can use this if "maximum_number_of_blocks_to_handle_at_one_time" == "maximum_number_of_sync_blocks_to_prefetch"
-          !_node_is_shutting_down &&
-          (!_process_backlog_of_sync_blocks_done.valid() || _process_backlog_of_sync_blocks_done.ready()))
-        _process_backlog_of_sync_blocks_done = fc::async([=](){ process_backlog_of_sync_blocks(); },
-                                                         "process_backlog_of_sync_blocks");
     }
 
     void node_impl::process_backlog_of_sync_blocks()
@@ -3192,18 +3702,20 @@ namespace graphene { namespace net { namespace detail {
       }
 
       dlog("in process_backlog_of_sync_blocks");
-      if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
+      // blocks left over by a sender that stopped early are sent first
+      trigger_send_sync_blocks_to_node_delegate();
+      if (_number_of_sync_blocks_being_handled >= _maximum_number_of_blocks_to_handle_at_one_time)
       {
         dlog("leaving process_backlog_of_sync_blocks because we're already processing too many blocks");
         return; // we will be rescheduled when the next block finishes its processing
       }
-      dlog("currently ${count} blocks in the process of being handled", ("count", _handle_message_calls_in_progress.size()));
+      dlog("currently ${count} blocks in the process of being handled", ("count", _number_of_sync_blocks_being_handled));
 
 
       if (_suspend_fetching_sync_blocks)
       {
         dlog("resuming processing sync block backlog because we only ${count} blocks in progress",
-             ("count", _handle_message_calls_in_progress.size()));
+             ("count", _number_of_sync_blocks_being_handled));
         _suspend_fetching_sync_blocks = false;
       }
 
@@ -3261,11 +3773,9 @@ namespace graphene { namespace net { namespace detail {
             if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
                           received_block_iter->block_id) == _most_recent_blocks_accepted.end())
             {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
+              _sync_blocks_to_send_to_delegate.push_back(std::move(*received_block_iter));
               _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
+              ++_number_of_sync_blocks_being_handled;
               ++blocks_processed;
               block_processed_this_iteration = true;
             }
@@ -3276,18 +3786,21 @@ namespace graphene { namespace net { namespace detail {
           } // end if potential_first_block
         } // end for each block in _received_sync_items
 
-        if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
+        if (_number_of_sync_blocks_being_handled >= _maximum_number_of_blocks_to_handle_at_one_time)
         {
           dlog("stopping processing sync block backlog because we have ${count} blocks in progress",
-               ("count", _handle_message_calls_in_progress.size()));
+               ("count", _number_of_sync_blocks_being_handled));
           //ulog("stopping processing sync block backlog because we have ${count} blocks in progress, total on hand: ${received}",
-          //     ("count", _handle_message_calls_in_progress.size())("received", _received_sync_items.size()));
+          //     ("count", _number_of_sync_blocks_being_handled)("received", _received_sync_items.size()));
           if (_received_sync_items.size() >= _maximum_number_of_sync_blocks_to_prefetch)
             _suspend_fetching_sync_blocks = true;
           break;
         }
       } while (block_processed_this_iteration);
 
+      // the blocks ready to be pushed are handed to the delegate in order, see send_sync_blocks_to_node_delegate()
+      trigger_send_sync_blocks_to_node_delegate();
+
       dlog("leaving process_backlog_of_sync_blocks, ${count} processed", ("count", blocks_processed));
 
       if (!_suspend_fetching_sync_blocks)
@@ -3363,7 +3876,10 @@ namespace graphene { namespace net { namespace detail {
             trigger_advertise_inventory_loop();
         }
         else
+        {
           dlog( "Already received and accepted this block (presumably through sync mechanism), treating it as accepted" );
+          ++originating_peer->stale_items_count;
+        }
 
         dlog( "client validated the block, advertising it to other peers" );
 
@@ -3437,6 +3953,7 @@ namespace graphene { namespace net { namespace detail {
 
         disconnect_exception = e;
         disconnect_reason = "You offered me a block that I have deemed to be invalid";
+        ++originating_peer->invalid_items_count;
 
         peers_to_disconnect.insert( originating_peer->shared_from_this() );
         for (const peer_connection_ptr& peer : _active_connections)
@@ -3472,6 +3989,7 @@ namespace graphene { namespace net { namespace detail {
       auto item_iter = originating_peer->items_requested_from_peer.find(item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
+        originating_peer->record_item_received(item_iter->second);
         originating_peer->items_requested_from_peer.erase(item_iter);
         process_block_during_normal_operation(originating_peer, block_message_to_process, message_hash);
         if (originating_peer->idle())
@@ -3485,8 +4003,14 @@ namespace graphene { namespace net { namespace detail {
                                                                                             block_message_to_process.block_id));
         if (sync_item_iter != originating_peer->sync_items_requested_from_peer.end())
         {
+          originating_peer->record_item_received(sync_item_iter->second);
           originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
           _active_sync_requests.erase(block_message_to_process.block_id);
+          originating_peer->last_sync_item_received_time = fc::time_point::now();
+          if (originating_peer->sync_window_first_item_time < originating_peer->sync_window_request_time)
+            originating_peer->sync_window_first_item_time = originating_peer->last_sync_item_received_time;
+          if (originating_peer->sync_items_requested_from_peer.empty())
+            adjust_sync_request_window(originating_peer->shared_from_this());
           process_block_during_sync(originating_peer, block_message_to_process, message_hash);
           if (originating_peer->idle())
           {
@@ -3798,6 +4322,7 @@ namespace graphene { namespace net { namespace detail {
       }
       else
       {
+        originating_peer->record_item_received(iter->second);
         originating_peer->items_requested_from_peer.erase( iter );
         if (originating_peer->idle())
           trigger_fetch_items_loop();
@@ -3823,6 +4348,7 @@ namespace graphene { namespace net { namespace detail {
         catch ( const fc::exception& e )
         {
           wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", e) );
+          ++originating_peer->invalid_items_count;
           // record it so we don't try to fetch this item again
           _recently_failed_items.insert(peer_connection::timestamped_item_id(item_id(message_to_process.msg_type, message_hash ), fc::time_point::now()));
           return;
@@ -4775,6 +5301,56 @@ namespace graphene { namespace net { namespace detail {
       return _actual_listening_endpoint;
     }
 
+    std::vector<peer_metrics> node_impl::get_peer_metrics() const
+    {
+      VERIFY_CORRECT_THREAD();
+      std::vector<peer_metrics> result;
+      result.reserve(_active_connections.size());
+      fc::time_point now = fc::time_point::now();
+      for (const peer_connection_ptr& peer : _active_connections)
+      {
+        ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+
+        peer_metrics metrics;
+        fc::optional<fc::ip::endpoint> endpoint = peer->get_remote_endpoint();
+        if (endpoint)
+          metrics.host = *endpoint;
+        metrics.node_id = peer->node_id;
+        metrics.user_agent = peer->user_agent;
+        metrics.connection_duration = (uint32_t)((now - peer->get_connection_time()).to_seconds());
+
+        for (const auto& type_and_counters : peer->message_counters_by_type)
+        {
+          message_type_metrics message_metrics;
+          message_metrics.message_type = fc::reflector<core_message_type_enum>::to_fc_string(type_and_counters.first);
+          message_metrics.messages_sent = type_and_counters.second.messages_sent;
+          message_metrics.bytes_sent = type_and_counters.second.bytes_sent;
+          message_metrics.messages_received = type_and_counters.second.messages_received;
+          message_metrics.bytes_received = type_and_counters.second.bytes_received;
+          metrics.messages.push_back(message_metrics);
+        }
+        std::sort(metrics.messages.begin(), metrics.messages.end(),
+                  [](const message_type_metrics& a, const message_type_metrics& b) {
+                    return a.bytes_sent + a.bytes_received > b.bytes_sent + b.bytes_received;
+                  });
+
+        metrics.items_requested = peer->items_requested_count;
+        metrics.items_received = peer->items_received_count;
+        metrics.items_not_available = peer->items_not_available_count;
+        metrics.item_latency_p50_us = peer->get_item_latency_percentile_us(500);
+        metrics.item_latency_p90_us = peer->get_item_latency_percentile_us(900);
+        metrics.item_latency_p99_us = peer->get_item_latency_percentile_us(990);
+        metrics.item_latency_max_us = peer->item_latency_max_us;
+        metrics.inventory_items_advertised = peer->inventory_items_advertised_count;
+        metrics.inventory_items_new = peer->inventory_items_new_count;
+        metrics.invalid_items = peer->invalid_items_count;
+        metrics.stale_items = peer->stale_items_count;
+        metrics.quality_score = peer->get_quality_score();
+        result.push_back(std::move(metrics));
+      }
+      return result;
+    }
+
     std::vector<peer_status> node_impl::get_connected_peers() const
     {
       VERIFY_CORRECT_THREAD();
@@ -4839,6 +5415,10 @@ namespace graphene { namespace net { namespace detail {
          peer_details["current_head_block"] = fc::variant( peer->last_block_delegate_has_seen, 1 );
         peer_details["current_head_block_number"] = _delegate->get_block_number(peer->last_block_delegate_has_seen);
         peer_details["current_head_block_time"] = peer->last_block_time_delegate_has_seen;
+        peer_details["sync_request_window"] = peer->sync_request_window;
+        peer_details["sync_blocks_per_second"] = peer->sync_blocks_per_second;
+        peer_details["sync_window_latency_ms"] = peer->sync_window_latency.count() / 1000;
+        peer_details["quality_score"] = peer->get_quality_score();
 
         this_peer_status.info = peer_details;
         statuses.push_back(this_peer_status);
@@ -4870,7 +5450,9 @@ namespace graphene { namespace net { namespace detail {
       }
       message_hash_type hash_of_item_to_broadcast = item_to_broadcast.id();
 
-      _message_cache.cache_message( item_to_broadcast, hash_of_item_to_broadcast, propagation_data, hash_of_message_contents );
+      // every peer fetching it from our inventory gets this same copy
+      _message_cache.cache_message( std::make_shared<const message>( item_to_broadcast ), hash_of_item_to_broadcast,
+                                    propagation_data, hash_of_message_contents );
       _new_inventory.insert( item_id(item_to_broadcast.msg_type, hash_of_item_to_broadcast ) );
       trigger_advertise_inventory_loop();
     }
@@ -5069,6 +5651,66 @@ namespace graphene { namespace net { namespace detail {
     return my->method_name(__VA_ARGS__)
 #endif // P2P_IN_DEDICATED_THREAD
 
+  std::vector<bool> node_delegate::has_items( const std::vector<net::item_id>& ids )
+  {
+    std::vector<bool> result;
+    result.reserve(ids.size());
+    for (const item_id& id : ids)
+      result.push_back(has_item(id));
+    return result;
+  }
+
+  std::vector<fc::exception_ptr> node_delegate::handle_blocks( const std::vector<graphene::net::block_message>& blk_msgs,
+                                                               bool sync_mode )
+  {
+    std::vector<fc::exception_ptr> result;
+    result.reserve(blk_msgs.size());
+    for (const graphene::net::block_message& blk_msg : blk_msgs)
+    {
+      try
+      {
+        std::vector<fc::uint160_t> contained_transaction_message_ids;
+        handle_block(blk_msg, sync_mode, contained_transaction_message_ids);
+        result.emplace_back();
+      }
+      catch (const fc::canceled_exception&)
+      {
+        throw;
+      }
+      catch (const fc::exception& e)
+      {
+        result.push_back(e.dynamic_copy_exception());
+      }
+      catch (const std::exception& e)
+      {
+        result.push_back(fc::unhandled_exception(FC_LOG_MESSAGE(warn, "${e}", ("e", e.what()))).dynamic_copy_exception());
+      }
+      catch (...)
+      {
+        result.push_back(fc::unhandled_exception(FC_LOG_MESSAGE(warn, "${e}", ("e", fc::except_str()))).dynamic_copy_exception());
+      }
+    }
+    return result;
+  }
+
+  std::vector<fc::optional<message>> node_delegate::get_items( const std::vector<item_id>& ids )
+  {
+    std::vector<fc::optional<message>> result;
+    result.reserve(ids.size());
+    for (const item_id& id : ids)
+    {
+      try
+      {
+        result.emplace_back(get_item(id));
+      }
+      catch (const fc::key_not_found_exception&)
+      {
+        result.emplace_back();
+      }
+    }
+    return result;
+  }
+
   node::node(const std::string& user_agent) :
     my(new detail::node_impl(user_agent))
   {
@@ -5134,6 +5776,11 @@ namespace graphene { namespace net { namespace detail {
     INVOKE_IN_IMPL(get_connected_peers);
   }
 
+  std::vector<peer_metrics> node::get_peer_metrics() const
+  {
+    INVOKE_IN_IMPL(get_peer_metrics);
+  }
+
   uint32_t node::get_connection_count() const
   {
     INVOKE_IN_IMPL(get_connection_count);
@@ -5229,7 +5876,8 @@ namespace graphene { namespace net { namespace detail {
   {
     node_delegate* delegate;
     fc::future<void> message_sender_task_done;
-    std::queue<message> messages_to_deliver;
+    std::queue<std::pair<message, fc::time_point> > messages_to_deliver; /// and when they arrive
+    fc::time_point link_busy_until; /// when the last message queued on this link has been sent
     node_info(node_delegate* delegate) : delegate(delegate) {}
   };
 
@@ -5248,7 +5896,9 @@ namespace graphene { namespace net { namespace detail {
     {
       try
       {
-        const message& message_to_deliver = destination_node->messages_to_deliver.front();
+        if (destination_node->messages_to_deliver.front().second > fc::time_point::now())
+          fc::usleep(destination_node->messages_to_deliver.front().second - fc::time_point::now());
+        const message& message_to_deliver = destination_node->messages_to_deliver.front().first;
         if (message_to_deliver.msg_type == trx_message_type)
           destination_node->delegate->handle_transaction(message_to_deliver.as<trx_message>());
         else if (message_to_deliver.msg_type == block_message_type)
@@ -5269,9 +5919,14 @@ namespace graphene { namespace net { namespace detail {
 
   void simulated_network::broadcast( const message& item_to_broadcast  )
   {
+    fc::time_point now = fc::time_point::now();
+    fc::microseconds transmission_time;
+    if (_bytes_per_second)
+      transmission_time = fc::microseconds((sizeof(message_header) + item_to_broadcast.size) * 1000000 / _bytes_per_second);
     for (node_info* network_node_info : network_nodes)
     {
-      network_node_info->messages_to_deliver.emplace(item_to_broadcast);
+      network_node_info->link_busy_until = std::max(network_node_info->link_busy_until, now) + transmission_time;
+      network_node_info->messages_to_deliver.emplace(item_to_broadcast, network_node_info->link_busy_until + _latency);
       if (!network_node_info->message_sender_task_done.valid() || network_node_info->message_sender_task_done.ready())
         network_node_info->message_sender_task_done = fc::async([=](){ message_sender(network_node_info); }, "simulated_network_sender");
     }
@@ -5387,6 +6042,11 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(has_item, id);
     }
 
+    std::vector<bool> statistics_gathering_node_delegate_wrapper::has_items( const std::vector<net::item_id>& ids )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(has_items, ids);
+    }
+
     void statistics_gathering_node_delegate_wrapper::handle_message( const message& message_to_handle )
     {
       INVOKE_AND_COLLECT_STATISTICS(handle_message, message_to_handle);
@@ -5397,6 +6057,11 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_message_ids);
     }
 
+    std::vector<fc::exception_ptr> statistics_gathering_node_delegate_wrapper::handle_blocks( const std::vector<graphene::net::block_message>& block_messages, bool sync_mode )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(handle_blocks, block_messages, sync_mode);
+    }
+
     void statistics_gathering_node_delegate_wrapper::handle_transaction( const graphene::net::trx_message& transaction_message )
     {
       INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
@@ -5414,6 +6079,11 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(get_item, id);
     }
 
+    std::vector<fc::optional<message>> statistics_gathering_node_delegate_wrapper::get_items( const std::vector<item_id>& ids )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(get_items, ids);
+    }
+
     chain_id_type statistics_gathering_node_delegate_wrapper::get_chain_id() const
     {
       INVOKE_AND_COLLECT_STATISTICS(get_chain_id);
@@ -42,7 +42,7 @@
 
 namespace graphene { namespace net
   {
-    message peer_connection::real_queued_message::get_message(peer_connection_delegate*)
+    const message& peer_connection::real_queued_message::get_message(peer_connection_delegate*)
     {
       if (message_send_time_field_offset != (size_t)-1)
       {
@@ -59,9 +59,19 @@ namespace graphene { namespace net
     {
       return message_to_send.data.size();
     }
-    message peer_connection::virtual_queued_message::get_message(peer_connection_delegate* node)
+    const message& peer_connection::shared_queued_message::get_message(peer_connection_delegate*)
     {
-      return node->get_message_for_item(item_to_send);
+      return *message_to_send;
+    }
+    size_t peer_connection::shared_queued_message::get_size_in_queue()
+    {
+      return message_to_send->data.size();
+    }
+
+    const message& peer_connection::virtual_queued_message::get_message(peer_connection_delegate* node)
+    {
+      generated_message.reset(new message(node->get_message_for_item(item_to_send)));
+      return *generated_message;
     }
 
     size_t peer_connection::virtual_queued_message::get_size_in_queue()
@@ -80,10 +90,26 @@ namespace graphene { namespace net
       their_state(their_connection_state::disconnected),
       we_have_requested_close(false),
       negotiation_status(connection_negotiation_status::disconnected),
+      supports_compact_blocks(false),
+      supports_authenticated_encryption(false),
+      items_requested_count(0),
+      items_received_count(0),
+      items_not_available_count(0),
+      inventory_items_advertised_count(0),
+      inventory_items_new_count(0),
+      invalid_items_count(0),
+      stale_items_count(0),
+      item_latency_average_us(0),
+      item_latency_buckets{},
+      item_latency_max_us(0),
       number_of_unfetched_item_ids(0),
       peer_needs_sync_items_from_us(true),
       we_need_sync_items_from_peer(true),
       inhibit_fetching_sync_blocks(false),
+      sync_request_window(GRAPHENE_NET_INITIAL_SYNC_REQUEST_WINDOW),
+      sync_window_size(0),
+      sync_blocks_per_second(0),
+      sync_window_latency(0),
       transaction_fetching_inhibited_until(fc::time_point::min()),
       last_known_fork_block_number(0),
       firewall_check_state(nullptr)
@@ -265,6 +291,9 @@ namespace graphene { namespace net
     void peer_connection::on_message( message_oriented_connection* originating_connection, const message& received_message )
     {
       VERIFY_CORRECT_THREAD();
+      message_counters& counters = message_counters_by_type[received_message.msg_type];
+      ++counters.messages_received;
+      counters.bytes_received += sizeof(message_header) + received_message.size;
       _node->on_message( this, received_message );
     }
 
@@ -288,7 +317,7 @@ namespace graphene { namespace net
       while (!_queued_messages.empty())
       {
         _queued_messages.front()->transmission_start_time = fc::time_point::now();
-        message message_to_send = _queued_messages.front()->get_message(_node);
+        const message& message_to_send = _queued_messages.front()->get_message(_node);
         try
         {
           //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_message() "
@@ -325,6 +354,11 @@ namespace graphene { namespace net
           elog("message_oriented_exception::send_message() threw an unhandled exception");
         }
         _queued_messages.front()->transmission_finish_time = fc::time_point::now();
+        message_counters& counters = message_counters_by_type[message_to_send.msg_type];
+        ++counters.messages_sent;
+        counters.bytes_sent += sizeof(message_header) + message_to_send.size;
+        if (_queued_messages.front()->start_authenticated_sending_after)
+          _message_connection.start_authenticated_sending();
         _total_queued_messages_size -= _queued_messages.front()->get_size_in_queue();
         _queued_messages.pop();
       }
@@ -372,6 +406,13 @@ namespace graphene { namespace net
       send_queueable_message(std::move(message_to_enqueue));
     }
 
+    void peer_connection::send_message(shared_message_ptr message_to_send)
+    {
+      VERIFY_CORRECT_THREAD();
+      std::unique_ptr<queued_message> message_to_enqueue(new shared_queued_message(std::move(message_to_send)));
+      send_queueable_message(std::move(message_to_enqueue));
+    }
+
     void peer_connection::send_item(const item_id& item_to_send)
     {
       VERIFY_CORRECT_THREAD();
@@ -381,6 +422,72 @@ namespace graphene { namespace net
       send_queueable_message(std::move(message_to_enqueue));
     }
 
+    void peer_connection::record_item_received(fc::time_point request_time)
+    {
+      VERIFY_CORRECT_THREAD();
+      ++items_received_count;
+      uint64_t latency_us = std::max<int64_t>((fc::time_point::now() - request_time).count(), 0);
+      size_t bucket = 0;
+      for (uint64_t remaining = latency_us; remaining && bucket + 1 < item_latency_buckets.size(); remaining >>= 1)
+        ++bucket;
+      ++item_latency_buckets[bucket];
+      item_latency_max_us = std::max(item_latency_max_us, latency_us);
+      item_latency_average_us = items_received_count == 1 ? latency_us : 0.8 * item_latency_average_us + 0.2 * latency_us;
+    }
+
+    double peer_connection::get_quality_score() const
+    {
+      VERIFY_CORRECT_THREAD();
+      // the share of the items we asked for that arrived, starting from one of two for a new peer
+      double delivery = (items_received_count + 1.0) / (items_requested_count + 2.0);
+      // halved at the reference latency; a peer that hasn't delivered anything yet is assumed to be there
+      double reference_latency_us = 1000.0 * GRAPHENE_NET_PEER_QUALITY_REFERENCE_LATENCY_MS;
+      double average_latency_us = items_received_count ? item_latency_average_us : reference_latency_us;
+      double latency = 1.0 / (1.0 + average_latency_us / reference_latency_us);
+      // rejected items weigh more than late ones, neither drives the score to zero
+      double validity = std::max(0.05, 1.0 - 0.75 * invalid_items_count / (items_received_count + 1.0));
+      double freshness = std::max(0.05, 1.0 - 0.5 * stale_items_count / (items_received_count + 1.0));
+      // new connections start at half weight
+      double connected_seconds = (double)(fc::time_point::now() - get_connection_time()).to_seconds();
+      double uptime = 0.5 + 0.5 * std::min(1.0, connected_seconds / GRAPHENE_NET_PEER_QUALITY_GRACE_PERIOD_SEC);
+      return delivery * latency * validity * freshness * uptime;
+    }
+
+    uint64_t peer_connection::get_item_latency_percentile_us(uint32_t permille) const
+    {
+      VERIFY_CORRECT_THREAD();
+      uint64_t total = 0;
+      for (uint64_t count : item_latency_buckets)
+        total += count;
+      if (total == 0)
+        return 0;
+      // the upper end of the bucket holding the requested rank, but never more than the maximum
+      uint64_t rank = (total * permille + 999) / 1000;
+      uint64_t seen = 0;
+      for (size_t bucket = 0; bucket < item_latency_buckets.size(); ++bucket)
+      {
+        seen += item_latency_buckets[bucket];
+        if (seen >= rank)
+          return std::min<uint64_t>(bucket == 0 ? 0 : (uint64_t(1) << bucket) - 1, item_latency_max_us);
+      }
+      return item_latency_max_us;
+    }
+
+    void peer_connection::start_authenticated_sending_after_queued_messages()
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_queued_messages.empty())
+        _message_connection.start_authenticated_sending();
+      else
+        _queued_messages.back()->start_authenticated_sending_after = true;
+    }
+
+    void peer_connection::start_authenticated_receiving()
+    {
+      VERIFY_CORRECT_THREAD();
+      _message_connection.start_authenticated_receiving();
+    }
+
     void peer_connection::close_connection()
     {
       VERIFY_CORRECT_THREAD();
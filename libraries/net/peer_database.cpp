@@ -28,10 +28,13 @@
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/tag.hpp>
 
+#include <fstream>
+
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/fstream.hpp>
 
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
@@ -87,44 +90,103 @@ namespace graphene { namespace net {
     peer_database_iterator::peer_database_iterator( const peer_database_iterator& c ) :
       boost::iterator_facade<peer_database_iterator, const potential_peer_record, boost::forward_traversal_tag>(c){}
 
+    /// bump whenever the packed form of potential_peer_record changes
+    static const uint32_t peer_database_format_version = 1;
+
     void peer_database_impl::open(const fc::path& peer_database_filename)
     {
       _peer_database_filename = peer_database_filename;
+      std::vector<potential_peer_record> peer_records;
       if (fc::exists(_peer_database_filename))
       {
         try
         {
-           std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
-           std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+          std::string contents;
+          fc::read_file_contents(_peer_database_filename, contents);
+          fc::datastream<const char*> ds(contents.data(), contents.size());
+          uint32_t format_version;
+          fc::raw::unpack(ds, format_version);
+          FC_ASSERT(format_version == peer_database_format_version, "Unknown peer database format ${version}", ("version", format_version));
+          while (ds.remaining())
           {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
+            std::vector<char> packed_record;
+            fc::raw::unpack(ds, packed_record);
+            try
+            {
+              peer_records.push_back(fc::raw::unpack<potential_peer_record>(packed_record));
+            }
+            catch (const fc::exception&)
+            {
+              wlog("skipping a damaged record in peer database file ${peer_database_filename}",
+                   ("peer_database_filename", _peer_database_filename));
+            }
           }
         }
         catch (const fc::exception& e)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
-               ("peer_database_filename", _peer_database_filename));
+          elog("error opening peer database file ${peer_database_filename}, keeping the ${count} records read before the error",
+               ("peer_database_filename", _peer_database_filename)("count", peer_records.size()));
         }
       }
+      else
+      {
+        // older versions kept the database as JSON
+        fc::path legacy_peer_database_filename = _peer_database_filename;
+        legacy_peer_database_filename.replace_extension(".json");
+        if (legacy_peer_database_filename != _peer_database_filename && fc::exists(legacy_peer_database_filename))
+        {
+          try
+          {
+            peer_records = fc::json::from_file(legacy_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+            ilog("imported ${count} peers from ${legacy_peer_database_filename}",
+                 ("count", peer_records.size())("legacy_peer_database_filename", legacy_peer_database_filename));
+          }
+          catch (const fc::exception& e)
+          {
+            elog("error importing peer database file ${legacy_peer_database_filename}, starting with a clean database",
+                 ("legacy_peer_database_filename", legacy_peer_database_filename));
+          }
+        }
+      }
+
+      std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
+      if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+      {
+        // prune database to a reasonable size
+        auto iter = _potential_peer_set.begin();
+        std::advance(iter, MAXIMUM_PEERDB_SIZE);
+        _potential_peer_set.erase(iter, _potential_peer_set.end());
+      }
     }
 
     void peer_database_impl::close()
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
-
       try
       {
         fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
         if (!fc::exists(peer_database_filename_dir))
           fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+
+        // write a new file and move it over the old one, so a crash leaves one or the other
+        fc::path temporary_filename = _peer_database_filename.generic_string() + ".tmp";
+        {
+          std::ofstream out(temporary_filename.generic_string(),
+                            std::ofstream::binary | std::ofstream::out | std::ofstream::trunc);
+          FC_ASSERT(out, "unable to open ${temporary_filename}", ("temporary_filename", temporary_filename));
+          fc::raw::pack(out, peer_database_format_version);
+          for (const potential_peer_record& record : _potential_peer_set)
+          {
+            potential_peer_record record_to_save = record;
+            // only the kind of the last error is worth keeping, its log is of no use after a restart
+            if (record_to_save.last_error)
+              record_to_save.last_error = fc::exception(record.last_error->code(), record.last_error->name(), record.last_error->what());
+            std::vector<char> packed_record = fc::raw::pack(record_to_save);
+            fc::raw::pack(out, packed_record);
+          }
+          out.close();
+          FC_ASSERT(out, "error writing ${temporary_filename}", ("temporary_filename", temporary_filename));
+        }
+        fc::rename(temporary_filename, _peer_database_filename);
       }
       catch (const fc::exception& e)
       {
@@ -38,8 +38,13 @@ namespace graphene { namespace net {
 
 stcp_socket::stcp_socket()
 //:_buf_len(0)
+   : _is_initiator(false),
+     _sending_authenticated(false),
+     _receiving_authenticated(false),
+     _authenticated_read_buffer_size(0),
+     _authenticated_write_buffer_size(0)
 #ifndef NDEBUG
-   : _read_buffer_in_use(false),
+   , _read_buffer_in_use(false),
      _write_buffer_in_use(false)
 #endif
 {
@@ -72,6 +77,7 @@ void stcp_socket::do_key_exchange()
 void stcp_socket::connect_to( const fc::ip::endpoint& remote_endpoint )
 {
   _sock.connect_to( remote_endpoint );
+  _is_initiator = true;
   do_key_exchange();
 }
 
@@ -145,7 +151,6 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
     if (!_write_buffer)
       _write_buffer.reset(new char[write_buffer_length], [](char* p){ delete[] p; });
     len = std::min<size_t>(write_buffer_length, len);
-    memset(_write_buffer.get(), 0, len); // just in case aes.encode screws up
     /**
      * every sizeof(crypt_buf) bytes the aes channel
      * has an error and doesn't decrypt properly...  disable
@@ -182,6 +187,70 @@ void stcp_socket::accept()
   do_key_exchange();
 }
 
+fc::sha256 stcp_socket::authenticated_key( bool initiator_to_acceptor ) const
+{
+  // each direction gets its own key, so the two sides' nonce counters never collide
+  fc::sha256::encoder key_encoder;
+  key_encoder.write( (const char*)&_shared_secret, sizeof(_shared_secret) );
+  const char direction = initiator_to_acceptor ? 'i' : 'a';
+  key_encoder.write( &direction, 1 );
+  return key_encoder.result();
+}
+
+void stcp_socket::start_authenticated_sending()
+{
+  _send_gcm.init( authenticated_key( _is_initiator ) );
+  _sending_authenticated = true;
+}
+
+void stcp_socket::start_authenticated_receiving()
+{
+  _recv_gcm.init( authenticated_key( !_is_initiator ) );
+  _receiving_authenticated = true;
+}
+
+void stcp_socket::reserve_buffer( std::shared_ptr<char>& buffer, size_t& capacity, size_t len )
+{
+  if( len <= capacity )
+    return;
+  capacity = std::max<size_t>( len, 2 * capacity );
+  buffer.reset( new char[capacity], [](char* p){ delete[] p; } );
+}
+
+void stcp_socket::write_authenticated( const char* header, size_t header_len, const char* body, size_t body_len )
+{ try {
+    assert( _sending_authenticated );
+    size_t record_len = header_len + body_len + fc::aes_gcm_encoder::tag_size;
+    reserve_buffer( _authenticated_write_buffer, _authenticated_write_buffer_size, record_len );
+    // encrypt straight from the message into the record, no padded copy of the plaintext
+    char* record = _authenticated_write_buffer.get();
+    _send_gcm.begin_message();
+    _send_gcm.encode( header, header_len, record );
+    if( body_len )
+      _send_gcm.encode( body, body_len, record + header_len );
+    _send_gcm.end_message( record + header_len + body_len );
+    _sock.write( _authenticated_write_buffer, record_len );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("header_len",header_len)("body_len",body_len) ) }
+
+void stcp_socket::read_authenticated_start( char* buffer, size_t len )
+{ try {
+    assert( _receiving_authenticated );
+    reserve_buffer( _authenticated_read_buffer, _authenticated_read_buffer_size, len );
+    _sock.read( _authenticated_read_buffer, len );
+    _recv_gcm.begin_message();
+    _recv_gcm.decode( _authenticated_read_buffer.get(), len, buffer );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
+
+void stcp_socket::read_authenticated_rest( char* buffer, size_t len )
+{ try {
+    assert( _receiving_authenticated );
+    reserve_buffer( _authenticated_read_buffer, _authenticated_read_buffer_size, len + fc::aes_gcm_decoder::tag_size );
+    _sock.read( _authenticated_read_buffer, len + fc::aes_gcm_decoder::tag_size );
+    if( len )
+      _recv_gcm.decode( _authenticated_read_buffer.get(), len, buffer );
+    _recv_gcm.end_message( _authenticated_read_buffer.get() + len );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
+
 
 }} // namespace graphene::net
 
@@ -57,7 +57,7 @@ delayed_node_plugin::~delayed_node_plugin() { }
 void delayed_node_plugin::plugin_set_program_options(bpo::options_description& cli, bpo::options_description& cfg)
 {
    (void)cli; (void)cfg;
-   // for "trusted-node" see delayed_node/main.cpp
+   // for "trusted-node" and "trusted-node-deflate" see delayed_node/main.cpp
 }
 
 void delayed_node_plugin::connect()
@@ -81,6 +81,12 @@ void delayed_node_plugin::connect()
 
 void delayed_node_plugin::plugin_initialize(const boost::program_options::variables_map& options) {
    my->remote_endpoint = "ws://" + options.at("trusted-node").as<std::string>();
+   if( options.count("trusted-node-deflate") )
+   {
+      fc::http::websocket_compression compression;
+      compression.enabled = true;
+      fc::http::set_client_compression( compression );
+   }
 }
 
 void delayed_node_plugin::sync_with_trusted_node()
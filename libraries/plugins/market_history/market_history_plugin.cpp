@@ -61,170 +61,223 @@ class market_history_plugin_impl
       market_history_plugin&     _self;
       flat_set<uint32_t>         _tracked_buckets;
       uint32_t                   _maximum_history_per_bucket_size = 1000;
-};
 
+   private:
+      /** the fills of one block that fall into a single bucket, merged before touching the database */
+      struct bucket_update
+      {
+         price       open;
+         price       close;
+         price       high;
+         price       low;
+         share_type  base_volume;
+         share_type  quote_volume;
+      };
+
+      void record_order_history( const fill_order_operation& o, fc::time_point_sec time,
+                                 map< pair<asset_id_type,asset_id_type>, int64_t >& next_sequence );
+      void record_bucket_fill( const fill_order_operation& o, fc::time_point_sec now,
+                               map< bucket_key, bucket_update >& updates );
+      void prune_order_history( const pair<asset_id_type,asset_id_type>& market, int64_t newest_sequence );
+      void apply_bucket_update( const bucket_key& key, const bucket_update& update );
+};
 
-struct operation_process_fill_order
-{
-   market_history_plugin&    _plugin;
-   fc::time_point_sec        _now;
+/** only the 200 most recent fills are kept for each market */
+static const int64_t max_order_history_per_market = 200;
 
-   operation_process_fill_order( market_history_plugin& mhp, fc::time_point_sec n )
-   :_plugin(mhp),_now(n) {}
+market_history_plugin_impl::~market_history_plugin_impl()
+{}
 
-   typedef void result_type;
+void market_history_plugin_impl::record_order_history( const fill_order_operation& o, fc::time_point_sec time,
+                                                       map< pair<asset_id_type,asset_id_type>, int64_t >& next_sequence )
+{
+   auto& db = database();
 
-   /** do nothing for other operation types */
-   template<typename T>
-   void operator()( const T& )const{}
+   history_key hkey;
+   hkey.base = o.pays.asset_id;
+   hkey.quote = o.receives.asset_id;
+   if( hkey.base > hkey.quote )
+      std::swap( hkey.base, hkey.quote );
 
-   void operator()( const fill_order_operation& o )const 
+   auto market = std::make_pair( hkey.base, hkey.quote );
+   auto seq = next_sequence.find( market );
+   if( seq == next_sequence.end() )
    {
-      //ilog( "processing ${o}", ("o",o) );
-      const auto& buckets = _plugin.tracked_buckets();
-      auto& db         = _plugin.database();
-      const auto& bucket_idx = db.get_index_type<bucket_index>();
+      // sequences decrease over time, so the newest entry of a market is the first one in by_key order
       const auto& history_idx = db.get_index_type<history_index>().indices().get<by_key>();
-
-      auto time = db.head_block_time();
-
-      history_key hkey;
-      hkey.base = o.pays.asset_id;
-      hkey.quote = o.receives.asset_id;
-      if( hkey.base > hkey.quote ) 
-         std::swap( hkey.base, hkey.quote );
       hkey.sequence = std::numeric_limits<int64_t>::min();
-
       auto itr = history_idx.lower_bound( hkey );
-
-      if( itr->key.base == hkey.base && itr->key.quote == hkey.quote )
+      if( itr != history_idx.end() && itr->key.base == hkey.base && itr->key.quote == hkey.quote )
          hkey.sequence = itr->key.sequence - 1;
       else
          hkey.sequence = 0;
+      seq = next_sequence.emplace( market, hkey.sequence ).first;
+   }
+   else
+      hkey.sequence = seq->second;
 
-      db.create<order_history_object>( [&]( order_history_object& ho ) {
-         ho.key = hkey;
-         ho.time = time;
-         ho.op = o;
-      });
+   db.create<order_history_object>( [&]( order_history_object& ho ) {
+      ho.key = hkey;
+      ho.time = time;
+      ho.op = o;
+   });
+
+   seq->second = hkey.sequence - 1;
+}
 
-      hkey.sequence += 200;
-      itr = history_idx.lower_bound( hkey );
+void market_history_plugin_impl::record_bucket_fill( const fill_order_operation& o, fc::time_point_sec now,
+                                                     map< bucket_key, bucket_update >& updates )
+{
+   /** for every matched order there are two fill order operations created, one for
+    * each side.  We can filter the duplicates by only considering the fill operations where
+    * the base > quote
+    */
+   if( o.pays.asset_id > o.receives.asset_id )
+      return;
+
+   price trade_price = o.pays / o.receives;
 
-      while( itr != history_idx.end() )
+   for( auto bucket : _tracked_buckets )
+   {
+      bucket_key key;
+      key.base    = o.pays.asset_id;
+      key.quote   = o.receives.asset_id;
+      key.seconds = bucket;
+      key.open    = fc::time_point() + fc::seconds((now.sec_since_epoch() / key.seconds) * key.seconds);
+
+      auto itr = updates.find( key );
+      if( itr == updates.end() )
       {
-         if( itr->key.base == hkey.base && itr->key.quote == hkey.quote )
-         {
-            db.remove( *itr );
-            itr = history_idx.lower_bound( hkey );
-         }
-         else break;
+         bucket_update& u = updates[key];
+         u.open = u.close = u.high = u.low = trade_price;
+         u.base_volume = trade_price.base.amount;
+         u.quote_volume = trade_price.quote.amount;
+         continue;
       }
 
+      bucket_update& u = itr->second;
+      u.close = trade_price;
+      if( u.high < trade_price ) u.high = trade_price;
+      if( u.low > trade_price ) u.low = trade_price;
+      u.base_volume += trade_price.base.amount;
+      u.quote_volume += trade_price.quote.amount;
+   }
+}
+
+void market_history_plugin_impl::prune_order_history( const pair<asset_id_type,asset_id_type>& market, int64_t newest_sequence )
+{
+   auto& db = database();
+   const auto& history_idx = db.get_index_type<history_index>().indices().get<by_key>();
+
+   history_key hkey;
+   hkey.base = market.first;
+   hkey.quote = market.second;
+   hkey.sequence = newest_sequence + max_order_history_per_market;
 
-      auto max_history = _plugin.max_history();
-      for( auto bucket : buckets )
+   auto itr = history_idx.lower_bound( hkey );
+   while( itr != history_idx.end() && itr->key.base == hkey.base && itr->key.quote == hkey.quote )
+   {
+      auto old_itr = itr;
+      ++itr;
+      db.remove( *old_itr );
+   }
+}
+
+void market_history_plugin_impl::apply_bucket_update( const bucket_key& key, const bucket_update& u )
+{
+   auto& db = database();
+   const auto& by_key_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+
+   auto itr = by_key_idx.find( key );
+   if( itr == by_key_idx.end() )
+   { // create new bucket
+      db.create<bucket_object>( [&]( bucket_object& b ){
+           b.key = key;
+           b.quote_volume = u.quote_volume;
+           b.base_volume = u.base_volume;
+           b.open_base = u.open.base.amount;
+           b.open_quote = u.open.quote.amount;
+           b.close_base = u.close.base.amount;
+           b.close_quote = u.close.quote.amount;
+           b.high_base = u.high.base.amount;
+           b.high_quote = u.high.quote.amount;
+           b.low_base = u.low.base.amount;
+           b.low_quote = u.low.quote.amount;
+      });
+   }
+   else
+   { // update existing bucket
+      db.modify( *itr, [&]( bucket_object& b ){
+           b.base_volume += u.base_volume;
+           b.quote_volume += u.quote_volume;
+           b.close_base = u.close.base.amount;
+           b.close_quote = u.close.quote.amount;
+           if( b.high() < u.high )
+           {
+               b.high_base = u.high.base.amount;
+               b.high_quote = u.high.quote.amount;
+           }
+           if( b.low() > u.low )
+           {
+               b.low_base = u.low.base.amount;
+               b.low_quote = u.low.quote.amount;
+           }
+      });
+   }
+
+   auto max_history = _maximum_history_per_bucket_size;
+   if( max_history != 0 )
+   {
+      auto cutoff = (fc::time_point() + fc::seconds( key.seconds * max_history ));
+
+      bucket_key first = key;
+      first.open = fc::time_point_sec();
+      auto itr = by_key_idx.lower_bound( first );
+
+      while( itr != by_key_idx.end() &&
+             itr->key.base == key.base &&
+             itr->key.quote == key.quote &&
+             itr->key.seconds == key.seconds &&
+             itr->key.open < cutoff )
       {
-          auto cutoff      = (fc::time_point() + fc::seconds( bucket * max_history));
-
-          bucket_key key;
-          key.base    = o.pays.asset_id;
-          key.quote   = o.receives.asset_id;
-
-
-          /** for every matched order there are two fill order operations created, one for
-           * each side.  We can filter the duplicates by only considering the fill operations where
-           * the base > quote
-           */
-          if( key.base > key.quote ) 
-          {
-             //ilog( "     skipping because base > quote" );
-             continue;
-          }
-
-          price trade_price = o.pays / o.receives;
-
-          key.seconds = bucket;
-          key.open    = fc::time_point() + fc::seconds((_now.sec_since_epoch() / key.seconds) * key.seconds);
-
-          const auto& by_key_idx = bucket_idx.indices().get<by_key>();
-          auto itr = by_key_idx.find( key );
-          if( itr == by_key_idx.end() )
-          { // create new bucket
-            /* const auto& obj = */
-            db.create<bucket_object>( [&]( bucket_object& b ){
-                 b.key = key;
-                 b.quote_volume += trade_price.quote.amount;
-                 b.base_volume += trade_price.base.amount;
-                 b.open_base = trade_price.base.amount;
-                 b.open_quote = trade_price.quote.amount;
-                 b.close_base = trade_price.base.amount;
-                 b.close_quote = trade_price.quote.amount;
-                 b.high_base = b.close_base;
-                 b.high_quote = b.close_quote;
-                 b.low_base = b.close_base;
-                 b.low_quote = b.close_quote;
-            });
-            //wlog( "    creating bucket ${b}", ("b",obj) );
-          }
-          else
-          { // update existing bucket
-             //wlog( "    before updating bucket ${b}", ("b",*itr) );
-             db.modify( *itr, [&]( bucket_object& b ){
-                  b.base_volume += trade_price.base.amount;
-                  b.quote_volume += trade_price.quote.amount;
-                  b.close_base = trade_price.base.amount;
-                  b.close_quote = trade_price.quote.amount;
-                  if( b.high() < trade_price ) 
-                  {
-                      b.high_base = b.close_base;
-                      b.high_quote = b.close_quote;
-                  }
-                  if( b.low() > trade_price ) 
-                  {
-                      b.low_base = b.close_base;
-                      b.low_quote = b.close_quote;
-                  }
-             });
-             //wlog( "    after bucket bucket ${b}", ("b",*itr) );
-          }
-
-          if( max_history != 0  )
-          {
-             key.open = fc::time_point_sec();
-             auto itr = by_key_idx.lower_bound( key );
-
-             while( itr != by_key_idx.end() && 
-                    itr->key.base == key.base && 
-                    itr->key.quote == key.quote && 
-                    itr->key.seconds == bucket && 
-                    itr->key.open < cutoff )
-             {
-              //  elog( "    removing old bucket ${b}", ("b", *itr) );
-                auto old_itr = itr;
-                ++itr;
-                db.remove( *old_itr );
-             }
-          }
+         auto old_itr = itr;
+         ++itr;
+         db.remove( *old_itr );
       }
    }
-};
-
-market_history_plugin_impl::~market_history_plugin_impl()
-{}
+}
 
+/**
+ *  All fills of the block are folded in memory first, so that every market costs one history prune
+ *  and every touched bucket one create or modify, independent of how many fills the block contains.
+ */
 void market_history_plugin_impl::update_market_histories( const signed_block& b )
 {
    if( _maximum_history_per_bucket_size == 0 ) return;
    if( _tracked_buckets.size() == 0 ) return;
 
    graphene::chain::database& db = database();
+   auto time = db.head_block_time();
+
+   map< pair<asset_id_type,asset_id_type>, int64_t > next_sequence;
+   map< bucket_key, bucket_update >                  bucket_updates;
+
    const vector<optional< operation_history_object > >& hist = db.get_applied_operations();
    for( const optional< operation_history_object >& o_op : hist )
    {
-      if( o_op.valid() )
-         o_op->op.visit( operation_process_fill_order( _self, b.timestamp ) );
+      if( !o_op.valid() || o_op->op.which() != operation::tag<fill_order_operation>::value )
+         continue;
+
+      const auto& o = o_op->op.get<fill_order_operation>();
+      record_order_history( o, time, next_sequence );
+      record_bucket_fill( o, b.timestamp, bucket_updates );
    }
+
+   for( const auto& item : next_sequence )
+      prune_order_history( item.first, item.second + 1 );
+
+   for( const auto& item : bucket_updates )
+      apply_bucket_update( item.first, item.second );
 }
 
 } // end namespace detail
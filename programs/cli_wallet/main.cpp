@@ -43,6 +43,9 @@
 #include <graphene/utilities/key_conversion.hpp>
 #include <graphene/wallet/wallet.hpp>
 
+// included after the graphene headers so their fc::raw overloads are visible to the binary api
+#include <fc/rpc/binary_websocket_api.hpp>
+
 #include <fc/interprocess/signals.hpp>
 #include <boost/program_options.hpp>
 
@@ -76,6 +79,8 @@ int main( int argc, char** argv )
          ("server-rpc-endpoint,s", bpo::value<string>()->implicit_value("wss://127.0.0.1:5909"), "Server websocket RPC endpoint")
          ("server-rpc-user,u", bpo::value<string>(), "Server Username")
          ("server-rpc-password,p", bpo::value<string>(), "Server Password")
+         ("server-rpc-binary",  bpo::bool_switch(), "Talk to the server using the binary RPC protocol (--rpc-binary-endpoint of witness_node)")
+         ("server-rpc-deflate",  bpo::bool_switch(), "Offer per-message deflate compression to the server (--enable-permessage-deflate of witness_node)")
          ("rpc-endpoint,r", bpo::value<string>()->implicit_value("127.0.0.1:8081"), "Endpoint for wallet websocket RPC to listen on")
          ("rpc-tls-endpoint,t", bpo::value<string>()->implicit_value("127.0.0.1:8092"), "Endpoint for wallet websocket TLS RPC to listen on")
          ("rpc-tls-certificate,c", bpo::value<string>()->implicit_value("server.pem"), "PEM certificate for wallet websocket TLS RPC")
@@ -182,12 +187,29 @@ int main( int argc, char** argv )
       if( options.count("server-rpc-password") )
          wdata.ws_password = options.at("server-rpc-password").as<std::string>();
 
+      if( options.at("server-rpc-deflate").as<bool>() )
+      {
+         fc::http::websocket_compression compression;
+         compression.enabled = true;
+         fc::http::set_client_compression( compression );
+      }
+
       fc::http::websocket_client client;
       idump((wdata.ws_server));
       auto con  = client.connect( wdata.ws_server );
-      auto apic = std::make_shared<fc::rpc::websocket_api_connection>(*con, GRAPHENE_MAX_NESTED_OBJECTS);
-
-      auto remote_api = apic->get_remote_api< login_api >(1);
+      std::shared_ptr<fc::rpc::websocket_api_connection> apic;
+      std::shared_ptr<fc::rpc::binary_websocket_api_connection> bapic;
+      fc::api<login_api> remote_api;
+      if( options.at("server-rpc-binary").as<bool>() )
+      {
+         bapic = std::make_shared<fc::rpc::binary_websocket_api_connection>(*con);
+         remote_api = bapic->get_remote_api< login_api >(1);
+      }
+      else
+      {
+         apic = std::make_shared<fc::rpc::websocket_api_connection>(*con, GRAPHENE_MAX_NESTED_OBJECTS);
+         remote_api = apic->get_remote_api< login_api >(1);
+      }
       edump((wdata.ws_user)(wdata.ws_password) );
       FC_ASSERT( remote_api->login( wdata.ws_user, wdata.ws_password ), "Failed to log in to API server" );
 
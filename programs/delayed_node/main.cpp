@@ -70,6 +70,7 @@ int main(int argc, char** argv) {
             ("data-dir,d", bpo::value<boost::filesystem::path>()->default_value("delayed_node_data_dir"), "Directory containing databases, configuration file, etc.")
             ("fast",  bpo::value<int>(), "Size of history in days")
             ("trusted-node", bpo::value<std::string>()->required(), "RPC endpoint of a trusted validating node (required)")
+            ("trusted-node-deflate", "Offer per-message deflate compression to the trusted node")
             ("referrer_mode_enabled", "Any LTM-member can create accounts")
             ;
 
@@ -210,7 +211,8 @@ void write_default_logging_config_to_stream(std::ostream& out)
           "# declare an appender named \"p2p\" that writes messages to p2p.log\n"
           "[log.file_appender.p2p]\n"
           "filename=logs/p2p/p2p.log\n"
-          "# filename can be absolute or relative to this config file\n\n"
+          "# filename can be absolute or relative to this config file\n"
+          "# messages are formatted and written by a background thread unless async=false\n\n"
           "# route any messages logged to the default logger to the \"stderr\" logger we\n"
           "# declared above, if they are info level are higher\n"
           "[logger.default]\n"
@@ -270,13 +272,14 @@ fc::optional<fc::logging_config> load_logging_config_from_ini_file(const fc::pat
 
 
             // construct a default file appender config here
-            // filename will be taken from ini file, everything else hard-coded here
+            // filename and async will be taken from ini file, everything else hard-coded here
             fc::file_appender::config file_appender_config;
             file_appender_config.filename = file_name;
             file_appender_config.flush = true;
             file_appender_config.rotate = true;
             file_appender_config.rotation_interval = fc::hours(1);
             file_appender_config.rotation_limit = fc::days(1);
+            file_appender_config.async = section_tree.get<bool>("async", true);
             logging_config.appenders.push_back(fc::appender_config(file_appender_name, "file", fc::variant(file_appender_config, GRAPHENE_MAX_NESTED_OBJECTS)));
             found_logging_config = true;
          }
@@ -78,6 +78,11 @@ database_fixture::database_fixture()
        
    boost::program_options::variables_map options;
 
+   // market history is only tracked when bucket sizes are configured
+   const std::string current_test_name = boost::unit_test::framework::current_test_case().p_name;
+   if( current_test_name == "market_history_per_block_aggregation" )
+      options.insert( std::make_pair( "bucket-size", boost::program_options::variable_value( string( "[15,60,3600]" ), false ) ) );
+
    genesis_state.initial_timestamp = time_point_sec( GRAPHENE_TESTING_GENESIS_TIMESTAMP );
    genesis_state.initial_active_witnesses = 10;
    for( size_t i = 0; i < genesis_state.initial_active_witnesses; ++i )
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Runs a number of chain databases in one process, connected through
+ * graphene::net::simulated_network, and measures how long blocks take to
+ * reach and be applied by every node, and how fast transaction floods are
+ * accepted.  Everything but the wall clock is deterministic, so runs before
+ * and after a block processing change can be compared directly.
+ *
+ * The simulated network hands items straight to each node's delegate, so
+ * node_impl and peer_connection (sync, inventory, windows, queues) are never
+ * run and changes to them do not show up in these numbers.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/smart_ref_impl.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <graphene/chain/balance_object.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/protocol/protocol.hpp>
+#include <graphene/net/node.hpp>
+
+#include <boost/program_options.hpp>
+
+using namespace graphene::chain;
+using namespace std;
+namespace bpo = boost::program_options;
+
+// hack:  import create_example_genesis() even though it's a way, way
+// specific internal detail
+namespace graphene { namespace app { namespace detail {
+genesis_state_type create_example_genesis();
+} } } // graphene::app::detail
+
+/** one node of the benchmark network, applying what it receives to its own database */
+class benchmark_node : public graphene::net::node_delegate
+{
+public:
+   benchmark_node( const fc::path& data_dir, const genesis_state_type& genesis,
+                   std::map<block_id_type, fc::time_point>& block_broadcast_times,
+                   std::vector<fc::microseconds>& block_latencies )
+   : _block_broadcast_times( block_broadcast_times ), _block_latencies( block_latencies )
+   {
+      db.open( data_dir, [&genesis]() { return genesis; } );
+   }
+   ~benchmark_node() { db.close(); }
+
+   database db;
+   uint64_t transactions_accepted = 0;
+   uint64_t transactions_rejected = 0;
+
+   bool has_item( const graphene::net::item_id& id ) override
+   {
+      if( id.item_type == graphene::net::block_message_type )
+         return db.is_known_block( id.item_hash );
+      return db.is_known_transaction( id.item_hash );
+   }
+
+   bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode,
+                      std::vector<fc::uint160_t>& contained_transaction_message_ids ) override
+   {
+      // the producer gets its own broadcasts back
+      if( db.is_known_block( blk_msg.block_id ) )
+         return false;
+      bool result = db.push_block( blk_msg.block );
+      auto broadcast_time = _block_broadcast_times.find( blk_msg.block_id );
+      if( broadcast_time != _block_broadcast_times.end() )
+         _block_latencies.push_back( fc::time_point::now() - broadcast_time->second );
+      return result;
+   }
+
+   void handle_transaction( const graphene::net::trx_message& trx_msg ) override
+   {
+      if( db.is_known_transaction( trx_msg.trx.id() ) )
+         return;
+      try
+      {
+         db.push_transaction( trx_msg.trx );
+         ++transactions_accepted;
+      }
+      catch ( const fc::exception& )
+      {
+         // e.g. expired after the simulated latency, counted so the flood still completes
+         ++transactions_rejected;
+      }
+   }
+
+   void handle_message( const graphene::net::message& message_to_process ) override {}
+   std::vector<graphene::net::item_hash_t> get_block_ids( const std::vector<graphene::net::item_hash_t>& blockchain_synopsis,
+                                                          uint32_t& remaining_item_count, uint32_t limit ) override
+   { remaining_item_count = 0; return std::vector<graphene::net::item_hash_t>(); }
+   graphene::net::message get_item( const graphene::net::item_id& id ) override
+   { FC_THROW_EXCEPTION( fc::key_not_found_exception, "the simulated network never fetches items" ); }
+   chain_id_type get_chain_id() const override { return db.get_chain_id(); }
+   std::vector<graphene::net::item_hash_t> get_blockchain_synopsis( const graphene::net::item_hash_t& reference_point,
+                                                                    uint32_t number_of_blocks_after_reference_point ) override
+   { return std::vector<graphene::net::item_hash_t>(); }
+   void sync_status( uint32_t item_type, uint32_t item_count ) override {}
+   void connection_count_changed( uint32_t c ) override {}
+   uint32_t get_block_number( const graphene::net::item_hash_t& block_id ) override { return block_header::num_from_id( block_id ); }
+   fc::time_point_sec get_block_time( const graphene::net::item_hash_t& block_id ) override
+   {
+      auto block = db.fetch_block_by_id( block_id );
+      return block ? block->timestamp : fc::time_point_sec::min();
+   }
+   fc::time_point_sec get_blockchain_now() override { return db.head_block_time(); }
+   graphene::net::item_hash_t get_head_block_id() const override { return db.head_block_id(); }
+   uint32_t estimate_last_known_fork_from_git_revision_timestamp( uint32_t unix_timestamp ) const override { return 0; }
+   void error_encountered( const std::string& message, const fc::oexception& error ) override {}
+   uint8_t get_current_block_interval_in_seconds() const override { return db.get_global_properties().parameters.block_interval; }
+
+private:
+   std::map<block_id_type, fc::time_point>& _block_broadcast_times;
+   std::vector<fc::microseconds>& _block_latencies;
+};
+
+static fc::microseconds percentile( const std::vector<fc::microseconds>& sorted_values, double fraction )
+{
+   if( sorted_values.empty() )
+      return fc::microseconds();
+   size_t index = std::min( sorted_values.size() - 1, size_t( fraction * sorted_values.size() ) );
+   return sorted_values[index];
+}
+
+/** waits for the simulated network to deliver, giving its sender tasks a chance to run */
+template<typename Condition>
+static void wait_until( Condition done, fc::microseconds timeout, const std::string& what )
+{
+   fc::time_point deadline = fc::time_point::now() + timeout;
+   while( !done() )
+   {
+      FC_ASSERT( fc::time_point::now() < deadline, "Timed out after ${s} seconds waiting for ${what}",
+                 ("s", timeout.to_seconds())("what", what) );
+      fc::usleep( fc::microseconds( 100 ) );
+   }
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Graphene p2p propagation benchmark");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("nodes,n", bpo::value<uint32_t>()->default_value(4), "Number of nodes, the first one produces all blocks")
+            ("blocks,b", bpo::value<uint32_t>()->default_value(20), "Number of blocks to produce")
+            ("transactions-per-block,t", bpo::value<uint32_t>()->default_value(200), "Transactions flooded through the network before each block")
+            ("latency-ms,l", bpo::value<uint32_t>()->default_value(50), "One way latency of every link, in milliseconds")
+            ("bandwidth-kbps,w", bpo::value<uint32_t>()->default_value(0), "Bandwidth of every link in kilobytes per second, 0 for unlimited")
+            ("data-dir,d", bpo::value<boost::filesystem::path>(), "Directory for the node databases, a temporary one by default")
+            ("timeout-s", bpo::value<uint32_t>()->default_value(60), "Seconds to wait for a flood or block to reach every node before failing")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         boost::program_options::store( boost::program_options::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const boost::program_options::error& e)
+      {
+         std::cerr << "p2p_benchmark:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n"
+                   << "Blocks and transactions travel through graphene::net::simulated_network, which calls the\n"
+                   << "node delegates directly.  node_impl and peer_connection are not exercised, so this measures\n"
+                   << "block and transaction processing, not changes to the p2p protocol code.\n";
+         return 0;
+      }
+
+      const uint32_t node_count = std::max<uint32_t>( options["nodes"].as<uint32_t>(), 2 );
+      const uint32_t block_count = options["blocks"].as<uint32_t>();
+      const uint32_t transactions_per_block = options["transactions-per-block"].as<uint32_t>();
+      const fc::microseconds timeout = fc::seconds( options["timeout-s"].as<uint32_t>() );
+
+      fc::optional<fc::temp_directory> temp_data_dir;
+      fc::path data_dir;
+      if( options.count("data-dir") )
+         data_dir = options["data-dir"].as<boost::filesystem::path>();
+      else
+      {
+         temp_data_dir = fc::temp_directory( fc::temp_directory_path() );
+         data_dir = temp_data_dir->path();
+      }
+
+      genesis_state_type genesis = graphene::app::detail::create_example_genesis();
+      fc::ecc::private_key nathan_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("nathan")));
+
+      std::map<block_id_type, fc::time_point> block_broadcast_times;
+      std::vector<fc::microseconds> block_latencies;
+      std::vector<std::unique_ptr<benchmark_node>> nodes;
+      graphene::net::simulated_network network( "p2p_benchmark" );
+      network.set_latency( fc::milliseconds( options["latency-ms"].as<uint32_t>() ) );
+      network.set_bandwidth( uint64_t( options["bandwidth-kbps"].as<uint32_t>() ) * 1024 );
+      for( uint32_t i = 0; i < node_count; ++i )
+      {
+         nodes.emplace_back( new benchmark_node( data_dir / ("node" + fc::to_string(i)), genesis,
+                                                 block_broadcast_times, block_latencies ) );
+         network.add_node_delegate( nodes.back().get() );
+      }
+      database& producer = nodes.front()->db;
+
+      // fund nathan in a first block, handed to every node directly
+      account_id_type nathan_id = producer.get_index_type<account_index>().indices().get<by_name>().find( "nathan" )->id;
+      {
+         signed_transaction trx_fee_payer;
+         assets_update_fee_payer_operation payer_upd_op;
+         payer_upd_op.assets_to_update = { asset_id_type() };
+         payer_upd_op.fee_payer_asset = asset_id_type();
+         trx_fee_payer.operations.push_back( payer_upd_op );
+         producer.current_fee_schedule().set_fee( trx_fee_payer.operations.back() );
+         trx_fee_payer.set_expiration( producer.head_block_time() + fc::hours(1) );
+         trx_fee_payer.set_reference_block( producer.head_block_id() );
+         trx_fee_payer.sign( nathan_key, producer.get_chain_id() );
+         producer.push_transaction( trx_fee_payer );
+
+         signed_transaction claim_trx;
+         balance_claim_operation claim_op;
+         claim_op.deposit_to_account = nathan_id;
+         claim_op.balance_to_claim = balance_id_type();
+         claim_op.balance_owner_key = nathan_key.get_public_key();
+         claim_op.total_claimed = balance_id_type()(producer).balance;
+         claim_trx.operations.push_back( claim_op );
+         claim_trx.set_expiration( producer.head_block_time() + fc::hours(1) );
+         claim_trx.set_reference_block( producer.head_block_id() );
+         claim_trx.sign( nathan_key, producer.get_chain_id() );
+         producer.push_transaction( claim_trx );
+
+         signed_block first_block = producer.generate_block( producer.get_slot_time(1), producer.get_scheduled_witness(1),
+                                                             nathan_key, database::skip_nothing );
+         for( uint32_t i = 1; i < node_count; ++i )
+            nodes[i]->db.push_block( first_block );
+      }
+
+      std::cerr << "p2p_benchmark:  " << node_count << " nodes, " << block_count << " blocks of "
+                << transactions_per_block << " transactions\n";
+
+      uint64_t transfer_number = 0;
+      fc::microseconds total_flood_time;
+      for( uint32_t block_number = 0; block_number < block_count; ++block_number )
+      {
+         // sign the flood up front so only propagation and validation are measured
+         std::vector<signed_transaction> flood;
+         flood.reserve( transactions_per_block );
+         for( uint32_t i = 0; i < transactions_per_block; ++i )
+         {
+            signed_transaction trx;
+            transfer_operation xfer_op;
+            xfer_op.from = nathan_id;
+            xfer_op.to = GRAPHENE_NULL_ACCOUNT;
+            xfer_op.amount = asset( ++transfer_number );
+            trx.operations.push_back( xfer_op );
+            producer.current_fee_schedule().set_fee( trx.operations.back() );
+            trx.set_expiration( producer.head_block_time() + fc::hours(1) );
+            trx.set_reference_block( producer.head_block_id() );
+            trx.sign( nathan_key, producer.get_chain_id() );
+            flood.push_back( std::move( trx ) );
+         }
+
+         std::vector<uint64_t> handled_before;
+         for( const auto& node : nodes )
+            handled_before.push_back( node->transactions_accepted + node->transactions_rejected );
+         fc::time_point flood_start = fc::time_point::now();
+         for( const signed_transaction& trx : flood )
+            network.broadcast( graphene::net::trx_message( trx ) );
+         wait_until( [&]() {
+            for( uint32_t i = 0; i < node_count; ++i )
+               if( nodes[i]->transactions_accepted + nodes[i]->transactions_rejected - handled_before[i] < transactions_per_block )
+                  return false;
+            return true;
+         }, timeout, "the transactions before block " + fc::to_string( block_number ) );
+         total_flood_time += fc::time_point::now() - flood_start;
+
+         signed_block block = producer.generate_block( producer.get_slot_time(1), producer.get_scheduled_witness(1),
+                                                       nathan_key, database::skip_nothing );
+         block_broadcast_times[block.id()] = fc::time_point::now();
+         network.broadcast( graphene::net::block_message( block ) );
+         wait_until( [&]() {
+            for( const auto& node : nodes )
+               if( node->db.head_block_id() != block.id() )
+                  return false;
+            return true;
+         }, timeout, "block " + fc::to_string( block_number ) );
+      }
+
+      std::sort( block_latencies.begin(), block_latencies.end() );
+      auto ms = []( fc::microseconds t ) { return t.count() / 1000.0; };
+      std::cout << std::fixed << std::setprecision(2)
+                << "block propagation latency (ms), " << block_latencies.size() << " deliveries:"
+                << "  p50 " << ms( percentile( block_latencies, 0.50 ) )
+                << "  p90 " << ms( percentile( block_latencies, 0.90 ) )
+                << "  p99 " << ms( percentile( block_latencies, 0.99 ) )
+                << "  max " << ms( block_latencies.empty() ? fc::microseconds() : block_latencies.back() ) << "\n";
+      if( total_flood_time.count() > 0 )
+         std::cout << "transactions per second handled by every node: "
+                   << double( transactions_per_block ) * block_count * 1000000 / total_flood_time.count() << "\n";
+      uint64_t transactions_rejected = 0;
+      for( const auto& node : nodes )
+         transactions_rejected += node->transactions_rejected;
+      if( transactions_rejected )
+         std::cout << "transactions rejected, summed over all nodes: " << transactions_rejected << "\n";
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cout << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
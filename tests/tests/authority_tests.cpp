@@ -69,6 +69,43 @@ BOOST_AUTO_TEST_CASE( simple_single_signature )
    }
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( precomputed_signature_keys )
+{ try {
+   fc::ecc::private_key nathan_key = fc::ecc::private_key::generate();
+   const account_object& nathan = create_account("nathan", nathan_key.get_public_key());
+   const asset_object& core = asset_id_type()(db);
+   uint64_t old_balance = fund(nathan);
+   generate_block();
+
+   transfer_operation op;
+   op.from = nathan.id;
+   op.to = account_id_type();
+   op.amount = core.amount(500);
+   trx.operations.push_back(op);
+   set_expiration( db, trx );
+   sign(trx, nathan_key);
+
+   db.precheck_transaction_state( trx );
+   precomputed_transaction precomputed = database::precompute_transaction( trx, db.get_chain_id() );
+   BOOST_CHECK( precomputed.signature_keys() == flat_set<public_key_type>{ nathan_key.get_public_key() } );
+   BOOST_CHECK( precomputed.transaction().id() == trx.id() );
+
+   // the recovered keys replace the signatures for the authority check, so they must be the transaction's own
+   signed_transaction unsigned_trx = trx;
+   unsigned_trx.signatures.clear();
+   GRAPHENE_REQUIRE_THROW( db.push_transaction( database::precompute_transaction( unsigned_trx, db.get_chain_id() ) ),
+                           fc::exception );
+   db.push_transaction( precomputed );
+   BOOST_CHECK_EQUAL((uint64_t)get_balance(nathan, core), old_balance - 500);
+   GRAPHENE_REQUIRE_THROW( db.precheck_transaction_state( trx ), fc::exception );
+
+   trx.expiration = db.head_block_time() - fc::seconds(1);
+   GRAPHENE_REQUIRE_THROW( db.precheck_transaction_state( trx ), fc::exception );
+   trx.expiration = db.head_block_time() + fc::seconds(60);
+   trx.ref_block_prefix ^= 1;
+   GRAPHENE_REQUIRE_THROW( db.precheck_transaction_state( trx ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( any_two_of_three )
 {
    try {
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/application.hpp>
+#include <graphene/app/database_api.hpp>
+#include <graphene/chain/market_object.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using namespace graphene::app;
+
+BOOST_FIXTURE_TEST_SUITE( database_api_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( concurrent_read_only_calls )
+{ try {
+   ACTORS( (alice)(bob) );
+   transfer( committee_account, alice_id, asset(100000) );
+   generate_block();
+
+   // lookups that add to the subscription filter or read the block log stay on the main thread
+   for( const string method : { "get_objects", "get_objects_fields", "get_accounts", "get_full_accounts",
+                                "lookup_accounts", "get_assets", "get_key_references", "get_balance_objects",
+                                "get_block", "get_block_header", "get_transaction", "get_connected_peers",
+                                "get_peer_metrics", "broadcast_transaction", "validate_transaction" } )
+      BOOST_CHECK_MESSAGE( !application::is_concurrent_api_call( method ), method );
+   for( const string method : { "get_account_by_name", "get_account_balances", "lookup_asset_symbols",
+                                "get_order_book", "get_required_fees", "get_dynamic_global_properties" } )
+      BOOST_CHECK_MESSAGE( application::is_concurrent_api_call( method ), method );
+
+   database_api db_api( db );
+   // a subscriber makes the excluded lookups write to the subscription filter
+   db_api.set_subscribe_callback( []( const variant& ){}, false );
+
+   const int calls_per_thread = 200;
+   std::vector< std::shared_ptr<fc::thread> > threads;
+   std::vector< fc::future<int> > results;
+   for( int i = 0; i < 4; ++i )
+   {
+      threads.push_back( std::make_shared<fc::thread>( "api-" + std::to_string(i) ) );
+      results.push_back( threads.back()->async( [&]() {
+         int calls = 0;
+         uint32_t last_head = 0;
+         for( int j = 0; j < calls_per_thread; ++j )
+         {
+            db.with_read_lock( [&]() {
+               auto alice_acct = db_api.get_account_by_name( "alice" );
+               FC_ASSERT( alice_acct && alice_acct->id == alice_id );
+               auto balances = db_api.get_account_balances( alice_id, flat_set<asset_id_type>{ asset_id_type() } );
+               FC_ASSERT( balances.size() == 1 && balances[0].amount > 0 );
+               auto core = db_api.lookup_asset_symbols( { GRAPHENE_SYMBOL } );
+               FC_ASSERT( core.size() == 1 && core[0].valid() && core[0]->id == asset_id_type() );
+               auto head = db_api.get_dynamic_global_properties().head_block_number;
+               FC_ASSERT( head >= last_head );
+               last_head = head;
+            });
+            ++calls;
+         }
+         return calls;
+      }, "concurrent api calls" ) );
+   }
+
+   // keep changing the chain while the readers run
+   for( int i = 0; i < 10; ++i )
+   {
+      transfer( alice_id, bob_id, asset(10) );
+      generate_block();
+   }
+
+   for( auto& result : results )
+      BOOST_CHECK_EQUAL( result.wait(), calls_per_thread );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 100 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_change_deltas )
+{ try {
+   ACTORS( (alice)(bob) );
+   const auto& uia = create_user_issued_asset( "DELTA" );
+   transfer( committee_account, alice_id, asset(100000) );
+   // changes are reported from some blocks after the last maintenance on
+   while( db.head_block_num() <= db.start_notify_block_num )
+      generate_block();
+
+   database_api db_api( db );
+   vector<variant> notifications;
+   object_change_filter balances;
+   balances.space_id = implementation_ids;
+   balances.type_id = impl_account_balance_object_type;
+   balances.accounts.insert( alice_id );
+   object_change_filter orders;
+   orders.type_id = limit_order_object_type;
+   orders.market = std::make_pair( uia.id, asset_id_type() );
+   db_api.subscribe_to_object_changes( [&notifications]( const variant& v ) { notifications.push_back( v ); },
+                                       { balances, orders } );
+   auto next_block = [&]() {
+      notifications.clear();
+      generate_block();
+      // the changes are diffed and sent by a task after the block was applied
+      fc::usleep( fc::milliseconds( 100 ) );
+   };
+   const auto alice_core = db.get_balance( alice_id, asset_id_type() ).amount;
+   object_id_type alice_core_id;
+
+   // first report of alice's balance: the full object
+   transfer( alice_id, bob_id, asset(100) );
+   next_block();
+   BOOST_REQUIRE_EQUAL( notifications.size(), 1u );
+   BOOST_REQUIRE_EQUAL( notifications[0].get_array().size(), 1u );
+   {
+      const auto& change = notifications[0].get_array()[0].get_object();
+      BOOST_REQUIRE( change.contains( "object" ) );
+      BOOST_CHECK( change["object"]["owner"].as<account_id_type>( 1 ) == alice_id );
+      BOOST_CHECK_EQUAL( change["object"]["balance"].as<share_type>( 1 ).value,
+                         db.get_balance( alice_id, asset_id_type() ).amount.value );
+      alice_core_id = change["id"].as<object_id_type>( 1 );
+   }
+   BOOST_CHECK_LT( db.get_balance( alice_id, asset_id_type() ).amount.value, alice_core.value );
+
+   // afterwards only the fields that changed
+   transfer( alice_id, bob_id, asset(100) );
+   next_block();
+   BOOST_REQUIRE_EQUAL( notifications.size(), 1u );
+   BOOST_REQUIRE_EQUAL( notifications[0].get_array().size(), 1u );
+   {
+      const auto& change = notifications[0].get_array()[0].get_object();
+      BOOST_CHECK( change["id"].as<object_id_type>( 1 ) == alice_core_id );
+      BOOST_REQUIRE( change.contains( "changed" ) );
+      const auto& changed = change["changed"].get_object();
+      BOOST_CHECK_EQUAL( changed.size(), 1u );
+      BOOST_CHECK_EQUAL( changed["balance"].as<share_type>( 1 ).value,
+                         db.get_balance( alice_id, asset_id_type() ).amount.value );
+   }
+
+   // bob's balance is not subscribed
+   transfer( bob_id, committee_account, asset(10) );
+   next_block();
+   BOOST_CHECK( notifications.empty() );
+
+   // an order of the market is reported in full, then as removed once cancelled
+   issue_uia( alice_id, uia.amount( 1000 ) );
+   const limit_order_object* order = create_sell_order( alice_id, uia.amount( 100 ), asset( 1000 ) );
+   BOOST_REQUIRE( order != nullptr );
+   const limit_order_id_type order_id = order->id;
+   next_block();
+   BOOST_REQUIRE_EQUAL( notifications.size(), 1u );
+   bool order_reported = false;
+   for( const auto& item : notifications[0].get_array() )
+      if( item["id"].as<object_id_type>( 1 ) == object_id_type( order_id ) )
+         order_reported = item.get_object().contains( "object" );
+   BOOST_CHECK( order_reported );
+
+   cancel_limit_order( order_id( db ) );
+   next_block();
+   BOOST_REQUIRE_EQUAL( notifications.size(), 1u );
+   bool order_removed = false;
+   for( const auto& item : notifications[0].get_array() )
+      if( item["id"].as<object_id_type>( 1 ) == object_id_type( order_id ) )
+         order_removed = item["removed"].as_bool();
+   BOOST_CHECK( order_removed );
+
+   db_api.unsubscribe_from_object_changes();
+   transfer( alice_id, bob_id, asset(100) );
+   next_block();
+   BOOST_CHECK( notifications.empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( asset_holders )
+{ try {
+   ACTORS( (alice)(bob)(carol)(dave)(erin) );
+   const auto& uia = create_user_issued_asset( "HOLD" );
+   const asset_id_type uia_id = uia.id;
+   transfer( committee_account, erin_id, asset(10000) );
+   issue_uia( alice_id, uia.amount( 500 ) );
+   issue_uia( bob_id, uia.amount( 300 ) );
+   issue_uia( carol_id, uia.amount( 300 ) );
+   issue_uia( dave_id, uia.amount( 10 ) );
+   issue_uia( erin_id, uia.amount( 5 ) );
+   // erin keeps a balance object with nothing in it
+   transfer( erin_id, dave_id, asset( 5, uia_id ) );
+   generate_block();
+
+   database_api db_api( db );
+   BOOST_CHECK_THROW( db_api.get_asset_holders( uia_id, optional<asset_holder>(), 101 ), fc::exception );
+
+   // largest first, ties by account, each page resumes after the last holder of the previous one
+   vector<asset_holder> holders;
+   optional<asset_holder> after;
+   for( int pages = 0; pages < 5; ++pages )
+   {
+      auto page = db_api.get_asset_holders( uia_id, after, 2 );
+      BOOST_CHECK_LE( page.size(), 2u );
+      if( page.empty() )
+         break;
+      holders.insert( holders.end(), page.begin(), page.end() );
+      after = page.back();
+   }
+   BOOST_REQUIRE_EQUAL( holders.size(), 4u );
+   BOOST_CHECK( holders[0].account_id == alice_id );
+   BOOST_CHECK_EQUAL( holders[0].name, "alice" );
+   BOOST_CHECK_EQUAL( holders[0].amount.value, 500 );
+   BOOST_CHECK( holders[1].account_id == bob_id );
+   BOOST_CHECK( holders[2].account_id == carol_id );
+   BOOST_CHECK_EQUAL( holders[2].amount.value, 300 );
+   BOOST_CHECK( holders[3].account_id == dave_id );
+   BOOST_CHECK_EQUAL( holders[3].amount.value, 15 );
+
+   auto summary = db_api.get_asset_holders_summary( uia_id );
+   BOOST_CHECK( summary.asset_id == uia_id );
+   BOOST_CHECK_EQUAL( summary.holders, 4u );
+   BOOST_CHECK_EQUAL( summary.total.value, 1115 );
+   BOOST_CHECK_EQUAL( summary.top_10.value, 1115 );
+   BOOST_REQUIRE_EQUAL( summary.by_magnitude.size(), 3u );
+   BOOST_CHECK_EQUAL( summary.by_magnitude[0], 0u );
+   BOOST_CHECK_EQUAL( summary.by_magnitude[1], 1u );
+   BOOST_CHECK_EQUAL( summary.by_magnitude[2], 3u );
+
+   // the summary is kept for the block, then computed again
+   transfer( dave_id, erin_id, asset( 15, uia_id ) );
+   BOOST_CHECK_EQUAL( db_api.get_asset_holders_summary( uia_id ).holders, 4u );
+   generate_block();
+   summary = db_api.get_asset_holders_summary( uia_id );
+   BOOST_CHECK_EQUAL( summary.holders, 4u );
+   BOOST_REQUIRE_EQUAL( summary.by_magnitude.size(), 3u );
+   BOOST_CHECK_EQUAL( summary.by_magnitude[1], 1u );
+   auto last = db_api.get_asset_holders( uia_id, holders[2], 10 );
+   BOOST_REQUIRE_EQUAL( last.size(), 1u );
+   BOOST_CHECK( last[0].account_id == erin_id );
+
+   transfer( erin_id, alice_id, asset( 15, uia_id ) );
+   generate_block();
+   summary = db_api.get_asset_holders_summary( uia_id );
+   BOOST_CHECK_EQUAL( summary.holders, 3u );
+   BOOST_CHECK_EQUAL( summary.top_10.value, 1115 );
+   BOOST_CHECK_EQUAL( db_api.get_asset_holders( uia_id, optional<asset_holder>(), 10 ).size(), 3u );
+
+   // other connections are answered from the same summary until the next block
+   issue_uia( dave_id, uia.amount( 1 ) );
+   database_api other_api( db );
+   BOOST_CHECK_EQUAL( other_api.get_asset_holders_summary( uia_id ).holders, 3u );
+   generate_block();
+   BOOST_CHECK_EQUAL( other_api.get_asset_holders_summary( uia_id ).holders, 4u );
+   BOOST_CHECK_EQUAL( db_api.get_asset_holders_summary( uia_id ).holders, 4u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( order_book_from_depth_levels )
+{ try {
+   ACTORS( (alice)(bob) );
+   const asset_object& uia = create_user_issued_asset( "BOOK" );
+   transfer( committee_account, alice_id, asset( 10000 ) );
+   transfer( committee_account, bob_id, asset( 10000 ) );
+   issue_uia( bob_id, uia.amount( 10000 ) );
+
+   create_sell_order( alice_id, asset( 100 ), uia.amount( 200 ) );
+   create_sell_order( alice_id, asset( 100 ), uia.amount( 200 ) );
+   create_sell_order( alice_id, asset( 100 ), uia.amount( 300 ) );
+   create_sell_order( bob_id, uia.amount( 500 ), asset( 1000 ) );
+   // partially fills the first order of the best bid level
+   BOOST_CHECK( create_sell_order( bob_id, uia.amount( 100 ), asset( 50 ) ) == nullptr );
+   generate_block();
+
+   database_api db_api( db );
+   const auto& depth = dynamic_cast<const primary_index<limit_order_index>&>( db.get_index_type<limit_order_index>() )
+                          .get_secondary_index<limit_order_depth_index>();
+   const auto bid_levels = depth.get_levels( asset_id_type(), uia.id, 50 );
+   const auto ask_levels = depth.get_levels( uia.id, asset_id_type(), 50 );
+
+   // one entry per price level, CORE has 5 decimals and BOOK 2
+   order_book book = db_api.get_order_book( GRAPHENE_SYMBOL, "BOOK", 50 );
+   BOOST_REQUIRE_EQUAL( book.bids.size(), bid_levels.size() );
+   BOOST_REQUIRE_EQUAL( book.bids.size(), 2u );
+   BOOST_CHECK_CLOSE( book.bids[0].price, 0.0005, 1e-9 );
+   BOOST_CHECK_CLOSE( book.bids[0].base, 0.0015, 1e-9 );
+   BOOST_CHECK_CLOSE( book.bids[0].quote, 3.0, 1e-9 );
+   BOOST_CHECK_CLOSE( book.bids[1].price, 0.001 / 3, 1e-9 );
+   BOOST_CHECK_CLOSE( book.bids[1].base, 0.001, 1e-9 );
+   BOOST_CHECK_CLOSE( book.bids[1].quote, 3.0, 1e-9 );
+   for( size_t i = 0; i < bid_levels.size(); ++i )
+      BOOST_CHECK_CLOSE( book.bids[i].base, bid_levels[i].second.for_sale.value / 100000.0, 1e-9 );
+
+   BOOST_REQUIRE_EQUAL( book.asks.size(), ask_levels.size() );
+   BOOST_REQUIRE_EQUAL( book.asks.size(), 1u );
+   BOOST_CHECK_CLOSE( book.asks[0].price, 0.002, 1e-9 );
+   BOOST_CHECK_CLOSE( book.asks[0].quote, 5.0, 1e-9 );
+   BOOST_CHECK_CLOSE( book.asks[0].base, 0.01, 1e-9 );
+   BOOST_CHECK_CLOSE( book.asks[0].quote, ask_levels[0].second.for_sale.value / 100.0, 1e-9 );
+
+   BOOST_CHECK_EQUAL( db_api.get_order_book( GRAPHENE_SYMBOL, "BOOK", 1 ).bids.size(), 1u );
+   BOOST_CHECK_THROW( db_api.get_order_book( GRAPHENE_SYMBOL, "BOOK", 51 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( field_projection )
+{ try {
+   ACTORS( (alice) );
+   const asset_object& uia = create_user_issued_asset( "PROJ" );
+   transfer( committee_account, alice_id, asset( 100000 ) );
+   create_sell_order( alice_id, asset( 100 ), uia.amount( 200 ) );
+   generate_block();
+
+   database_api db_api( db );
+
+   // only the selected fields, in the order of the ids, null for objects that do not exist
+   fc::variants objects = db_api.get_objects_fields( { object_id_type( alice_id ), object_id_type( asset_id_type() ),
+                                                       object_id_type( account_id_type( 1000000 ) ) },
+                                                     { "id", "name", "symbol" } );
+   BOOST_REQUIRE_EQUAL( objects.size(), 3u );
+   BOOST_REQUIRE( objects[0].is_object() );
+   BOOST_CHECK_EQUAL( objects[0].get_object().size(), 2u );
+   BOOST_CHECK_EQUAL( objects[0]["name"].as_string(), "alice" );
+   BOOST_CHECK( objects[0]["id"].as<account_id_type>( 1 ) == alice_id );
+   BOOST_REQUIRE( objects[1].is_object() );
+   BOOST_CHECK_EQUAL( objects[1].get_object().size(), 2u );
+   BOOST_CHECK_EQUAL( objects[1]["symbol"].as_string(), GRAPHENE_SYMBOL );
+   BOOST_CHECK( objects[2].is_null() );
+
+   vector<fc::variant> accounts = db_api.get_accounts_fields( { alice_id, account_id_type( 1000000 ) }, { "name", "addresses" } );
+   BOOST_REQUIRE_EQUAL( accounts.size(), 2u );
+   BOOST_CHECK_EQUAL( accounts[0].get_object().size(), 2u );
+   BOOST_CHECK_EQUAL( accounts[0]["name"].as_string(), "alice" );
+   BOOST_CHECK( accounts[0]["addresses"].is_array() );
+   BOOST_CHECK( accounts[1].is_null() );
+
+   // unknown field names are skipped
+   objects = db_api.get_objects_fields( { object_id_type( alice_id ), object_id_type( asset_id_type() ) }, { "no_such_field" } );
+   BOOST_CHECK_EQUAL( objects[0].get_object().size(), 0u );
+   BOOST_CHECK_EQUAL( objects[1].get_object().size(), 0u );
+   accounts = db_api.get_accounts_fields( { alice_id }, { "name", "no_such_field" } );
+   BOOST_CHECK_EQUAL( accounts[0].get_object().size(), 1u );
+
+   // dotted paths select nested fields, paths below unknown or non-object fields are skipped
+   accounts = db_api.get_accounts_fields( { alice_id }, { "options.memo_key", "options.no_such_field", "name.first" } );
+   BOOST_REQUIRE_EQUAL( accounts[0].get_object().size(), 1u );
+   BOOST_REQUIRE_EQUAL( accounts[0]["options"].get_object().size(), 1u );
+   BOOST_CHECK( accounts[0]["options"]["memo_key"].as<public_key_type>( 1 ) == alice_id( db ).options.memo_key );
+   // a whole field wins over paths into it
+   accounts = db_api.get_accounts_fields( { alice_id }, { "options", "options.memo_key" } );
+   BOOST_CHECK( accounts[0]["options"].get_object().contains( "votes" ) );
+   objects = db_api.get_objects_fields( { object_id_type( asset_id_type() ) }, { "options.max_supply", "symbol" } );
+   BOOST_CHECK_EQUAL( objects[0].get_object().size(), 2u );
+   BOOST_REQUIRE_EQUAL( objects[0]["options"].get_object().size(), 1u );
+   BOOST_CHECK( objects[0]["options"].get_object().contains( "max_supply" ) );
+
+   // a subset of the full account sections, unknown accounts are left out
+   auto full = db_api.get_full_accounts_sections( { "alice", "nobody" }, false, { "balances", "limit_orders", "account.name" } );
+   BOOST_REQUIRE_EQUAL( full.size(), 1u );
+   const fc::variant_object& sections = full["alice"];
+   BOOST_CHECK_EQUAL( sections.size(), 3u );
+   BOOST_CHECK( !sections.contains( "statistics" ) );
+   BOOST_CHECK( !sections.contains( "vesting_balances" ) );
+   BOOST_CHECK_EQUAL( sections["balances"].get_array().size(), 1u );
+   BOOST_CHECK_EQUAL( sections["limit_orders"].get_array().size(), 1u );
+   BOOST_REQUIRE_EQUAL( sections["account"].get_object().size(), 1u );
+   BOOST_CHECK_EQUAL( sections["account"]["name"].as_string(), "alice" );
+
+   // no sections return everything get_full_accounts does
+   full = db_api.get_full_accounts_sections( { "alice" }, false, {} );
+   BOOST_REQUIRE_EQUAL( full.size(), 1u );
+   BOOST_CHECK( full["alice"].contains( "statistics" ) );
+   BOOST_CHECK( full["alice"].contains( "vesting_balances" ) );
+   BOOST_CHECK_EQUAL( full["alice"]["limit_orders"].get_array().size(), 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/market_history/market_history_plugin.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using namespace graphene::market_history;
+
+namespace {
+
+/**
+ *  Replays fills one at a time the way the plugin used to, so that the per-block
+ *  aggregation can be compared against it.
+ */
+struct per_fill_market_history
+{
+   struct history_entry
+   {
+      int64_t              sequence;
+      fc::time_point_sec   time;
+      fill_order_operation op;
+   };
+
+   flat_set<uint32_t>                                           buckets;
+   map< pair<asset_id_type,asset_id_type>, vector<history_entry> > history;
+   map< bucket_key, bucket_object >                              bucket_objects;
+
+   void apply( const fill_order_operation& o, fc::time_point_sec now )
+   {
+      auto market = std::make_pair( std::min( o.pays.asset_id, o.receives.asset_id ),
+                                    std::max( o.pays.asset_id, o.receives.asset_id ) );
+      auto& entries = history[market];
+      history_entry entry;
+      entry.sequence = entries.empty() ? 0 : entries.back().sequence - 1;
+      entry.time = now;
+      entry.op = o;
+      entries.push_back( entry );
+      // only the 200 most recent fills are kept for each market
+      if( entries.size() > 200 )
+         entries.erase( entries.begin(), entries.end() - 200 );
+
+      if( o.pays.asset_id > o.receives.asset_id )
+         return;
+
+      price trade_price = o.pays / o.receives;
+      for( auto bucket : buckets )
+      {
+         bucket_key key( o.pays.asset_id, o.receives.asset_id, bucket,
+                         fc::time_point() + fc::seconds( (now.sec_since_epoch() / bucket) * bucket ) );
+         auto itr = bucket_objects.find( key );
+         if( itr == bucket_objects.end() )
+         {
+            bucket_object& b = bucket_objects[key];
+            b.key = key;
+            b.base_volume = trade_price.base.amount;
+            b.quote_volume = trade_price.quote.amount;
+            b.open_base = b.close_base = b.high_base = b.low_base = trade_price.base.amount;
+            b.open_quote = b.close_quote = b.high_quote = b.low_quote = trade_price.quote.amount;
+            continue;
+         }
+
+         bucket_object& b = itr->second;
+         b.base_volume += trade_price.base.amount;
+         b.quote_volume += trade_price.quote.amount;
+         b.close_base = trade_price.base.amount;
+         b.close_quote = trade_price.quote.amount;
+         if( b.high() < trade_price )
+         {
+            b.high_base = b.close_base;
+            b.high_quote = b.close_quote;
+         }
+         if( b.low() > trade_price )
+         {
+            b.low_base = b.close_base;
+            b.low_quote = b.close_quote;
+         }
+      }
+   }
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( market_history_tests, database_fixture )
+
+/**
+ *  The plugin folds all fills of a block into one update per bucket and one history prune per market.
+ *  Buckets, fill history and the trade history the ticker is computed from must come out exactly as
+ *  they did when every fill was applied to the database on its own.
+ */
+BOOST_AUTO_TEST_CASE( market_history_per_block_aggregation )
+{ try {
+   ACTORS( (alice)(bob) );
+   const asset_id_type hist_id = create_user_issued_asset( "HIST" ).id;
+   const asset_id_type mkt_id = create_user_issued_asset( "MKT" ).id;
+   issue_uia( bob, asset( 100000000, hist_id ) );
+   issue_uia( bob, asset( 100000000, mkt_id ) );
+   transfer( committee_account, alice_id, asset( 100000000 ) );
+   generate_block();
+
+   auto mhplugin = app.get_plugin<market_history_plugin>( "market_history" );
+   BOOST_REQUIRE( mhplugin );
+   BOOST_REQUIRE( !mhplugin->tracked_buckets().empty() );
+
+   per_fill_market_history expected;
+   expected.buckets = mhplugin->tracked_buckets();
+   boost::signals2::scoped_connection replay = db.applied_block.connect( [&]( const signed_block& b ) {
+      for( const optional< operation_history_object >& o_op : db.get_applied_operations() )
+         if( o_op.valid() && o_op->op.which() == operation::tag<fill_order_operation>::value )
+            expected.apply( o_op->op.get<fill_order_operation>(), b.timestamp );
+   });
+
+   auto check_history = [&]()
+   {
+      const auto& bucket_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+      BOOST_REQUIRE_EQUAL( bucket_idx.size(), expected.bucket_objects.size() );
+      for( const bucket_object& b : bucket_idx )
+      {
+         auto itr = expected.bucket_objects.find( b.key );
+         BOOST_REQUIRE( itr != expected.bucket_objects.end() );
+         const bucket_object& e = itr->second;
+         BOOST_CHECK_EQUAL( b.open_base.value, e.open_base.value );
+         BOOST_CHECK_EQUAL( b.open_quote.value, e.open_quote.value );
+         BOOST_CHECK_EQUAL( b.close_base.value, e.close_base.value );
+         BOOST_CHECK_EQUAL( b.close_quote.value, e.close_quote.value );
+         BOOST_CHECK_EQUAL( b.high_base.value, e.high_base.value );
+         BOOST_CHECK_EQUAL( b.high_quote.value, e.high_quote.value );
+         BOOST_CHECK_EQUAL( b.low_base.value, e.low_base.value );
+         BOOST_CHECK_EQUAL( b.low_quote.value, e.low_quote.value );
+         BOOST_CHECK_EQUAL( b.base_volume.value, e.base_volume.value );
+         BOOST_CHECK_EQUAL( b.quote_volume.value, e.quote_volume.value );
+      }
+
+      const auto& history_idx = db.get_index_type<history_index>().indices().get<by_key>();
+      size_t history_count = 0;
+      for( const auto& market : expected.history )
+      {
+         // newest fill first, like the by_key ordering of the index
+         auto entry = market.second.rbegin();
+         history_key hkey;
+         hkey.base = market.first.first;
+         hkey.quote = market.first.second;
+         hkey.sequence = std::numeric_limits<int64_t>::min();
+         for( auto itr = history_idx.lower_bound( hkey );
+              itr != history_idx.end() && itr->key.base == hkey.base && itr->key.quote == hkey.quote;
+              ++itr, ++entry )
+         {
+            BOOST_REQUIRE( entry != market.second.rend() );
+            BOOST_CHECK_EQUAL( itr->key.sequence, entry->sequence );
+            BOOST_CHECK( itr->time == entry->time );
+            BOOST_CHECK( itr->op.pays == entry->op.pays );
+            BOOST_CHECK( itr->op.receives == entry->op.receives );
+            BOOST_CHECK( itr->op.order_id == entry->op.order_id );
+            ++history_count;
+         }
+         BOOST_CHECK( entry == market.second.rend() );
+      }
+      BOOST_CHECK_EQUAL( history_idx.size(), history_count );
+
+      // the ticker's latest price and volumes are read from this trade history
+      graphene::app::database_api db_api( db );
+      auto trades = db_api.get_trade_history( "HIST", "CORE", db.head_block_time() + 1, fc::time_point_sec(), 100 );
+      const auto& hist_market = expected.history[ std::make_pair( std::min( hist_id, asset_id_type() ),
+                                                                  std::max( hist_id, asset_id_type() ) ) ];
+      BOOST_REQUIRE_EQUAL( trades.size(), std::min<size_t>( 100, hist_market.size() / 2 ) );
+      auto entry = hist_market.rbegin();
+      for( const auto& t : trades )
+      {
+         BOOST_CHECK( t.date == entry->time );
+         entry += 2;
+      }
+   };
+
+   // several fills in the same market at different prices within a single block
+   create_sell_order( alice_id, asset( 1000 ), asset( 500, hist_id ) );
+   create_sell_order( alice_id, asset( 1000 ), asset( 700, hist_id ) );
+   create_sell_order( alice_id, asset( 1000 ), asset( 400, hist_id ) );
+   create_sell_order( bob_id, asset( 1600, hist_id ), asset( 2000 ) );
+   // and a second market touched by the same block
+   create_sell_order( alice_id, asset( 2000 ), asset( 300, mkt_id ) );
+   create_sell_order( bob_id, asset( 300, mkt_id ), asset( 1000 ) );
+   generate_block();
+   BOOST_CHECK( !expected.bucket_objects.empty() );
+   check_history();
+
+   // another block that most likely lands in the same buckets, so existing buckets are modified
+   create_sell_order( alice_id, asset( 1000 ), asset( 900, hist_id ) );
+   create_sell_order( bob_id, asset( 900, hist_id ), asset( 1000 ) );
+   generate_block();
+   check_history();
+
+   // a later block in fresh buckets with enough fills to prune the order history of the market
+   generate_blocks( db.head_block_time() + 3600 );
+   for( int i = 1; i <= 110; ++i )
+   {
+      create_sell_order( alice_id, asset( 1000 + i ), asset( 500 + i, hist_id ) );
+      create_sell_order( bob_id, asset( 500 + i, hist_id ), asset( 1000 + i ) );
+   }
+   generate_block();
+   BOOST_CHECK_EQUAL( expected.history[ std::make_pair( std::min( hist_id, asset_id_type() ),
+                                                        std::max( hist_id, asset_id_type() ) ) ].size(), 200 );
+   check_history();
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
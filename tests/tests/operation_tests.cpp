@@ -1200,6 +1200,106 @@ BOOST_AUTO_TEST_CASE( cancel_limit_order_test )
  }
 }
 
+BOOST_AUTO_TEST_CASE( limit_order_depth_levels )
+{ try {
+   ACTORS( (alice)(bob) );
+   const asset_object& uia = create_user_issued_asset( "DEPTH" );
+   const asset_id_type uia_id = uia.id;
+   const asset_id_type core_id;
+   transfer( committee_account, alice_id, asset( 10000 ) );
+   transfer( committee_account, bob_id, asset( 10000 ) );
+   issue_uia( bob_id, uia.amount( 10000 ) );
+
+   const auto& depth = dynamic_cast<const primary_index<limit_order_index>&>( db.get_index_type<limit_order_index>() )
+                          .get_secondary_index<limit_order_depth_index>();
+   // the levels must always add up the orders resting at each price
+   auto check_levels = [&]() {
+      limit_order_depth_index::level_map expected;
+      for( const limit_order_object& o : db.get_index_type<limit_order_index>().indices() )
+      {
+         auto& level = expected[o.sell_price];
+         level.for_sale += o.for_sale;
+         ++level.order_count;
+      }
+      BOOST_REQUIRE_EQUAL( depth.levels().size(), expected.size() );
+      auto itr = depth.levels().begin();
+      for( const auto& level : expected )
+      {
+         BOOST_CHECK( itr->first == level.first );
+         BOOST_CHECK_EQUAL( itr->second.for_sale.value, level.second.for_sale.value );
+         BOOST_CHECK_EQUAL( itr->second.order_count, level.second.order_count );
+         ++itr;
+      }
+   };
+
+   // two orders at one price, one at a worse price, best price first
+   const limit_order_id_type first_id = create_sell_order( alice_id, asset( 100 ), uia.amount( 200 ) )->id;
+   create_sell_order( alice_id, asset( 100 ), uia.amount( 200 ) );
+   const limit_order_id_type worse_id = create_sell_order( alice_id, asset( 100 ), uia.amount( 300 ) )->id;
+   check_levels();
+   auto levels = depth.get_levels( core_id, uia_id, 10 );
+   BOOST_REQUIRE_EQUAL( levels.size(), 2u );
+   BOOST_CHECK( levels[0].first == asset( 100 ) / uia.amount( 200 ) );
+   BOOST_CHECK_EQUAL( levels[0].second.for_sale.value, 200 );
+   BOOST_CHECK_EQUAL( levels[0].second.order_count, 2u );
+   BOOST_CHECK( levels[1].first == asset( 100 ) / uia.amount( 300 ) );
+   BOOST_CHECK_EQUAL( levels[1].second.for_sale.value, 100 );
+   BOOST_CHECK_EQUAL( levels[1].second.order_count, 1u );
+   BOOST_CHECK_EQUAL( depth.get_levels( core_id, uia_id, 1 ).size(), 1u );
+   BOOST_CHECK( depth.get_levels( uia_id, core_id, 10 ).empty() );
+
+   // a partial fill lowers the level, the order stays
+   BOOST_CHECK( create_sell_order( bob_id, uia.amount( 100 ), asset( 50 ) ) == nullptr );
+   BOOST_CHECK_EQUAL( first_id(db).for_sale.value, 50 );
+   check_levels();
+   levels = depth.get_levels( core_id, uia_id, 10 );
+   BOOST_REQUIRE_EQUAL( levels.size(), 2u );
+   BOOST_CHECK_EQUAL( levels[0].second.for_sale.value, 150 );
+   BOOST_CHECK_EQUAL( levels[0].second.order_count, 2u );
+
+   // a full fill removes the order from its level
+   BOOST_CHECK( create_sell_order( bob_id, uia.amount( 100 ), asset( 50 ) ) == nullptr );
+   BOOST_CHECK( !db.find( first_id ) );
+   check_levels();
+   levels = depth.get_levels( core_id, uia_id, 10 );
+   BOOST_REQUIRE_EQUAL( levels.size(), 2u );
+   BOOST_CHECK_EQUAL( levels[0].second.for_sale.value, 100 );
+   BOOST_CHECK_EQUAL( levels[0].second.order_count, 1u );
+
+   // an order that does not cross rests on the other side
+   BOOST_REQUIRE( create_sell_order( bob_id, uia.amount( 500 ), asset( 1000 ) ) != nullptr );
+   check_levels();
+   levels = depth.get_levels( uia_id, core_id, 10 );
+   BOOST_REQUIRE_EQUAL( levels.size(), 1u );
+   BOOST_CHECK_EQUAL( levels[0].second.for_sale.value, 500 );
+
+   // cancelling the only order of a level removes the level
+   cancel_limit_order( worse_id(db) );
+   check_levels();
+   BOOST_CHECK_EQUAL( depth.get_levels( core_id, uia_id, 10 ).size(), 1u );
+
+   // popping a block restores the levels as they were before it
+   generate_block();
+   const auto levels_before = depth.levels();
+   create_sell_order( alice_id, asset( 100 ), uia.amount( 300 ) );
+   BOOST_CHECK( create_sell_order( bob_id, uia.amount( 100 ), asset( 50 ) ) == nullptr );
+   cancel_limit_order( *create_sell_order( alice_id, asset( 10 ), uia.amount( 1000 ) ) );
+   generate_block();
+   check_levels();
+   BOOST_CHECK_EQUAL( depth.levels().size(), 3u );
+   db.pop_block();
+   check_levels();
+   BOOST_REQUIRE_EQUAL( depth.levels().size(), levels_before.size() );
+   auto itr = depth.levels().begin();
+   for( const auto& level : levels_before )
+   {
+      BOOST_CHECK( itr->first == level.first );
+      BOOST_CHECK_EQUAL( itr->second.for_sale.value, level.second.for_sale.value );
+      BOOST_CHECK_EQUAL( itr->second.order_count, level.second.order_count );
+      ++itr;
+   }
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( witness_feeds )
 {
    using namespace graphene::chain;